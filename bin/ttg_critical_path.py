@@ -0,0 +1,317 @@
+#!/usr/bin/env python3
+
+"""Post-mortem analysis of a TTG execution recorded by ttg::Timeline.
+
+Reads the Chrome JSON timelines written with TTG_TIMELINE=<file>.json (one file per rank), rebuilds the DAG of task
+instances executed, and reports
+ - the critical path through the task instances, and the share of each TT and of the communication in it,
+ - the parallelism available in the DAG and the parallelism achieved over time,
+ - the slack of the tasks, per TT (and per task with --slack-csv),
+ - the messages that are on the critical path.
+
+The dependencies are those recorded by the timeline: the inputs set by a task on a task of this process, the messages
+sent by a task, and the tasks executed inline by a task. The weight of a task is its execution time, excluding that of
+the tasks it executed inline. A dependency starts when the input is set, the message sent or the inline task started,
+not when its producer finishes: the consumer can start that long after the start of its producer, plus, for a
+message, the time between its send and its receipt, using the clocks of the processes as recorded (i.e. only roughly
+synchronized). Hence the critical path is at most the makespan, up to the clock skew. A message is paired with its
+receipt by the id of its flow events; only the first task of a broadcast is linked to its sender. The dependencies
+whose consumer is not found (e.g. a message whose receiving process has no timeline) are not linked, and counted in
+the report.
+"""
+
+import argparse
+import collections
+import json
+import sys
+
+
+class Task:
+    def __init__(self, name, tt, key_hash, key, rank, thread, start):
+        self.name = name
+        self.tt = tt
+        self.key_hash = key_hash
+        self.key = key
+        self.rank = rank
+        self.thread = thread
+        self.start = start
+        self.end = start
+        self.parent = None     # the task that executed this one inline, if any
+        self.children = 0      # the time spent executing tasks inline
+        self.preds = []        # (task, delay, edge), see Edge.delay
+        self.succs = []        # (task, delay, edge)
+
+    def duration(self):
+        return self.end - self.start
+
+    def work(self):
+        return max(0, self.duration() - self.children)
+
+
+class Edge:
+    def __init__(self, producer, consumer, input, kind, time, bytes=0, comm=0, src=None, dst=None):
+        self.producer = producer
+        self.consumer = consumer
+        self.input = input
+        self.kind = kind       # "input", "message" or "inline"
+        self.time = time       # when the input was set or the message sent
+        self.bytes = bytes
+        self.comm = comm       # the time from the send to the receipt, in ns
+        self.src = src
+        self.dst = dst
+
+    def delay(self):
+        """the time from the start of the producer to the earliest start of the consumer"""
+        return min(max(0, self.time - self.producer.start), self.producer.duration()) + self.comm
+
+
+def to_ns(ts):
+    return int(round(float(ts) * 1000))
+
+
+def load(files):
+    """returns the events of the files, grouped by (pid, tid), in the order of the files"""
+    threads = collections.OrderedDict()
+    for file in files:
+        with open(file) as f:
+            trace = json.load(f)
+        events = trace["traceEvents"] if isinstance(trace, dict) else trace
+        for e in events:
+            if e.get("ph") == "M":
+                continue
+            threads.setdefault((e["pid"], e.get("tid", 0)), []).append(e)
+    return threads
+
+
+def build(threads):
+    """returns the tasks, linked by their edges, and the number of dependencies not linked, per kind"""
+    tasks = []
+    by_id = collections.defaultdict(list)   # (tt, hash) -> tasks
+    inputs = []      # (producer or None, (tt, hash), input, time)
+    sends = []       # [producer or None, (tt, hash), input, time, bytes, src, dst, message id]
+    receipts = {}    # (message id, tt, hash, input) -> time
+    for (pid, tid), events in threads.items():
+        stack = []
+        message = None   # the last send or receipt of the thread, whose flow event carries the id of the message
+        for e in events:
+            ph = e.get("ph")
+            args = e.get("args", {})
+            t = to_ns(e["ts"])
+            if ph == "B" and e.get("cat") == "task":
+                task = Task(e.get("name", "TT"), args.get("tt"), args.get("hash"), args.get("key", ""), pid, tid, t)
+                task.parent = stack[-1] if stack else None
+                stack.append(task)
+                tasks.append(task)
+                by_id[(task.tt, task.key_hash)].append(task)
+            elif ph == "E":
+                if stack:
+                    task = stack.pop()
+                    task.end = t
+                    if task.parent is not None:
+                        task.parent.children += task.duration()
+            elif ph == "i" and e.get("cat") == "input":
+                inputs.append((stack[-1] if stack else None, (args.get("tt"), args.get("hash")), args.get("input"), t))
+            elif ph == "i" and e.get("cat") == "message":
+                target = (args.get("tt"), args.get("hash"))
+                if "to" in args:
+                    message = [stack[-1] if stack else None, target, args.get("input"), t, args.get("bytes", 0),
+                               pid, args["to"], None]
+                    sends.append(message)
+                else:
+                    message = (target + (args.get("input"),), t)
+            elif ph in ("s", "f") and e.get("cat") == "message" and message is not None:
+                if ph == "s" and isinstance(message, list):
+                    message[7] = e.get("id")
+                elif ph == "f" and isinstance(message, tuple):
+                    receipts.setdefault((e.get("id"),) + message[0], message[1])
+                message = None
+
+    unmatched = collections.Counter()
+
+    def find(target, time, kind):
+        """the task with id target that started first at or after time, if any"""
+        for task in by_id.get(target, []):
+            if task.start >= time:
+                return task
+        unmatched[kind] += 1
+        return None
+
+    def link(edge):
+        if edge.producer is None or edge.consumer is None or edge.producer is edge.consumer:
+            return
+        delay = edge.delay()
+        edge.producer.succs.append((edge.consumer, delay, edge))
+        edge.consumer.preds.append((edge.producer, delay, edge))
+
+    for producer, target, input, t in inputs:
+        link(Edge(producer, find(target, t, "input"), input, "input", t))
+    for producer, target, input, t, nbytes, src, dst, message in sends:
+        received = receipts.get((message,) + target + (input,))
+        if message is None or received is None:
+            unmatched["message"] += 1
+            continue
+        consumer = find(target, received, "message")
+        link(Edge(producer, consumer, input, "message", t, nbytes, max(0, received - t), src, dst))
+    for task in tasks:
+        if task.parent is not None and not task.preds:
+            link(Edge(task.parent, task, None, "inline", task.start))
+    return tasks, unmatched
+
+
+def topological_order(tasks):
+    indegree = {id(t): len(t.preds) for t in tasks}
+    ready = collections.deque(t for t in sorted(tasks, key=lambda t: t.start) if indegree[id(t)] == 0)
+    order = []
+    while ready:
+        task = ready.popleft()
+        order.append(task)
+        for succ, _, _ in task.succs:
+            indegree[id(succ)] -= 1
+            if indegree[id(succ)] == 0:
+                ready.append(succ)
+    if len(order) < len(tasks):  # a cycle, e.g. due to the clock skew between the processes: order by start
+        seen = set(id(t) for t in order)
+        order += sorted((t for t in tasks if id(t) not in seen), key=lambda t: t.start)
+    return order
+
+
+def analyze(tasks):
+    """computes the earliest finish, the slack and the critical predecessor of each task"""
+    order = topological_order(tasks)
+    position = {id(t): k for k, t in enumerate(order)}
+    for task in order:
+        task.est = 0
+        task.critical_pred = None
+        for pred, delay, edge in task.preds:
+            if position[id(pred)] >= position[id(task)]:
+                continue  # a back edge of a cycle
+            if pred.est + delay > task.est or task.critical_pred is None and pred.est + delay == task.est:
+                task.est = pred.est + delay
+                task.critical_pred = (pred, edge)
+        task.eft = task.est + task.work()
+    length = max((t.eft for t in order), default=0)
+    for task in reversed(order):
+        task.lft = length
+        for succ, delay, _ in task.succs:
+            if position[id(succ)] > position[id(task)]:
+                task.lft = min(task.lft, succ.lft - succ.work() - delay + task.work())
+        task.slack = task.lft - task.eft
+    path = []
+    last = max(order, key=lambda t: t.eft, default=None)
+    while last is not None:
+        pred = last.critical_pred
+        path.append((last, pred[1] if pred else None))
+        last = pred[0] if pred else None
+    path.reverse()
+    return length, path
+
+
+def us(ns):
+    return "%.3f" % (ns / 1000.0)
+
+
+def report(tasks, unmatched, length, path, bins, top, out):
+    work = sum(t.work() for t in tasks)
+    begin = min(t.start for t in tasks)
+    end = max(t.end for t in tasks)
+    makespan = end - begin
+    ranks = len(set(t.rank for t in tasks))
+    print("tasks: %d on %d process(es)" % (len(tasks), ranks), file=out)
+    print("total work: %s us, makespan: %s us, critical path: %s us" % (us(work), us(makespan), us(length)), file=out)
+    print("parallelism: available (work/critical path) %.2f, achieved (work/makespan) %.2f" %
+          (work / length if length else 0, work / makespan if makespan else 0), file=out)
+    if unmatched:
+        print("dependencies not linked: %s" % ", ".join("%d %s(s)" % (count, kind)
+                                                          for kind, count in sorted(unmatched.items())), file=out)
+
+    print("\ncritical path share per TT:", file=out)
+    share = collections.Counter()
+    for k, (task, edge) in enumerate(path):
+        # a task contributes until its successor on the path can start
+        share[task.name] += path[k + 1][1].delay() - path[k + 1][1].comm if k + 1 < len(path) else task.work()
+        if edge is not None and edge.comm > 0:
+            share["(communication)"] += edge.comm
+    for name, time in share.most_common():
+        print("  %-40s %12s us %6.1f%%" % (name, us(time), 100.0 * time / length if length else 0), file=out)
+
+    print("\ncritical path (%d tasks%s):" % (len(path), ", first %d shown" % top if len(path) > top else ""),
+          file=out)
+    for task, edge in path[:top]:
+        via = ""
+        if edge is not None:
+            via = " <- %s" % edge.kind
+            if edge.kind == "message":
+                via += " from rank %s (%s us, %s bytes)" % (edge.src, us(edge.comm), edge.bytes)
+        print("  rank %s thread %s %s(%s) %s us%s" % (task.rank, task.thread, task.name, task.key, us(task.work()),
+                                                      via), file=out)
+
+    messages = [(task, edge) for task, edge in path if edge is not None and edge.kind == "message"]
+    print("\nmessages on the critical path: %d" % len(messages), file=out)
+    per_edge = collections.defaultdict(lambda: [0, 0, 0])
+    for task, edge in messages:
+        stats = per_edge[(edge.producer.name, task.name, edge.input)]
+        stats[0] += 1
+        stats[1] += edge.comm
+        stats[2] += edge.bytes
+    for (src, dst, input), (count, time, nbytes) in sorted(per_edge.items(), key=lambda kv: -kv[1][1]):
+        print("  %s -> %s[%s]: %d message(s), %s us, %d bytes" % (src, dst, input, count, us(time), nbytes), file=out)
+
+    print("\nslack per TT:", file=out)
+    per_tt = collections.defaultdict(list)
+    for task in tasks:
+        per_tt[task.name].append(task)
+    print("  %-40s %8s %12s %8s %14s %14s" % ("TT", "tasks", "work (us)", "critical", "min slack (us)",
+                                                "mean slack (us)"), file=out)
+    for name, tt_tasks in sorted(per_tt.items(), key=lambda kv: -sum(t.work() for t in kv[1])):
+        slacks = [t.slack for t in tt_tasks]
+        print("  %-40s %8d %12s %8d %14s %14s" % (name, len(tt_tasks), us(sum(t.work() for t in tt_tasks)),
+                                                  sum(1 for s in slacks if s <= 0), us(min(slacks)),
+                                                  us(sum(slacks) / len(slacks))), file=out)
+
+    print("\nachieved parallelism over time (average number of tasks executing):", file=out)
+    width = max(1, makespan // bins) if makespan else 1
+    busy = [0] * bins
+    for task in tasks:
+        if task.parent is not None:
+            continue  # executed within its parent
+        for b in range(max(0, (task.start - begin) // width), min(bins, (task.end - begin) // width + 1)):
+            lo = begin + b * width
+            busy[b] += max(0, min(task.end, lo + width) - max(task.start, lo))
+    peak = max(busy) if busy else 0
+    for b in range(bins):
+        level = busy[b] / width
+        bar = "#" * int(round(40.0 * busy[b] / peak)) if peak else ""
+        print("  %12s us %8.2f %s" % (us(b * width), level, bar), file=out)
+
+
+def write_slack_csv(tasks, file):
+    begin = min(t.start for t in tasks)
+    with open(file, "w") as f:
+        f.write("rank,thread,tt,key,start_us,work_us,slack_us,critical\n")
+        for task in sorted(tasks, key=lambda t: t.start):
+            f.write("%s,%s,\"%s\",\"%s\",%s,%s,%s,%d\n" % (task.rank, task.thread, task.name.replace('"', '""'),
+                                                          str(task.key).replace('"', '""'), us(task.start - begin),
+                                                          us(task.work()), us(task.slack), task.slack <= 0))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("timelines", nargs="+", help="the Chrome JSON timelines, one per process")
+    parser.add_argument("--bins", type=int, default=20, help="the number of intervals of the parallelism profile")
+    parser.add_argument("--top", type=int, default=50, help="the number of tasks of the critical path listed")
+    parser.add_argument("--slack-csv", metavar="FILE", help="write the slack of every task to FILE")
+    args = parser.parse_args()
+
+    tasks, unmatched = build(load(args.timelines))
+    if not tasks:
+        print("no task found in the timelines", file=sys.stderr)
+        return 1
+    length, path = analyze(tasks)
+    report(tasks, unmatched, length, path, max(1, args.bins), args.top, sys.stdout)
+    if args.slack_csv:
+        write_slack_csv(tasks, args.slack_csv)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,64 @@
+#include <catch2/catch.hpp>
+
+#include "ttg.h"
+
+#include <algorithm>
+
+namespace collectives {
+  struct point {
+    int x;
+    double y;
+  };
+}  // namespace collectives
+
+TEST_CASE("Collectives", "[core][collectives]") {
+  auto world = ttg::default_execution_context();
+  const int rank = world.rank();
+  const int size = world.size();
+
+  SECTION("allreduce") {
+    CHECK(world.allreduce(rank + 1) == size * (size + 1) / 2);
+    CHECK(world.allreduce(1.0, std::multiplies<>{}) == 1.0);
+    auto max = world.allreduce(rank, [](int a, int b) { return std::max(a, b); });
+    CHECK(max == size - 1);
+    auto sum = world.allreduce(collectives::point{rank, 1.0}, [](const auto &a, const auto &b) {
+      return collectives::point{a.x + b.x, a.y + b.y};
+    });
+    CHECK(sum.x == size * (size - 1) / 2);
+    CHECK(sum.y == size);
+  }
+
+  SECTION("reduce") {
+    auto sum = world.reduce(rank + 1, 0);
+    if (rank == 0) CHECK(sum == size * (size + 1) / 2);
+    auto max = world.reduce(rank, size - 1, [](int a, int b) { return std::max(a, b); });
+    if (rank == size - 1) CHECK(max == size - 1);
+  }
+
+  SECTION("broadcast") {
+    collectives::point p{rank, 2.0 * rank};
+    world.broadcast(p, size - 1);
+    CHECK(p.x == size - 1);
+    CHECK(p.y == 2.0 * (size - 1));
+  }
+
+  SECTION("allgather") {
+    auto ranks = world.allgather(rank);
+    REQUIRE(ranks.size() == size);
+    for (int r = 0; r < size; ++r) CHECK(ranks[r] == r);
+
+    std::vector<int> values(rank, rank);
+    auto all_values = world.allgatherv(values);
+    CHECK(all_values.size() == size * (size - 1) / 2);
+    CHECK(std::is_sorted(all_values.begin(), all_values.end()));
+  }
+
+  SECTION("non-blocking") {
+    auto sum = world.iallreduce(rank + 1);
+    auto max = world.iallreduce(rank, [](int a, int b) { return std::max(a, b); });
+    auto ranks = world.iallgather(rank);
+    CHECK(sum.get() == size * (size + 1) / 2);
+    CHECK(max.get() == size - 1);
+    CHECK(ranks.get().size() == size);
+  }
+}
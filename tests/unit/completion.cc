@@ -0,0 +1,63 @@
+#include <catch2/catch.hpp>
+
+#include "ttg/util/completion.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+TEST_CASE("Completion", "[core][completion]") {
+  using counter = ttg::detail::tt_counter_slots;
+  counter a(1), b(1);
+  std::atomic<std::uint64_t> quiescences = 0;
+  CHECK(!ttg::Completion{}.valid());
+
+  SECTION("termination") {
+    // tasks completed before the handle is created are not counted
+    a.add(counter::tasks_created);
+    a.add(counter::tasks_executed);
+    ttg::Completion completion({&a, &b}, &quiescences, true);
+    REQUIRE(completion.valid());
+    CHECK(completion.completed() == 0);
+    CHECK(completion.ready());  // no task is pending
+    CHECK(completion.wait_for(std::chrono::milliseconds(1)) == std::future_status::ready);
+
+    // a task of a creates a task of b, then completes: b has a pending task
+    a.add(counter::tasks_created);
+    CHECK(!completion.ready());
+    CHECK(completion.wait_for(std::chrono::milliseconds(1)) == std::future_status::timeout);
+    b.add(counter::tasks_created);
+    a.add(counter::tasks_executed);
+    CHECK(completion.completed() == 1);
+    CHECK(!completion.ready());
+    // the task of b executes a fused task, then completes
+    b.add(counter::tasks_created);
+    b.add(counter::tasks_executed);
+    b.add(counter::tasks_executed);
+    CHECK(completion.completed() == 3);
+    CHECK(completion.ready());
+
+    b.add(counter::tasks_created);
+    std::thread worker([&b] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      b.add(counter::tasks_executed);
+    });
+    ttg::Completion next({&b}, &quiescences, true);
+    next.wait();
+    CHECK(next.ready());
+    worker.join();
+    CHECK(next.completed() == 1);
+    CHECK(next.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+  }
+
+  SECTION("quiescence") {
+    // with several processes, only the quiescence of the world terminates the TTs
+    ttg::Completion completion({&a}, &quiescences, false);
+    a.add(counter::tasks_created);
+    a.add(counter::tasks_executed);
+    CHECK(!completion.ready());
+    ++quiescences;
+    CHECK(completion.ready());
+  }
+}
@@ -0,0 +1,86 @@
+#include <catch2/catch.hpp>
+
+#include "ttg/util/counters.h"
+
+#include <sstream>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Counters", "[core][counters]") {
+  using slots_t = ttg::detail::tt_counter_slots;
+
+  SECTION("slots") {
+    slots_t slots(2);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+      threads.emplace_back([&slots] {
+        for (int k = 0; k < 1000; ++k) {
+          slots.add(slots_t::tasks_executed);
+          slots.add_bytes_sent(1, 8);
+        }
+        slots.add(slots_t::set_arg_remote, 10);
+      });
+    for (auto &thread : threads) thread.join();
+    slots.add_bytes_received(0, 3);
+    slots.add_bytes_received(2, 3);  // not an input terminal, ignored
+
+    auto c = slots.snapshot();
+    CHECK(c.tasks_executed == 4000);
+    CHECK(c.set_arg_remote == 40);
+    CHECK(c.tasks_created == 0);
+    CHECK(c.bytes_sent == std::vector<std::uint64_t>{0, 32000});
+    CHECK(c.bytes_received == std::vector<std::uint64_t>{3, 0});
+
+    slots.reset();
+    c = slots.snapshot();
+    CHECK(c.tasks_executed == 0);
+    CHECK(c.bytes_sent == std::vector<std::uint64_t>{0, 0});
+
+    // the byte counts of a slot span several cache lines
+    slots_t many(6);
+    for (std::size_t t = 0; t < 6; ++t) {
+      many.add_bytes_sent(t, t);
+      many.add_bytes_received(t, 10 * t);
+    }
+    c = many.snapshot();
+    CHECK(c.bytes_sent == std::vector<std::uint64_t>{0, 1, 2, 3, 4, 5});
+    CHECK(c.bytes_received == std::vector<std::uint64_t>{0, 10, 20, 30, 40, 50});
+  }
+
+  SECTION("sum") {
+    ttg::TTCounters a, b;
+    a.tasks_created = 1;
+    a.peak_pending_tasks = 5;
+    a.bytes_sent = {1};
+    b.tasks_created = 2;
+    b.peak_pending_tasks = 3;
+    b.bytes_sent = {1, 2};
+    a += b;
+    CHECK(a.tasks_created == 3);
+    CHECK(a.peak_pending_tasks == 5);
+    CHECK(a.bytes_sent == std::vector<std::uint64_t>{2, 2});
+  }
+
+  SECTION("write") {
+    ttg::TTCounters c;
+    c.name = "a \"tt\"";
+    c.tasks_executed = 7;
+    c.bytes_sent = {1, 2};
+    c.bytes_received = {0, 0};
+
+    std::ostringstream json;
+    ttg::write_counters(json, {c});
+    CHECK(json.str().find("\"name\": \"a \\\"tt\\\"\"") != std::string::npos);
+    CHECK(json.str().find("\"tasks_executed\": 7") != std::string::npos);
+    CHECK(json.str().find("\"bytes_sent\": [1, 2]") != std::string::npos);
+
+    std::ostringstream csv;
+    ttg::write_counters(csv, {c}, ttg::CountersFormat::CSV);
+    std::istringstream lines(csv.str());
+    std::string header, row;
+    std::getline(lines, header);
+    std::getline(lines, row);
+    CHECK(header.rfind("name,tasks_created,tasks_executed,", 0) == 0);
+    CHECK(row == "\"a \"\"tt\"\"\",0,7,0,0,0,0,0,0,0,1;2,0;0");
+  }
+}
@@ -0,0 +1,36 @@
+#!/usr/bin/env python3
+
+"""Checks bin/ttg_critical_path.py on the timelines critical_path.{0,1}.json of 2 processes: task A (0-10 us) of
+process 0 sets the input of task B (3-8 us) at 2 us and sends the input of task C of process 1 at 4 us, which is
+received at 6 us; C executes from 7 to 12 us. The critical path is A until the send, the message, then C. A also sends
+another input of C at 4.5 us, received first, at 5.5 us, a message whose receipt is not recorded, and sets an input of
+B after B started: the messages are paired with their receipts by their ids, and the last 2 dependencies not linked."""
+
+import importlib.util
+import io
+import os
+
+here = os.path.dirname(os.path.abspath(__file__))
+spec = importlib.util.spec_from_file_location("ttg_critical_path",
+                                              os.path.join(here, "..", "..", "bin", "ttg_critical_path.py"))
+tool = importlib.util.module_from_spec(spec)
+spec.loader.exec_module(tool)
+
+tasks, unmatched = tool.build(tool.load([os.path.join(here, "critical_path.%d.json" % rank) for rank in range(2)]))
+assert unmatched == {"message": 1, "input": 1}, unmatched
+assert sorted(t.name for t in tasks) == ["A", "B", "C"], [t.name for t in tasks]
+length, path = tool.analyze(tasks)
+makespan = max(t.end for t in tasks) - min(t.start for t in tasks)
+assert length <= makespan, (length, makespan)
+assert length == 11000, length  # 4 us of A, 2 us of communication, 5 us of C
+assert [t.name for t, _ in path] == ["A", "C"], [t.name for t, _ in path]
+assert path[1][1].kind == "message" and path[1][1].comm == 2000
+slack = {t.name: t.slack for t in tasks}
+assert slack["A"] == 0 and slack["C"] == 0 and slack["B"] == 4000, slack
+
+out = io.StringIO()
+tool.report(tasks, unmatched, length, path, 4, 10, out)
+assert "critical path: 11.000 us" in out.getvalue(), out.getvalue()
+assert "(communication)" in out.getvalue(), out.getvalue()
+assert "dependencies not linked: 1 input(s), 1 message(s)" in out.getvalue(), out.getvalue()
+print(out.getvalue(), end="")
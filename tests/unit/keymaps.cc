@@ -0,0 +1,114 @@
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <initializer_list>
+#include <ostream>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "ttg/keymaps.h"
+#include "ttg/util/multiindex.h"
+
+namespace {
+  /// node of a binary tree: level n, translation l in [0,2^n)
+  struct BinaryTreeKey {
+    int n = 0;
+    std::int64_t l = 0;
+    int level() const { return n; }
+    BinaryTreeKey parent(int generations = 1) const { return {n - generations, l >> generations}; }
+    std::size_t hash() const { return (std::size_t(n) << 48) + l; }
+  };
+}  // namespace
+
+TEST_CASE("Keymaps", "[core][keymap]") {
+  SECTION("process grid") {
+    CHECK(ttg::process_grid_2d(1) == std::pair{1, 1});
+    CHECK(ttg::process_grid_2d(12) == std::pair{3, 4});
+    CHECK(ttg::process_grid_2d(16) == std::pair{4, 4});
+    CHECK(ttg::process_grid_2d(7) == std::pair{1, 7});
+  }
+
+  SECTION("block-cyclic 2d") {
+    ttg::BlockCyclic2DKeymap keymap(2, 3, 2, 1);
+    CHECK(keymap(ttg::MultiIndex<2>{0, 0}) == 0);
+    CHECK(keymap(ttg::MultiIndex<2>{1, 0}) == 0);
+    CHECK(keymap(ttg::MultiIndex<2>{2, 0}) == 1);
+    CHECK(keymap(ttg::MultiIndex<2>{0, 1}) == 2);
+    CHECK(keymap(ttg::MultiIndex<2>{2, 2}) == 5);
+    CHECK(keymap(ttg::MultiIndex<2>{4, 3}) == 0);
+    // tuple-like keys
+    CHECK(keymap(std::pair{2, 2}) == 5);
+    // every process owns the same number of blocks of a matrix conforming to the grid
+    std::vector<int> count(6, 0);
+    for (int i = 0; i < 8; ++i)
+      for (int j = 0; j < 9; ++j) count[keymap(std::pair{i, j})]++;
+    for (auto c : count) CHECK(c == 12);
+  }
+
+  SECTION("3d grid") {
+    ttg::ProcessGrid3DKeymap keymap(2, 2, 3);
+    CHECK(keymap(ttg::MultiIndex<3>{1, 1, 0}) == 3);
+    CHECK(keymap(ttg::MultiIndex<3>{1, 1, 1}) == 7);
+    CHECK(keymap(ttg::MultiIndex<3>{1, 1, 5}) == 11);
+    auto layer = keymap.layer_keymap(2);
+    CHECK(layer(ttg::MultiIndex<2>{1, 0}) == 9);
+    for (int i = 0; i < 4; ++i)
+      for (int j = 0; j < 4; ++j)
+        for (int k = 0; k < 6; ++k)
+          CHECK(keymap(ttg::MultiIndex<3>{i, j, k}) == keymap.layer_keymap(keymap.layer_of(k))(std::pair{i, j}));
+  }
+
+  SECTION("z-order") {
+    // the curve visits all keys of the box, in Morton order if the box is a power-of-2 cube
+    ttg::ZOrderKeymap<2> square(1, {4, 4});
+    CHECK(square.curve_index({0, 0}) == 0);
+    CHECK(square.curve_index({1, 0}) == 1);
+    CHECK(square.curve_index({0, 1}) == 2);
+    CHECK(square.curve_index({1, 1}) == 3);
+    CHECK(square.curve_index({2, 0}) == 4);
+    CHECK(square.curve_index({3, 3}) == 15);
+    for (std::int64_t nx : {1, 3, 5, 8}) {
+      for (std::int64_t ny : {2, 7}) {
+        for (std::int64_t nz : {1, 6}) {
+          ttg::ZOrderKeymap<3> keymap(4, {nx, ny, nz});
+          std::set<std::int64_t> positions;
+          for (std::int64_t i = 0; i < nx; ++i)
+            for (std::int64_t j = 0; j < ny; ++j)
+              for (std::int64_t k = 0; k < nz; ++k) positions.insert(keymap.curve_index({i, j, k}));
+          REQUIRE(positions.size() == static_cast<std::size_t>(nx * ny * nz));
+          CHECK(*positions.rbegin() == nx * ny * nz - 1);
+        }
+      }
+    }
+    // the pieces are balanced and compact
+    const int nproc = 4;
+    ttg::ZOrderKeymap<2> keymap(nproc, {6, 10});
+    std::vector<int> count(nproc, 0);
+    for (int i = 0; i < 6; ++i)
+      for (int j = 0; j < 10; ++j) count[keymap(ttg::MultiIndex<2>{i, j})]++;
+    for (auto c : count) CHECK(c == 15);
+    CHECK(keymap(ttg::MultiIndex<2>{0, 0}) == 0);
+    CHECK(keymap(ttg::MultiIndex<2>{5, 9}) == nproc - 1);
+  }
+
+  SECTION("trees") {
+    const int nproc = 5;
+    ttg::SubtreeKeymap<BinaryTreeKey> subtree(nproc, 2);
+    CHECK(subtree.target_level() == 3);
+    ttg::ParentColocatingKeymap<BinaryTreeKey> colocating(nproc, 3, 2);
+    CHECK(colocating(BinaryTreeKey{0, 0}) == 0);
+    for (int n = 1; n < 10; ++n) {
+      for (std::int64_t l = 0; l < (std::int64_t{1} << n); ++l) {
+        const BinaryTreeKey key{n, l};
+        const auto owner = subtree(key);
+        CHECK((owner >= 0 && owner < nproc));
+        if (n > subtree.target_level()) CHECK(owner == subtree(key.parent()));
+        if (n > 3 && n % 2 == 0) CHECK(colocating(key) == colocating(key.parent()));
+        if (n <= 3 || n % 2 == 1) CHECK(colocating(key) == static_cast<int>(key.hash() % nproc));
+      }
+    }
+  }
+}
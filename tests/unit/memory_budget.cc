@@ -0,0 +1,123 @@
+#include <catch2/catch.hpp>
+
+#include "ttg/util/memory_budget.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Memory budget", "[core][budget]") {
+  SECTION("footprint") {
+    CHECK(ttg::footprint(1.0) == sizeof(double));
+    std::vector<double> v(100);
+    CHECK(ttg::footprint(v) == sizeof(v) + 100 * sizeof(double));
+    const std::string s(10, 'x');
+    CHECK(ttg::footprint(s) == sizeof(s) + 10);
+  }
+
+  SECTION("charges") {
+    ttg::detail::memory_budget tt_budget, world_budget;
+    CHECK(!tt_budget.exceeded());
+    tt_budget.set_max_pending_tasks(2);
+    world_budget.set_max_data_bytes(100);
+    {
+      ttg::detail::budget_charge c0(&tt_budget, &world_budget);
+      c0.add_bytes(60);
+      CHECK(tt_budget.pending_tasks() == 1);
+      CHECK(tt_budget.data_bytes() == 60);
+      CHECK(world_budget.data_bytes() == 60);
+      CHECK(!tt_budget.exceeded());
+      CHECK(!world_budget.exceeded());
+
+      ttg::detail::budget_charge c1;
+      c1 = ttg::detail::budget_charge(&tt_budget, &world_budget);
+      c1.add_bytes(40);
+      CHECK(tt_budget.pending_tasks() == 2);
+      CHECK(tt_budget.exceeded());
+      CHECK(world_budget.exceeded());
+
+      // a budget is not charged unless it has a limit
+      ttg::detail::memory_budget tt_budget2;
+      world_budget.set_max_data_bytes(0);
+      ttg::detail::budget_charge c3(&tt_budget2, &world_budget);
+      c3.add_bytes(10);
+      CHECK(tt_budget2.pending_tasks() == 0);
+      CHECK(tt_budget2.data_bytes() == 0);
+      CHECK(world_budget.pending_tasks() == 2);
+      CHECK(world_budget.data_bytes() == 100);
+      c3.release();
+      CHECK(tt_budget2.completed_tasks() == 0);
+      CHECK(world_budget.completed_tasks() == 0);
+      world_budget.set_max_data_bytes(100);
+      // the world budget is charged even if the TT budget has no limit
+      ttg::detail::budget_charge c4(&tt_budget2, &world_budget);
+      CHECK(tt_budget2.pending_tasks() == 0);
+      CHECK(world_budget.pending_tasks() == 3);
+      c4.release();
+
+      // moving the charge does not release it
+      ttg::detail::budget_charge c2(std::move(c0));
+      CHECK(world_budget.data_bytes() == 100);
+      c2.release();
+      c2.release();  // released once
+      CHECK(tt_budget.pending_tasks() == 1);
+      CHECK(world_budget.data_bytes() == 40);
+      CHECK(tt_budget.completed_tasks() == 1);
+      CHECK(!tt_budget.exceeded());
+    }
+    CHECK(tt_budget.pending_tasks() == 0);
+    CHECK(world_budget.pending_tasks() == 0);
+    CHECK(world_budget.data_bytes() == 0);
+    CHECK(world_budget.completed_tasks() == 3);
+  }
+
+  SECTION("throttle") {
+    ttg::detail::memory_budget tt_budget, world_budget;
+    world_budget.set_max_pending_tasks(4);
+    std::vector<ttg::detail::budget_charge> pending;
+    for (int t = 0; t < 4; ++t) pending.emplace_back(&tt_budget, &world_budget);
+    REQUIRE(world_budget.blocks());
+
+    // the producer proceeds once a consumer completes a task, or once it stalls if the consumer is slow to start
+    const auto timeout = std::chrono::microseconds(ttg::detail::budget_stall_timeout());
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool started = false;
+    std::uint64_t completed_on_return = 0;
+    std::chrono::steady_clock::duration throttled_for{};
+    std::thread producer([&] {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        started = true;
+      }
+      cv.notify_one();
+      const auto start = std::chrono::steady_clock::now();
+      ttg::detail::throttle(tt_budget, world_budget);
+      throttled_for = std::chrono::steady_clock::now() - start;
+      completed_on_return = world_budget.completed_tasks();
+    });
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      cv.wait(lock, [&] { return started; });
+    }
+    pending.back().release();
+    producer.join();
+    CHECK((completed_on_return == 1 || throttled_for >= timeout));
+
+    // the producer proceeds if no task completes, and the budget is not enforced until a task completes
+    pending.emplace_back(&tt_budget, &world_budget);
+    const auto start = std::chrono::steady_clock::now();
+    ttg::detail::throttle(tt_budget, world_budget);
+    CHECK(std::chrono::steady_clock::now() - start >= timeout);
+    CHECK(world_budget.exceeded());
+    CHECK(!world_budget.blocks());
+    pending.front().release();
+    pending.emplace_back(&tt_budget, &world_budget);
+    CHECK(world_budget.blocks());
+  }
+}
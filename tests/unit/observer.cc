@@ -0,0 +1,99 @@
+#include <catch2/catch.hpp>
+
+#include "ttg/base/observer.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tt_observer {
+  /// records the keys of its events, and counts its fences
+  struct recorder : ttg::TaskObserver {
+    std::mutex mtx;
+    std::vector<std::string> keys;
+    std::atomic<int> fences = 0;
+
+    void record(const ttg::TaskKey &key) {
+      std::lock_guard<std::mutex> lock(mtx);
+      keys.push_back(key.str());
+    }
+    void fence_started() override { ++fences; }
+  };
+
+  /// removes itself from the observers when notified
+  struct self_remover : ttg::TaskObserver {
+    std::shared_ptr<ttg::TaskObserver> self;
+    void fence_finished() override {
+      if (!self) return;
+      const auto observer = std::move(self);
+      ttg::remove_task_observer(observer);
+    }
+  };
+}  // namespace tt_observer
+
+TEST_CASE("Task observers", "[core][observer]") {
+  const auto nobservers = ttg::task_observers().size();
+
+  SECTION("keys") {
+    auto a = std::make_shared<tt_observer::recorder>(), b = std::make_shared<tt_observer::recorder>();
+    ttg::add_task_observer(a);
+    ttg::add_task_observer(b);
+    ttg::add_task_observer(a);  // no effect
+    CHECK(ttg::task_observers().size() == nobservers + 2);
+    // the key of an event is built once for all observers
+    std::vector<const ttg::TaskKey *> built;
+    ttg::detail::notify_task_observers(42, [&built](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+      if (auto r = dynamic_cast<tt_observer::recorder *>(&o)) {
+        r->record(k);
+        built.push_back(&k);
+      }
+    });
+    REQUIRE(built.size() == 2);
+    CHECK(built[0] == built[1]);
+    CHECK(a->keys == std::vector<std::string>{"42"});
+    CHECK(b->keys == std::vector<std::string>{"42"});
+    ttg::remove_task_observer(a);
+    ttg::remove_task_observer(b);
+    CHECK(a.use_count() == 1);
+    CHECK(b.use_count() == 1);
+  }
+
+  SECTION("concurrent") {
+    // the observers are added and removed while other threads notify them
+    std::atomic<bool> stop = false;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+      threads.emplace_back([&stop] {
+        while (!stop) ttg::detail::notify_task_observers([](ttg::TaskObserver &o) { o.fence_started(); });
+      });
+    for (int k = 0; k < 1000; ++k) {
+      auto observer = std::make_shared<tt_observer::recorder>();
+      ttg::add_task_observer(observer);
+      ttg::remove_task_observer(observer);
+      // no longer referenced once removed
+      CHECK(observer.use_count() == 1);
+    }
+    stop = true;
+    for (auto &thread : threads) thread.join();
+  }
+
+  SECTION("removed while notified") {
+    auto remover = std::make_shared<tt_observer::self_remover>();
+    remover->self = remover;
+    ttg::add_task_observer(remover);
+    ttg::detail::notify_task_observers([](ttg::TaskObserver &o) { o.fence_finished(); });
+    CHECK(ttg::task_observers().size() == nobservers);
+    // the list that held it is freed by the next change of the observers
+    std::weak_ptr<tt_observer::self_remover> weak = remover;
+    remover.reset();
+    auto observer = std::make_shared<tt_observer::recorder>();
+    ttg::add_task_observer(observer);
+    CHECK(weak.expired());
+    ttg::remove_task_observer(observer);
+  }
+
+  CHECK(ttg::task_observers().size() == nobservers);
+}
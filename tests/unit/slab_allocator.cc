@@ -0,0 +1,78 @@
+#include <catch2/catch.hpp>
+
+#include "ttg/util/slab_allocator.h"
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace slab_allocator {
+  struct base {
+    virtual ~base() = default;
+  };
+
+  struct object final : base, ttg::detail::slab_allocated<object> {
+    double payload[7];
+    int value;
+    object(int v) : value(v) {}
+  };
+
+  struct alignas(128) aligned_object final : base, ttg::detail::slab_allocated<aligned_object> {
+    int value;
+    aligned_object(int v) : value(v) {}
+  };
+}  // namespace slab_allocator
+
+TEST_CASE("Slab allocator", "[core][slab]") {
+  using slab_allocator::base;
+  using slab_allocator::object;
+  using pool_t = ttg::detail::slab_pool<ttg::detail::slab_size_class(sizeof(object))>;
+
+  SECTION("size classes") {
+    CHECK(ttg::detail::slab_size_class(1) == 16);
+    CHECK(ttg::detail::slab_size_class(16) == 16);
+    CHECK(ttg::detail::slab_size_class(200) == 208);
+    CHECK(ttg::detail::slab_size_class(300) == 320);
+    CHECK(ttg::detail::slab_size_class(1500) == 2048);
+  }
+
+  SECTION("local and remote frees") {
+    const auto stats0 = pool_t::instance().stats();
+    constexpr int n = 10000;
+    std::vector<base *> objects;
+    for (int i = 0; i < n; ++i) objects.push_back(new object(i));
+    for (int i = 0; i < n; ++i) CHECK(static_cast<object *>(objects[i])->value == i);
+
+    // free half on this thread, the other half on another thread
+    for (int i = 0; i < n / 2; ++i) delete objects[i];
+    std::thread t([&]() {
+      for (int i = n / 2; i < n; ++i) delete objects[i];
+    });
+    t.join();
+
+    // remotely-freed blocks are reused
+    const auto slabs = pool_t::instance().stats().slabs;
+    for (int i = 0; i < n; ++i) objects[i] = new object(-i);
+#if !defined(TTG_DISABLE_SLAB_ALLOCATOR)
+    CHECK(pool_t::instance().stats().slabs == slabs);
+#endif
+    for (int i = 0; i < n; ++i) CHECK(static_cast<object *>(objects[i])->value == -i);
+    for (auto o : objects) delete o;
+
+#if !defined(TTG_DISABLE_SLAB_ALLOCATOR)
+    const auto stats1 = pool_t::instance().stats();
+    CHECK(stats1.allocs - stats0.allocs == 2 * n);
+    CHECK(stats1.frees - stats0.frees == 3 * n / 2);
+    CHECK(stats1.remote_frees - stats0.remote_frees == n / 2);
+    CHECK(stats1.in_use() == stats0.in_use());
+#endif
+  }
+
+  SECTION("over-aligned objects") {
+    using slab_allocator::aligned_object;
+    std::vector<base *> objects;
+    for (int i = 0; i < 100; ++i) objects.push_back(new aligned_object(i));
+    for (auto o : objects) CHECK(reinterpret_cast<std::uintptr_t>(static_cast<aligned_object *>(o)) % 128 == 0);
+    for (auto o : objects) delete o;
+  }
+}
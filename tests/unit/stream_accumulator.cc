@@ -0,0 +1,77 @@
+#include <catch2/catch.hpp>
+
+#include "ttg/util/stream_accumulator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST_CASE("Stream accumulator", "[core][reduce]") {
+  constexpr int nthreads = 4;
+  constexpr int nvalues = 1000;  // per thread
+
+  SECTION("atomic") {
+    ttg::detail::stream_accumulator<long> accumulator(ttg::ReduceMode::Atomic);
+    CHECK(!accumulator.has_value());
+    auto sum = [](long &a, const long &b) { a += b; };
+    std::atomic<int> nlast = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nthreads; ++t) {
+      threads.emplace_back([&, t] {
+        for (int v = 0; v < nvalues; ++v) {
+          accumulator.begin();
+          accumulator.reduce(static_cast<long>(t * nvalues + v), sum);
+          if (accumulator.end()) ++nlast;
+        }
+      });
+    }
+    for (auto &thread : threads) thread.join();
+    // the stream is not complete until complete() is called
+    CHECK(nlast == 0);
+    CHECK(accumulator.complete());
+    REQUIRE(accumulator.has_value());
+    const long n = nthreads * nvalues;
+    CHECK(accumulator.take(sum) == n * (n - 1) / 2);
+  }
+
+  SECTION("per-thread") {
+    // fewer slots than threads, some threads share a partial result
+    ttg::detail::stream_accumulator<std::vector<int>> accumulator(ttg::ReduceMode::PerThread, 3);
+    auto append = [](std::vector<int> &a, const std::vector<int> &b) { a.insert(a.end(), b.begin(), b.end()); };
+    std::atomic<int> nlast = 0;
+    // each thread contributes once, reducing many values
+    for (int t = 0; t < nthreads; ++t) accumulator.begin();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nthreads; ++t) {
+      threads.emplace_back([&, t] {
+        for (int v = 0; v < nvalues; ++v) accumulator.reduce(std::vector<int>{t * nvalues + v}, append);
+        if (accumulator.end()) ++nlast;
+      });
+    }
+    // the stream completes while the reductions are in flight, exactly one party sees the last contribution
+    if (accumulator.complete()) ++nlast;
+    for (auto &thread : threads) thread.join();
+    CHECK(nlast == 1);
+    REQUIRE(accumulator.has_value());
+    auto result = accumulator.take(append);
+    std::sort(result.begin(), result.end());
+    REQUIRE(result.size() == nthreads * nvalues);
+    for (int v = 0; v < nthreads * nvalues; ++v) CHECK(result[v] == v);
+    CHECK(!accumulator.has_value());
+  }
+
+  SECTION("per-thread first value is moved") {
+    ttg::detail::stream_accumulator<std::vector<int>> accumulator(ttg::ReduceMode::PerThread, 1);
+    auto append = [](std::vector<int> &a, const std::vector<int> &b) { a.insert(a.end(), b.begin(), b.end()); };
+    std::vector<int> first{1, 2, 3};
+    const auto *data = first.data();
+    accumulator.begin();
+    accumulator.reduce(std::move(first), append);
+    CHECK(accumulator.end() == false);
+    CHECK(accumulator.complete());
+    auto result = accumulator.take(append);
+    CHECK(result.data() == data);
+    CHECK(result == std::vector<int>{1, 2, 3});
+  }
+}
@@ -0,0 +1,102 @@
+#include <catch2/catch.hpp>
+
+#include "ttg/util/task_batch.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace task_batch {
+  struct task {
+    int id;
+  };
+
+  struct with_batch_op {
+    static constexpr const bool have_batch_op = true;
+  };
+  struct without_batch_op {
+    static constexpr const bool have_batch_op = false;
+  };
+}  // namespace task_batch
+
+TEST_CASE("Ready batch queue", "[core][batch]") {
+  using namespace std::chrono_literals;
+  static_assert(ttg::detail::derived_has_batch_op<task_batch::with_batch_op>());
+  static_assert(!ttg::detail::derived_has_batch_op<task_batch::without_batch_op>());
+  static_assert(!ttg::detail::derived_has_batch_op<task_batch::task>());
+
+  SECTION("leaders") {
+    ttg::detail::ready_batch_queue<task_batch::task> queue;
+    std::vector<task_batch::task> tasks(10);
+    for (int t = 0; t < 10; ++t) tasks[t].id = t;
+    // only the first task is handed to the scheduler
+    CHECK(queue.push(&tasks[0]));
+    for (int t = 1; t < 10; ++t) CHECK(!queue.push(&tasks[t]));
+    std::vector<task_batch::task *> batch;
+    auto *leader = queue.pop(batch, 4, 0us);
+    REQUIRE(batch.size() == 4);
+    for (int t = 0; t < 4; ++t) CHECK(batch[t] == &tasks[t]);
+    CHECK(leader == &tasks[4]);
+    batch.clear();
+    leader = queue.pop(batch, 8, 0us);
+    REQUIRE(batch.size() == 6);
+    CHECK(batch.front() == &tasks[4]);
+    CHECK(leader == nullptr);
+    // the queue is empty, the next task leads
+    CHECK(queue.push(&tasks[0]));
+  }
+
+  SECTION("linger") {
+    ttg::detail::ready_batch_queue<task_batch::task> queue;
+    std::vector<task_batch::task> tasks(4);
+    CHECK(queue.push(&tasks[0]));
+    // Catch2 assertions are not thread-safe, the pusher records its results for the main thread
+    std::atomic<int> nleaders = 0;
+    std::thread pusher([&] {
+      for (int t = 1; t < 4; ++t)
+        if (queue.push(&tasks[t])) ++nleaders;
+    });
+    std::vector<task_batch::task *> batch;
+    // waits for the batch to fill
+    CHECK(queue.pop(batch, 4, 10s) == nullptr);
+    pusher.join();
+    CHECK(nleaders == 0);
+    CHECK(batch.size() == 4);
+  }
+
+  SECTION("concurrent") {
+    constexpr int nthreads = 4;
+    constexpr int ntasks = 1000;  // per thread
+    ttg::detail::ready_batch_queue<task_batch::task> queue;
+    std::vector<task_batch::task> tasks(nthreads * ntasks);
+    for (int t = 0; t < nthreads * ntasks; ++t) tasks[t].id = t;
+    std::vector<std::atomic<int>> nexecuted(nthreads * ntasks);
+    // Catch2 assertions are not thread-safe, the threads count the malformed batches for the main thread
+    std::atomic<int> nbad_leaders = 0;
+    std::atomic<int> nbad_sizes = 0;
+    // the threads execute the leaders they are handed, and the leaders they appoint
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nthreads; ++t) {
+      threads.emplace_back([&, t] {
+        for (int i = 0; i < ntasks; ++i) {
+          auto *leader = &tasks[t * ntasks + i];
+          if (!queue.push(leader)) continue;
+          while (leader) {
+            std::vector<task_batch::task *> batch;
+            auto *next = queue.pop(batch, 16, 0us);
+            if (batch.empty() || batch.front() != leader) ++nbad_leaders;
+            if (batch.size() > 16) ++nbad_sizes;
+            for (auto *task : batch) ++nexecuted[task->id];
+            leader = next;
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) thread.join();
+    CHECK(nbad_leaders == 0);
+    CHECK(nbad_sizes == 0);
+    // each task is executed once
+    for (int t = 0; t < nthreads * ntasks; ++t) CHECK(nexecuted[t] == 1);
+  }
+}
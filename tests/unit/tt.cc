@@ -2,7 +2,16 @@
 
 #include "ttg.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
 #include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 #include "ttg/util/meta/callable.h"
 
@@ -438,3 +447,681 @@ TEST_CASE("TemplateTask", "[core]") {
     }
   }
 }
+
+namespace tt_shared_reads {
+  inline std::atomic<int> ncopies = 0;
+
+  /// counts its copies
+  struct tile {
+    std::vector<double> data;
+
+    tile() = default;
+    explicit tile(std::size_t n) : data(n) {}
+    tile(const tile &other) : data(other.data) { ++ncopies; }
+    tile(tile &&) = default;
+    tile &operator=(const tile &other) {
+      data = other.data;
+      ++ncopies;
+      return *this;
+    }
+    tile &operator=(tile &&) = default;
+
+#ifdef TTG_SERIALIZATION_SUPPORTS_MADNESS
+    template <typename Archive>
+    void serialize(Archive &ar) {
+      ar &data;
+    }
+#endif
+#ifdef TTG_SERIALIZATION_SUPPORTS_BOOST
+    template <typename Archive>
+    void serialize(Archive &ar, const unsigned int) {
+      ar &data;
+    }
+#endif
+
+    friend std::ostream &operator<<(std::ostream &os, const tile &t) { return os << "tile(" << t.data.size() << ")"; }
+  };
+}  // namespace tt_shared_reads
+
+TEST_CASE("TemplateTask shared reads", "[core]") {
+  using tt_shared_reads::tile;
+  constexpr int N = 16;
+  auto world = ttg::default_execution_context();
+  ttg::Edge<int, int> I2P;
+  ttg::Edge<int, tile> P2R;
+  std::atomic<int> nread = 0;
+
+  auto producer = ttg::make_tt(
+      [](const int &key, const int &size, std::tuple<ttg::Out<int, tile>> &outs) {
+        tile t(size);
+        ttg::send<0>(key, t, outs);
+      },
+      ttg::edges(I2P), ttg::edges(P2R));
+  auto reader = [&nread](const int &key, const tile &t, std::tuple<> &outs) {
+    CHECK(t.data.size() == static_cast<std::size_t>(key + 1));
+    ++nread;
+  };
+  auto reader_a = ttg::make_tt(reader, ttg::edges(P2R), ttg::edges());
+  auto reader_b = ttg::make_tt(reader, ttg::edges(P2R), ttg::edges());
+  make_graph_executable(producer);
+  tt_shared_reads::ncopies = 0;
+  if (world.rank() == 0) {
+    for (int key = 0; key < N; ++key) producer->invoke(key, key + 1);
+  }
+  ttg::ttg_fence(world);
+  CHECK(world.allreduce(nread.load()) == 2 * N);
+  // both readers of a key are local to its producer and share a single copy of the tile
+  CHECK(world.allreduce(tt_shared_reads::ncopies.load()) <= N);
+}
+
+namespace tt_inline_values {
+  // small and trivially copyable, hence stored in the tasks by the PaRSEC backend
+  struct point {
+    int key;
+    double value;
+  };
+}  // namespace tt_inline_values
+
+TEST_CASE("TemplateTask inline values", "[core]") {
+  using tt_inline_values::point;
+  constexpr int N = 32;
+  auto world = ttg::default_execution_context();
+  ttg::Edge<int, point> I2P, P2M, M2R, R2C;
+  std::atomic<int> nexecuted = 0;
+
+  // broadcasts its input to 2 keys
+  auto producer = ttg::make_tt(
+      [](const int &key, const point &p, std::tuple<ttg::Out<int, point>> &outs) {
+        ttg::broadcast<0>(std::vector<int>{2 * key, 2 * key + 1}, p, outs);
+      },
+      ttg::edges(I2P), ttg::edges(P2M));
+  // modifies its input and sends it on
+  auto mutator = ttg::make_tt(
+      [](const int &key, point &p, std::tuple<ttg::Out<int, point>> &outs) {
+        p.key = key;
+        p.value *= 2;
+        ttg::send<0>(key, p, outs);
+      },
+      ttg::edges(P2M), ttg::edges(M2R));
+  // sends its input on
+  auto relay = ttg::make_tt([](const int &key, const point &p,
+                               std::tuple<ttg::Out<int, point>> &outs) { ttg::send<0>(key, p, outs); },
+                            ttg::edges(M2R), ttg::edges(R2C));
+  auto consumer = ttg::make_tt(
+      [&nexecuted](const int &key, const point &p, std::tuple<> &outs) {
+        CHECK(p.key == key);
+        CHECK(p.value == 2.0 * (key / 2));
+        ++nexecuted;
+      },
+      ttg::edges(R2C), ttg::edges());
+  make_graph_executable(producer);
+  if (world.rank() == 0) {
+    for (int key = 0; key < N; ++key) producer->invoke(key, point{-1, static_cast<double>(key)});
+  }
+  ttg::ttg_fence(world);
+  CHECK(world.allreduce(nexecuted.load()) == 2 * N);
+}
+
+TEST_CASE("TemplateTask key domain", "[core]") {
+  constexpr int N = 64;
+  auto world = ttg::default_execution_context();
+  ttg::Edge<int, int> I2P, P2C_a, P2C_b;
+  std::atomic<int> nexecuted = 0;
+
+  auto producer = ttg::make_tt(
+      [](const int &key, const int &value, std::tuple<ttg::Out<int, int>, ttg::Out<int, int>> &outs) {
+        ttg::send<0>(key, value, outs);
+        ttg::send<1>(key, 2 * value, outs);
+      },
+      ttg::edges(I2P), ttg::edges(P2C_a, P2C_b));
+  auto consumer = ttg::make_tt(
+      [&nexecuted](const int &key, const int &a, const int &b, std::tuple<> &outs) {
+        CHECK(a == key);
+        CHECK(b == 2 * key);
+        ++nexecuted;
+      },
+      ttg::edges(P2C_a, P2C_b), ttg::edges());
+  // pending consumer tasks are kept in a table indexed by the key
+  consumer->set_key_domain(N, [](const int &key) { return static_cast<std::size_t>(key); });
+  make_graph_executable(producer);
+  if (world.rank() == 0) {
+    for (int key = 0; key < N; ++key) producer->invoke(key, key);
+  }
+  ttg::ttg_fence(world);
+  CHECK(world.allreduce(nexecuted.load()) == N);
+}
+
+TEST_CASE("TemplateTask reduce modes", "[core]") {
+  constexpr int N = 64;  // number of values reduced per key
+  constexpr int K = 4;   // number of keys
+  auto world = ttg::default_execution_context();
+
+  for (auto mode : {ttg::ReduceMode::Locked, ttg::ReduceMode::Atomic, ttg::ReduceMode::PerThread}) {
+    ttg::Edge<int, int> I2P;
+    ttg::Edge<int, double> P2S;
+    ttg::Edge<int, std::vector<int>> P2A;
+    std::atomic<int> nexecuted = 0;
+
+    auto producer = ttg::make_tt(
+        [](const int &key, const int &value,
+           std::tuple<ttg::Out<int, double>, ttg::Out<int, std::vector<int>>> &outs) {
+          ttg::send<0>(key % K, static_cast<double>(value), outs);
+          ttg::send<1>(key % K, std::vector<int>{value}, outs);
+        },
+        ttg::edges(I2P), ttg::edges(P2S, P2A));
+    auto sum = ttg::make_tt(
+        [&nexecuted](const int &key, const double &value, std::tuple<> &outs) {
+          CHECK(value == K * N * (N - 1) / 2 + N * key);
+          ++nexecuted;
+        },
+        ttg::edges(P2S), ttg::edges());
+    auto gather = ttg::make_tt(
+        [&nexecuted](const int &key, const std::vector<int> &all, std::tuple<> &outs) {
+          std::vector<int> sorted(all);
+          std::sort(sorted.begin(), sorted.end());
+          REQUIRE(sorted.size() == N);
+          for (int n = 0; n < N; ++n) CHECK(sorted[n] == n * K + key);
+          ++nexecuted;
+        },
+        ttg::edges(P2A), ttg::edges());
+    sum->set_input_reducer<0>([](double &a, const double &b) { a += b; }, N, mode);
+    CHECK(sum->get_input_reduce_mode<0>() == mode);
+    gather->set_input_reducer<0>(
+        [](std::vector<int> &a, const std::vector<int> &b) { a.insert(a.end(), b.begin(), b.end()); }, N);
+    // only arithmetic values can be reduced atomically
+    CHECK_THROWS(gather->set_input_reduce_mode<0>(ttg::ReduceMode::Atomic));
+    gather->set_input_reduce_mode<0>(mode == ttg::ReduceMode::Atomic ? ttg::ReduceMode::PerThread : mode);
+    make_graph_executable(producer);
+    if (world.rank() == 0) {
+      for (int key = 0; key < N * K; ++key) producer->invoke(key, key);
+    }
+    ttg::ttg_fence(world);
+    CHECK(world.allreduce(nexecuted.load()) == 2 * K);
+  }
+}
+
+TEST_CASE("TemplateTask stream auto finalize", "[core]") {
+  constexpr int N = 16;  // number of values reduced per key
+  constexpr int K = 4;   // number of keys
+  auto world = ttg::default_execution_context();
+
+  ttg::Edge<int, int> I2P;
+  ttg::Edge<int, int> P2S;
+  ttg::Edge<int, int> P2T, S2T;
+  std::atomic<int> nexecuted = 0;
+  int total_value = 0;
+
+  // neither the producers nor the reducers know how many values each stream receives
+  auto producer = ttg::make_tt(
+      [](const int &key, const int &value, std::tuple<ttg::Out<int, int>, ttg::Out<int, int>> &outs) {
+        ttg::send<0>(key % K, value, outs);
+        if (key % K == 0) ttg::send<1>(0, 1, outs);
+      },
+      ttg::edges(I2P), ttg::edges(P2S, P2T));
+  auto sum = ttg::make_tt(
+      [&nexecuted](const int &key, const int &value, std::tuple<ttg::Out<int, int>> &outs) {
+        CHECK(value == K * N * (N - 1) / 2 + N * key);
+        ++nexecuted;
+        ttg::send<0>(0, value, outs);
+      },
+      ttg::edges(P2S), ttg::edges(S2T));
+  // receives values from the producers and from sum, hence must be finalized after the tasks of sum ran
+  auto total = ttg::make_tt(
+      [&nexecuted, &total_value](const int &key, const int &value, std::tuple<> &outs) {
+        total_value = value;
+        ++nexecuted;
+      },
+      ttg::edges(ttg::fuse(P2T, S2T)), ttg::edges());
+  sum->set_input_reducer<0>([](int &a, const int &b) { a += b; });
+  sum->set_argstream_auto_finalize<0>();
+  total->set_input_reducer<0>([](int &a, const int &b) { a += b; });
+  total->set_argstream_auto_finalize<0>();
+  make_graph_executable(producer);
+  if (world.rank() == 0) {
+    for (int key = 0; key < N * K; ++key) producer->invoke(key, key);
+  }
+  ttg::ttg_fence(world);
+  CHECK(world.allreduce(nexecuted.load()) == K + 1);
+  CHECK(world.allreduce(total_value) == N * K * (N * K - 1) / 2 + N);
+}
+
+TEST_CASE("TemplateTask bound maps", "[core]") {
+  constexpr int N = 64;
+  auto world = ttg::default_execution_context();
+  ttg::Edge<int, int> I2C;
+  std::atomic<int> nexecuted = 0;
+
+  const auto rank = world.rank();
+  const auto nproc = world.size();
+  auto consumer = ttg::make_tt(
+      [&nexecuted, rank, nproc](const int &key, const int &value, std::tuple<> &outs) {
+        CHECK(value == key);
+        CHECK(rank == (key + 1) % nproc);
+        ++nexecuted;
+      },
+      ttg::edges(I2C), ttg::edges(), "consumer", {"value"}, {},
+      ttg::bind_maps([nproc](const int &key) { return (key + 1) % nproc; }, [](const int &key) { return key; }));
+  // the type-erased maps agree with the bound maps, but cannot replace them
+  for (int key = 0; key < N; ++key) {
+    CHECK(consumer->get_keymap()(key) == (key + 1) % nproc);
+    CHECK(consumer->get_priomap()(key) == key);
+  }
+  CHECK_THROWS(consumer->set_keymap([](const int &key) { return 0; }));
+  CHECK_THROWS(consumer->set_priomap([](const int &key) { return 0; }));
+  make_graph_executable(consumer);
+  if (world.rank() == 0) {
+    for (int key = 0; key < N; ++key) consumer->invoke(key, key);
+  }
+  ttg::ttg_fence(world);
+  CHECK(world.allreduce(nexecuted.load()) == N);
+}
+
+// squares its input, executing the ready tasks in batches
+namespace tt_batch {
+  inline std::atomic<int> nbatches = 0;
+  inline std::atomic<int> nmultiple = 0;  // the batches of more than one task
+  inline std::atomic<int> nkeys = 0;
+  inline std::atomic<std::size_t> max_batch_size = 0;
+
+  class tt : public ttg::TT<int, std::tuple<ttg::Out<int, int>>, tt, ttg::typelist<const int>> {
+    using baseT = typename tt::ttT;
+
+   public:
+    tt(const typename baseT::input_edges_type &inedges, const typename baseT::output_edges_type &outedges,
+       const std::string &name)
+        : baseT(inedges, outedges, name, {"x"}, {"x^2"}) {}
+
+    static constexpr const bool have_batch_op = true;
+
+    void op_batch(ttg::span<const int> keys, ttg::span<baseT::input_refs_tuple_type> inputs,
+                  baseT::output_terminals_type &outs) {
+      REQUIRE(keys.size() == inputs.size());
+      ++nbatches;
+      if (keys.size() > 1) ++nmultiple;
+      nkeys += static_cast<int>(keys.size());
+      auto size = max_batch_size.load();
+      while (size < keys.size() && !max_batch_size.compare_exchange_weak(size, keys.size())) {
+      }
+      for (std::size_t t = 0; t != keys.size(); ++t) {
+        const auto x = std::get<0>(inputs[t]);
+        CHECK(x == keys[t]);
+        ttg::send<0>(keys[t], x * x, outs);
+      }
+    }
+  };
+}  // namespace tt_batch
+
+TEST_CASE("TemplateTask batched op", "[core]") {
+  constexpr int N = 256;
+  constexpr std::size_t batch_size = 8;
+  auto world = ttg::default_execution_context();
+  ttg::Edge<int, int> I2P, P2B, B2C;
+  std::atomic<int> nexecuted = 0;
+
+  auto producer = ttg::make_tt([](const int &key, const int &value,
+                                  std::tuple<ttg::Out<int, int>> &outs) { ttg::send<0>(key, value, outs); },
+                               ttg::edges(I2P), ttg::edges(P2B));
+  auto square = std::make_unique<tt_batch::tt>(ttg::edges(P2B), ttg::edges(B2C), "square");
+  auto consumer = ttg::make_tt(
+      [&nexecuted](const int &key, const int &value, std::tuple<> &outs) {
+        CHECK(value == key * key);
+        ++nexecuted;
+      },
+      ttg::edges(B2C), ttg::edges());
+  CHECK(square->set_max_batch_size(batch_size) == 32);
+  CHECK(square->get_max_batch_size() == batch_size);
+  // the first tasks wait for the others to become ready
+  square->set_batch_linger(std::chrono::microseconds(10000));
+  make_graph_executable(producer);
+  if (world.rank() == 0) {
+    for (int key = 0; key < N; ++key) producer->invoke(key, key);
+  }
+  ttg::ttg_fence(world);
+  CHECK(world.allreduce(nexecuted.load()) == N);
+  CHECK(tt_batch::max_batch_size.load() <= batch_size);
+  CHECK(world.allreduce(tt_batch::nmultiple.load()) >= 1);
+  CHECK(world.allreduce(tt_batch::nkeys.load()) == N);
+}
+
+namespace tt_fused {
+  inline thread_local bool in_producer = false;
+}  // namespace tt_fused
+
+TEST_CASE("TemplateTask fused chain", "[core]") {
+  constexpr int N = 64;
+  auto world = ttg::default_execution_context();
+  ttg::Edge<int, int> I2P, P2S, S2C;
+  std::atomic<int> nexecuted = 0;
+  std::atomic<int> nfused = 0;
+
+  auto producer = ttg::make_tt(
+      [](const int &key, const int &value, std::tuple<ttg::Out<int, int>> &outs) {
+        tt_fused::in_producer = true;
+        ttg::send<0>(key, value + 1, outs);
+        tt_fused::in_producer = false;
+      },
+      ttg::edges(I2P), ttg::edges(P2S));
+  auto square = ttg::make_tt(
+      [&nfused](const int &key, int &value, std::tuple<ttg::Out<int, int>> &outs) {
+        if (tt_fused::in_producer) ++nfused;
+        value *= value;
+        ttg::send<0>(key, std::move(value), outs);
+      },
+      ttg::edges(P2S), ttg::edges(S2C));
+  auto consumer = ttg::make_tt(
+      [&nexecuted](const int &key, const int &value, std::tuple<> &outs) {
+        CHECK(value == (key + 1) * (key + 1));
+        ++nexecuted;
+      },
+      ttg::edges(S2C), ttg::edges());
+  // only single-input TTs can be fused
+  auto two_inputs = ttg::make_tt([](const int &key, const int &a, const int &b, std::tuple<> &outs) {},
+                                 ttg::edges(ttg::Edge<int, int>{}, ttg::Edge<int, int>{}), ttg::edges());
+  CHECK_THROWS(ttg::fuse_tts(two_inputs));
+  make_graph_executable(producer);
+  // producer -> square -> consumer is a linear chain
+  CHECK(!producer->is_fused());
+  CHECK(square->is_fused() == ttg::detail::auto_fuse());
+  CHECK(consumer->is_fused() == ttg::detail::auto_fuse());
+  ttg::fuse_linear_chains(producer);
+  CHECK(!producer->is_fused());
+  CHECK(square->is_fused());
+  CHECK(consumer->is_fused());
+  ttg::fuse_tts(square, consumer);  // no effect
+  if (world.rank() == 0) {
+    for (int key = 0; key < N; ++key) producer->invoke(key, key);
+  }
+  ttg::ttg_fence(world);
+  CHECK(world.allreduce(nexecuted.load()) == N);
+  // the tasks of square are executed by the producer tasks with the same key on the same process
+  CHECK(world.allreduce(nfused.load()) == N);
+}
+
+TEST_CASE("TemplateTask memory budgets", "[core]") {
+  constexpr int N = 256;
+  auto world = ttg::default_execution_context();
+  ttg::Edge<int, int> I2P;
+  ttg::Edge<int, std::vector<double>> P2C;
+  std::atomic<int> nexecuted = 0;
+
+  auto producer = ttg::make_tt(
+      [](const int &key, const int &n, std::tuple<ttg::Out<int, std::vector<double>>> &outs) {
+        for (int k = 0; k < n; ++k) ttg::send<0>(key * n + k, std::vector<double>(16, k), outs);
+      },
+      ttg::edges(I2P), ttg::edges(P2C));
+  auto consumer = ttg::make_tt(
+      [&nexecuted](const int &key, const std::vector<double> &value, std::tuple<> &outs) {
+        CHECK(value.size() == 16);
+        ++nexecuted;
+      },
+      ttg::edges(P2C), ttg::edges());
+  CHECK(consumer->get_max_pending_tasks() == 0);
+  CHECK(consumer->set_max_pending_tasks(4) == 0);
+  CHECK(consumer->get_max_pending_tasks() == 4);
+  consumer->set_max_data_bytes(1024);
+  const auto previous = world.get_max_pending_tasks();
+  world.set_max_pending_tasks(64);
+  CHECK(world.get_max_pending_tasks() == 64);
+  make_graph_executable(producer);
+  if (world.rank() == 0) {
+    for (int key = 0; key < 4; ++key) producer->invoke(key, N / 4);
+  }
+  ttg::ttg_fence(world);
+  CHECK(world.allreduce(nexecuted.load()) == N);
+  // the charges of the tasks are released once they complete
+  CHECK(consumer->get_memory_budget().pending_tasks() == 0);
+  CHECK(consumer->get_memory_budget().data_bytes() == 0);
+  CHECK(world.impl().budget().pending_tasks() == 0);
+  world.set_max_pending_tasks(previous);
+}
+
+TEST_CASE("TemplateTask completion", "[core]") {
+  constexpr int N = 64;
+  auto world = ttg::default_execution_context();
+  ttg::Edge<int, int> C2C, C2S;
+  std::atomic<int> nexecuted = 0, nsunk = 0;
+  // a chain of tasks, each sends its input to the next, and the last one to the sink
+  auto chain = ttg::make_tt(
+      [&nexecuted](const int &key, const int &value, std::tuple<ttg::Out<int, int>, ttg::Out<int, int>> &outs) {
+        ++nexecuted;
+        if (key + 1 < N)
+          ttg::send<0>(key + 1, value + 1, outs);
+        else
+          ttg::send<1>(key, value, outs);
+      },
+      ttg::edges(C2C), ttg::edges(C2C, C2S));
+  auto sink = ttg::make_tt([&nsunk](const int &key, const int &value, std::tuple<> &outs) { ++nsunk; },
+                           ttg::edges(C2S), ttg::edges());
+  make_graph_executable(chain);
+
+  // the handle on the sink observes the chain upstream of it, without knowing its number of tasks: it does not
+  // become ready while the chain runs and the sink has no task
+  auto completion = ttg::completion(*sink, world);
+  REQUIRE(completion.valid());
+  if (world.rank() == 0) chain->invoke(0, 0);
+  if (world.size() == 1) {
+    completion.wait();
+    CHECK(completion.completed() == N + 1);
+    CHECK(nexecuted == N);
+    CHECK(nsunk == 1);
+  }
+
+  // the split-phase fence lets this thread work while the world drains; with several processes the handle becomes
+  // ready once the fence detects the quiescence of the world
+  ttg::fence_begin(world);
+  CHECK_THROWS_AS(ttg::fence_begin(world), std::logic_error);
+  // no TT may be created until the fence completes
+  ttg::Edge<int, int> late;
+  CHECK_THROWS_AS(ttg::make_tt([](const int &key, const int &value, std::tuple<> &outs) {}, ttg::edges(late),
+                               ttg::edges()),
+                  std::logic_error);
+  completion.wait();
+  while (!ttg::fence_test(world)) std::this_thread::yield();
+  ttg::fence_wait(world);  // no-op, the fence is complete
+  CHECK(world.allreduce(nexecuted.load()) == N);
+  CHECK(world.allreduce(nsunk.load()) == 1);
+}
+
+TEST_CASE("TemplateTask counters", "[core]") {
+  constexpr int N = 64;
+  auto world = ttg::default_execution_context();
+  // a fused task is counted as created and executed, and its input as set locally
+  for (const bool fused : {true, false}) {
+    ttg::Edge<int, int> I2S, S2C;
+    auto square = ttg::make_tt(
+        [](const int &key, const int &value, std::tuple<ttg::Out<int, int>> &outs) {
+          ttg::send<0>(key, value * value, outs);
+        },
+        ttg::edges(I2S), ttg::edges(S2C), "counted square", {"value"}, {"square"});
+    auto consumer = ttg::make_tt([](const int &key, const int &value, std::tuple<> &outs) {}, ttg::edges(S2C),
+                                 ttg::edges(), "counted consumer", {"square"});
+    make_graph_executable(square);
+    consumer->set_fused(fused);
+    // the peak of the pending tasks is only tracked under a limit
+    square->set_max_pending_tasks(1 << 20);
+    consumer->set_max_pending_tasks(1 << 20);
+    if (world.rank() == 0) {
+      for (int key = 0; key < N; ++key) square->invoke(key, key);
+    }
+    ttg::ttg_fence(world);
+
+    // on this process every executed task of the consumer received its input from set_arg, and is fused if
+    // requested since the tasks of the square with the same key execute on this process
+    const auto local = consumer->get_counters();
+    CHECK(local.name == "counted consumer");
+    CHECK(local.tasks_executed == local.tasks_created);
+    CHECK(local.set_arg_local == local.tasks_created);
+    CHECK(local.tasks_inlined == (fused ? local.tasks_executed : 0));
+    CHECK(local.bytes_sent.size() == 1);
+
+    const auto all = world.counters(true);
+    for (const auto &name : {"counted square", "counted consumer"}) {
+      auto it = std::find_if(all.begin(), all.end(), [&name](const auto &c) { return c.name == name; });
+      REQUIRE(it != all.end());
+      CHECK(it->tasks_executed == N);
+      CHECK(it->tasks_created == N);
+      if (!fused || it->name != std::string("counted consumer")) CHECK(it->peak_pending_tasks >= 1);
+    }
+
+    std::ostringstream json;
+    ttg::write_counters(json, all);
+    CHECK(json.str().find("\"counted consumer\"") != std::string::npos);
+
+    consumer->reset_counters();
+    CHECK(consumer->get_counters().tasks_executed == 0);
+  }
+}
+
+namespace {
+  /// counts the events of the tasks of one TT
+  struct counting_observer : ttg::TaskObserver {
+    const ttg::TTBase *tt = nullptr;
+    std::atomic<int> created = 0, inputs = 0, ready = 0, started = 0, finished = 0;
+
+    void task_created(const ttg::TTBase &t, const ttg::TaskKey &) override { created += &t == tt; }
+    void input_arrived(const ttg::TTBase &t, const ttg::TaskKey &, std::size_t) override { inputs += &t == tt; }
+    void task_ready(const ttg::TTBase &t, const ttg::TaskKey &) override { ready += &t == tt; }
+    void task_started(const ttg::TTBase &t, const ttg::TaskKey &) override { started += &t == tt; }
+    void task_finished(const ttg::TTBase &t, const ttg::TaskKey &) override { finished += &t == tt; }
+  };
+}  // namespace
+
+TEST_CASE("TemplateTask observers", "[core]") {
+  constexpr int N = 64;
+  auto world = ttg::default_execution_context();
+  ttg::Edge<int, int> I2A, A2Bx, A2By;
+  auto a = ttg::make_tt(
+      [](const int &key, const int &value, std::tuple<ttg::Out<int, int>, ttg::Out<int, int>> &outs) {
+        ttg::send<0>(key, value, outs);
+        ttg::send<1>(key, value, outs);
+      },
+      ttg::edges(I2A), ttg::edges(A2Bx, A2By));
+  auto b = ttg::make_tt([](const int &key, const int &x, const int &y, std::tuple<> &outs) {},
+                        ttg::edges(A2Bx, A2By), ttg::edges());
+  make_graph_executable(a);
+
+  auto observer = std::make_shared<counting_observer>();
+  observer->tt = b.get();
+  const auto nobservers = ttg::task_observers().size();  // e.g. the default flight recorder
+  ttg::add_task_observer(observer);
+  ttg::add_task_observer(observer);  // no effect
+  CHECK(ttg::task_observers().size() == nobservers + 1);
+
+  if (world.rank() == 0) {
+    for (int key = 0; key < N; ++key) a->invoke(key, key);
+  }
+  ttg::ttg_fence(world);
+  ttg::remove_task_observer(observer);
+  CHECK(ttg::task_observers().size() == nobservers);
+  // the runtime releases the removed observer
+  CHECK(observer.use_count() == 1);
+
+  // every task of b on this process received two inputs and ran once
+  CHECK(observer->inputs == 2 * observer->created);
+  CHECK(observer->ready == observer->created);
+  CHECK(observer->started == observer->created);
+  CHECK(observer->finished == observer->created);
+  CHECK(world.allreduce(observer->finished.load()) == N);
+}
+
+TEST_CASE("TemplateTask timeline", "[core]") {
+  constexpr int N = 16;
+  auto world = ttg::default_execution_context();
+  ttg::Edge<int, int> I2A, A2B;
+  auto a = ttg::make_tt([](const int &key, const int &value,
+                           std::tuple<ttg::Out<int, int>> &outs) { ttg::send<0>(key, value, outs); },
+                        ttg::edges(I2A), ttg::edges(A2B), "timeline_a");
+  auto b = ttg::make_tt([](const int &key, const int &value, std::tuple<> &outs) {}, ttg::edges(A2B), ttg::edges(),
+                        "timeline_b");
+  make_graph_executable(a);
+
+  auto timeline = std::make_shared<ttg::Timeline>(world.rank());
+  ttg::add_task_observer(timeline);
+  if (world.rank() == 0) {
+    for (int key = 0; key < N; ++key) a->invoke(key, key);
+  }
+  ttg::ttg_fence(world);
+  ttg::remove_task_observer(timeline);
+
+  // a begin and an end event per task executed on this process, and an event per message
+  CHECK(timeline->dropped() == 0);
+  CHECK(timeline->size() >= 2 * (a->get_counters().tasks_executed + b->get_counters().tasks_executed));
+
+  std::ostringstream json;
+  timeline->write(json);
+  if (b->get_counters().tasks_executed > 0) {
+    CHECK(json.str().find("\"ph\": \"B\", \"cat\": \"task\", \"name\": \"timeline_b\"") != std::string::npos);
+    CHECK(json.str().find("\"ph\": \"E\"") != std::string::npos);
+  }
+  CHECK(json.str().rfind("\n]}\n") == json.str().size() - 4);
+
+  std::ostringstream perfetto;
+  timeline->write(perfetto, ttg::TimelineFormat::Perfetto);
+  CHECK(!perfetto.str().empty());
+  CHECK(perfetto.str().front() == '\x0a');  // Trace.packet, length delimited
+
+  // the events beyond the capacity of a thread are dropped and reported, except the ends of the recorded tasks
+  ttg::Timeline capped(world.rank(), 1024, 3);
+  const int key = 1;
+  const ttg::TaskKey task_key(key);
+  capped.task_started(*a, task_key);
+  capped.message_sent(*a, task_key, 0, 1, 8, ttg::detail::next_message_id(world.rank()));
+  capped.task_started(*a, task_key);
+  capped.task_started(*a, task_key);  // dropped, and so is its end
+  for (int k = 0; k < 3; ++k) capped.task_finished(*a, task_key);
+  CHECK(capped.size() == 5);
+  CHECK(capped.dropped() == 2);
+  std::ostringstream capped_json;
+  capped.write(capped_json);
+  CHECK(capped_json.str().find("\"dropped_events\": 2") != std::string::npos);
+
+  CHECK(ttg::detail::timeline_file_name("trace.json", 1, 1) == "trace.json");
+  CHECK(ttg::detail::timeline_file_name("dir.d/trace.json", 1, 2) == "dir.d/trace.1.json");
+  CHECK(ttg::detail::timeline_file_name("dir.d/trace", 1, 2) == "dir.d/trace.1");
+}
+
+TEST_CASE("TemplateTask flight recorder", "[core]") {
+  constexpr int N = 16;
+  auto world = ttg::default_execution_context();
+  ttg::Edge<int, int> I2A;
+  auto a = ttg::make_tt([](const int &key, const int &value, std::tuple<> &outs) {}, ttg::edges(I2A), ttg::edges(),
+                        "flight_a");
+  make_graph_executable(a);
+
+  // keeps the last 8 events per thread
+  auto recorder = std::make_shared<ttg::FlightRecorder>(world.rank(), "ttg_flight_test", 8);
+  ttg::add_task_observer(recorder);
+  if (world.rank() == 0) {
+    for (int key = 0; key < N; ++key) a->invoke(key, key);
+  }
+  ttg::ttg_fence(world);
+  ttg::remove_task_observer(recorder);
+  CHECK(recorder->num_events() > 0);
+
+  const std::string path = "ttg_flight_test." + std::to_string(world.rank()) + ".0.ttgfr";
+  REQUIRE(recorder->dump("test"));
+  std::ifstream is(path, std::ios::binary);
+  auto record = ttg::FlightRecord::read(is);
+  std::remove(path.c_str());
+  CHECK(record.rank == world.rank());
+  CHECK(record.reason == "test");
+  std::size_t nevents = 0, nfences = 0;
+  for (const auto &[thread, events] : record.threads) {
+    CHECK(events.size() <= 8);
+    nevents += events.size();
+    for (const auto &e : events) nfences += e.kind == ttg::FlightEvent::fence_finished;
+  }
+  CHECK(nevents <= recorder->num_events());
+  CHECK(nfences == 1);
+  if (a->get_counters().tasks_executed > 0) {
+    CHECK(std::find_if(record.names.begin(), record.names.end(),
+                       [](const auto &name) { return name.second == "flight_a"; }) != record.names.end());
+  }
+
+  std::ostringstream oss;
+  record.print(oss);
+  CHECK(oss.str().find("fence_finished") != std::string::npos);
+
+  std::istringstream not_a_dump("not a dump");
+  CHECK_THROWS_AS(ttg::FlightRecord::read(not_a_dump), std::runtime_error);
+}
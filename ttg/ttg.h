@@ -17,6 +17,7 @@
 #include "ttg/base/world.h"
 #include "ttg/broadcast.h"
 #include "ttg/func.h"
+#include "ttg/keymaps.h"
 #include "ttg/reduce.h"
 #include "ttg/traverse.h"
 #include "ttg/tt.h"
@@ -34,6 +35,7 @@
 #endif  // TTG_USE_PARSEC|MADNESS
 
 // these headers use the default backend
+#include "ttg/collectives.h"
 #include "ttg/run.h"
 
 #endif  // TTG_H_INCLUDED
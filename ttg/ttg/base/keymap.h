@@ -2,6 +2,7 @@
 #define TTG_BASE_KEYMAP_H
 
 #include <type_traits>
+#include <utility>
 #include "ttg/util/meta.h"
 #include "ttg/util/hash.h"
 
@@ -50,8 +51,51 @@ namespace ttg {
       operator()() const { return 0; }
     };
 
+    /// the priomap of ttg::bind_maps() that assigns the default priority, 0, to all tasks
+    struct zero_priomap {
+      template <typename... Key>
+      int operator()(const Key &...) const { return 0; }
+    };
+
+    /// the maps of a TT made by make_tt whose keymap and priomap are type-erased
+    struct unbound_maps {};
+
+    template <typename T>
+    using have_bound_maps_non_type_t = decltype(T::have_bound_maps);
+
+    /// @return true if @p derivedT::have_bound_maps exists and is defined to true, i.e. the keymap and priomap of the TT
+    ///         are evaluated by calling @c derivedT::keymap_impl(key) and @c derivedT::priomap_impl(key) instead of the
+    ///         type-erased maps held by the TT
+    template <typename derivedT>
+    constexpr bool derived_has_bound_maps() {
+      if constexpr (meta::is_detected_v<have_bound_maps_non_type_t, derivedT>) {
+        return derivedT::have_bound_maps;
+      } else {
+        return false;
+      }
+    }
+
   }  // namespace detail
 
+  /// A keymap and a priomap bound by their concrete types to a TT made by make_tt, see bind_maps()
+  template <typename Keymap, typename Priomap>
+  struct BoundMaps {
+    Keymap keymap;
+    Priomap priomap;
+  };
+
+  /// Binds a keymap and a priomap by their concrete types to a TT made by make_tt: the TT then calls them directly,
+  /// so that they can be inlined, instead of through the type-erased maps (std::function) used by default.
+  /// The maps of such a TT cannot be changed by set_keymap() or set_priomap().
+  /// @param keymap maps a key to the rank of the process that executes the task
+  /// @param priomap maps a key to the priority of the task; by default all tasks have priority 0
+  /// @return the maps, to be passed as the last argument of make_tt
+  template <typename Keymap, typename Priomap = detail::zero_priomap>
+  auto bind_maps(Keymap &&keymap, Priomap &&priomap = Priomap{}) {
+    return BoundMaps<std::decay_t<Keymap>, std::decay_t<Priomap>>{std::forward<Keymap>(keymap),
+                                                                  std::forward<Priomap>(priomap)};
+  }
+
 } // namespace ttg
 
 #endif // TTG_BASE_KEYMAP_H
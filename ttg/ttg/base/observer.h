@@ -0,0 +1,359 @@
+#ifndef TTG_BASE_OBSERVER_H
+#define TTG_BASE_OBSERVER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ttg/util/hash.h"
+#include "ttg/util/meta.h"
+#include "ttg/util/thread_index.h"
+#include "ttg/util/void.h"
+
+namespace ttg {
+
+  // forward decl
+  class TTBase;
+
+  namespace detail {
+    template <typename T, typename Enabler = void>
+    struct is_printable : std::false_type {};
+
+    template <typename T>
+    struct is_printable<T, meta::void_t<decltype(std::declval<std::ostream &>() << std::declval<const T &>())>>
+        : std::true_type {};
+  }  // namespace detail
+
+  /// The key of a task in the events of the task observers. Refers to the key, hence must not outlive it.
+  class TaskKey {
+   public:
+    /// the key of the tasks of the TTs with void keys
+    TaskKey() : hash_value(ttg::hash<void>{}()) {}
+    explicit TaskKey(const ttg::Void &) : TaskKey() {}
+    template <typename Key>
+    explicit TaskKey(const Key &key)
+        : key(&key), hash_value(ttg::hash<Key>{}(key)), printer(&print_key<Key>), copy_size(copy_size_of<Key>()) {}
+
+    /// A copy of a small trivially copyable key, which outlives the key and is printed on demand, e.g. to record
+    /// the key cheaply and print it later
+    class Copy {
+     public:
+      /// the largest key that can be copied
+      static constexpr std::size_t max_size = 16;
+
+      /// @return true if a key was copied
+      bool valid() const { return nullptr != printer; }
+
+      /// prints the copied key, see TaskKey::print()
+      void print(std::ostream &os) const {
+        if (printer) printer(os, bytes);
+      }
+
+     private:
+      friend class TaskKey;
+      alignas(std::uint64_t) unsigned char bytes[max_size];
+      void (*printer)(std::ostream &, const void *) = nullptr;
+    };
+
+    /// @return the hash of the key, see ttg::hash
+    std::uint64_t hash() const { return hash_value; }
+
+    /// prints the key, or its hash if the key type has no operator<<
+    void print(std::ostream &os) const {
+      if (printer) printer(os, key);
+    }
+
+    /// @return the printed key, see print()
+    std::string str() const {
+      std::ostringstream oss;
+      print(oss);
+      return oss.str();
+    }
+
+    /// @return a copy of the key, invalid unless the key type is trivially copyable and at most Copy::max_size bytes
+    Copy copy() const {
+      Copy result;
+      if (copy_size != 0) {
+        std::memcpy(result.bytes, key, copy_size);
+        result.printer = printer;
+      }
+      return result;
+    }
+
+   private:
+    template <typename Key>
+    static constexpr std::uint8_t copy_size_of() {
+      if constexpr (std::is_trivially_copyable_v<Key> && sizeof(Key) <= Copy::max_size &&
+                    alignof(Key) <= alignof(std::uint64_t))
+        return sizeof(Key);
+      else
+        return 0;
+    }
+
+    template <typename Key>
+    static void print_key(std::ostream &os, const void *key) {
+      if constexpr (detail::is_printable<Key>::value)
+        os << *static_cast<const Key *>(key);
+      else
+        os << '#' << ttg::hash<Key>{}(*static_cast<const Key *>(key));
+    }
+
+    const void *key = nullptr;
+    std::uint64_t hash_value;
+    void (*printer)(std::ostream &, const void *) = nullptr;
+    std::uint8_t copy_size = 0;  //!< the size of the key if it can be copied, see copy()
+  };
+
+  /// Receives the lifecycle events of the tasks of all TTs on this process, see add_task_observer(). A task is
+  /// identified by its TT and its key. The callbacks are invoked by the threads that cause the events, concurrently,
+  /// and must be thread safe and cheap; the default implementations do nothing. The tasks executed by a thread nest:
+  /// task_finished() is called for the task started last and not finished yet, e.g. the tasks of a batch (see
+  /// TTBase::set_max_batch_size) finish in the reverse order of their starts.
+  class TaskObserver {
+   public:
+    virtual ~TaskObserver() = default;
+
+    /// the task was created, i.e. received its first input or was invoked
+    virtual void task_created(const TTBase &tt, const TaskKey &key) {}
+    /// input terminal @p input of the task received a value (or, for a streaming input, one of its values)
+    virtual void input_arrived(const TTBase &tt, const TaskKey &key, std::size_t input) {}
+    /// the task received all its inputs and is handed to the scheduler, or executed inline
+    virtual void task_ready(const TTBase &tt, const TaskKey &key) {}
+    /// the calling thread starts executing the task
+    virtual void task_started(const TTBase &tt, const TaskKey &key) {}
+    /// the calling thread finished executing the task
+    virtual void task_finished(const TTBase &tt, const TaskKey &key) {}
+    /// a message of @p bytes bytes carrying a value for input terminal @p input of the task of @p tt with key @p key
+    /// (the first of the tasks, if the value is broadcast) was sent to process @p rank; @p message identifies the
+    /// message in all processes, see ttg::detail::next_message_id()
+    virtual void message_sent(const TTBase &tt, const TaskKey &key, std::size_t input, int rank, std::size_t bytes,
+                              std::uint64_t message) {}
+    /// a message of @p bytes bytes carrying a value for input terminal @p input of the task of @p tt with key @p key
+    /// (the first of the tasks, if the value is broadcast) was received; @p message is the id given to message_sent()
+    virtual void message_received(const TTBase &tt, const TaskKey &key, std::size_t input, std::size_t bytes,
+                                  std::uint64_t message) {}
+    /// the calling thread starts waiting for all tasks of a world to complete, e.g. by ttg::fence()
+    virtual void fence_started() {}
+    /// the calling thread finished waiting for all tasks of a world to complete
+    virtual void fence_finished() {}
+  };
+
+  namespace detail {
+
+    using task_observer_list = std::vector<std::shared_ptr<TaskObserver>>;
+
+    /// the observers notified by the backends, nullptr if none; replaced, never modified, by add_task_observer() and
+    /// remove_task_observer()
+    inline std::atomic<const task_observer_list *> active_task_observers = nullptr;
+
+    /// The readers of the lists of observers, per slot of threads (see this_thread_index()). The readers of a slot
+    /// are counted per generation, and the generation of the slot is read and counted in one atomic operation: the
+    /// notifications read the list of their generation, see task_observer_lists. A list that was replaced is freed
+    /// once the generation of each slot was flipped, so that new readers use the next list, and the readers of the
+    /// previous generation left; unlike a single count of readers this does not starve the thread freeing the list.
+    struct alignas(64) task_observer_readers {
+      static constexpr std::size_t num_slots = 64;
+      static constexpr std::uint64_t generation_bit = std::uint64_t(1) << 63;
+
+      /// the generation bit, then the counts of the readers of generations 1 and 0, in 31 and 32 bits
+      std::atomic<std::uint64_t> state = 0;
+
+      /// @return the increment of the count of the readers of generation @p g
+      static constexpr std::uint64_t reader(std::size_t g) { return g ? (std::uint64_t(1) << 32) : 1; }
+
+      /// @return the number of readers of generation @p g in @p state
+      static constexpr std::uint64_t readers(std::uint64_t state, std::size_t g) {
+        return g ? (state & ~generation_bit) >> 32 : state & 0xffffffff;
+      }
+
+      /// counts a reader, a relaxed read and an acquire CAS on the slot of the calling thread
+      /// @return the generation of the reader
+      std::size_t enter() {
+        auto value = state.load(std::memory_order_relaxed);
+        while (!state.compare_exchange_weak(value, value + reader((value & generation_bit) != 0),
+                                            std::memory_order_acquire, std::memory_order_relaxed)) {
+        }
+        return (value & generation_bit) != 0;
+      }
+
+      /// uncounts a reader of generation @p g
+      void leave(std::size_t g) { state.fetch_sub(reader(g), std::memory_order_release); }
+    };
+    inline task_observer_readers task_observer_reader_slots[task_observer_readers::num_slots];
+
+    /// the lists of observers read by the notifications of generation 0 and 1, see task_observer_readers
+    inline std::atomic<const task_observer_list *> task_observer_lists[2] = {nullptr, nullptr};
+
+    /// @return a new id of a message sent by process @p rank, unique in all processes unless this thread sent 2^32
+    ///         messages: the rank, the index of the calling thread (see this_thread_index()) and the number of
+    ///         messages it sent, in 20, 12 and 32 bits; carried by the message, see TaskObserver::message_sent()
+    inline std::uint64_t next_message_id(int rank) {
+      static thread_local std::uint32_t nsent = 0;
+      const auto thread = static_cast<std::uint64_t>(this_thread_index() & 0xfff);
+      return (static_cast<std::uint64_t>(rank) << 44) | (thread << 32) | nsent++;
+    }
+
+    /// the number of notifications in progress on this thread, e.g. if an observer adds or removes observers
+    inline thread_local std::size_t task_observer_notify_depth = 0;
+
+    /// the lists of observers, the active one and those replaced while their last readers were notifying them
+    struct task_observer_registry {
+      using list_ptr = std::unique_ptr<const task_observer_list>;
+
+      std::mutex mtx;
+      list_ptr current;
+      std::vector<list_ptr> retired;
+      std::size_t generation = 0;  //!< the generation of the readers of current
+
+      static task_observer_registry &instance() {
+        static task_observer_registry registry;
+        return registry;
+      }
+
+      /// the lists replaced by activate(), read by the readers of a generation
+      struct replaced_lists {
+        std::vector<list_ptr> lists;
+        std::size_t generation = 0;
+      };
+
+      /// makes @p observers the active list, to be called with mtx locked
+      /// @return the lists replaced so far, to be freed by free_when_unused() once mtx is unlocked; none if called
+      ///         while notifying observers, since the calling thread may be reading one of them
+      replaced_lists activate(task_observer_list observers) {
+        list_ptr next;
+        if (!observers.empty()) next = std::make_unique<const task_observer_list>(std::move(observers));
+        if (current) retired.push_back(std::move(current));
+        current = std::move(next);
+        if (task_observer_notify_depth > 0) {
+          // the calling thread is a reader of this generation, which cannot be flipped: replace its list, and free
+          // the replaced lists after a later flip
+          task_observer_lists[generation].store(current.get(), std::memory_order_release);
+          active_task_observers.store(current.get(), std::memory_order_release);
+          return {};
+        }
+        // the readers of the previous generation are drained by free_when_unused(), those of the next one use
+        // the next list; the flips release the store of the next list
+        replaced_lists result{std::move(retired), generation};
+        retired.clear();
+        generation = 1 - generation;
+        task_observer_lists[generation].store(current.get(), std::memory_order_relaxed);
+        for (auto &slot : task_observer_reader_slots)
+          slot.state.fetch_xor(task_observer_readers::generation_bit, std::memory_order_acq_rel);
+        active_task_observers.store(current.get(), std::memory_order_release);
+        return result;
+      }
+
+      /// frees @p replaced, which are no longer active, once no thread can be reading them; waits, with an
+      /// exponential backoff, until the readers of their generation left, while the readers that enter later use the
+      /// next generation
+      static void free_when_unused(replaced_lists replaced) {
+        if (replaced.lists.empty()) return;
+        constexpr std::chrono::microseconds max_backoff{1000};
+        for (auto &slot : task_observer_reader_slots) {
+          auto backoff = std::chrono::microseconds(1);
+          while (task_observer_readers::readers(slot.state.load(std::memory_order_seq_cst), replaced.generation) !=
+                 0) {
+            std::this_thread::sleep_for(backoff);
+            backoff = std::min(backoff * 2, max_backoff);
+          }
+        }
+      }
+
+      /// @return a copy of the active list
+      task_observer_list active() const {
+        const auto *observers = active_task_observers.load(std::memory_order_acquire);
+        return observers ? *observers : task_observer_list{};
+      }
+    };
+
+    /// invokes @p event with the active list of observers, if any
+    template <typename Event>
+    inline void read_task_observers(Event &&event) {
+      if (nullptr == active_task_observers.load(std::memory_order_acquire)) return;
+      struct reader {
+        task_observer_readers &slot =
+            task_observer_reader_slots[this_thread_index() % task_observer_readers::num_slots];
+        const std::size_t generation = slot.enter();
+        reader() { ++task_observer_notify_depth; }
+        ~reader() {
+          --task_observer_notify_depth;
+          slot.leave(generation);
+        }
+      } guard;
+      const auto *observers = task_observer_lists[guard.generation].load(std::memory_order_acquire);
+      if (nullptr == observers) return;
+      event(*observers);
+    }
+
+    /// invokes @p event with each active observer; only an atomic load and a branch if there are none
+    template <typename Event>
+    inline void notify_task_observers(Event &&event) {
+      read_task_observers([&event](const task_observer_list &observers) {
+        for (const auto &observer : observers) event(*observer);
+      });
+    }
+
+    /// invokes @p event with each active observer and the TaskKey of @p key, built once for all observers; only an
+    /// atomic load and a branch if there are none
+    template <typename Key, typename Event>
+    inline void notify_task_observers(const Key &key, Event &&event) {
+      read_task_observers([&key, &event](const task_observer_list &observers) {
+        const TaskKey task_key(key);
+        for (const auto &observer : observers) event(*observer, task_key);
+      });
+    }
+
+  }  // namespace detail
+
+  /// Installs @p observer, which will receive the events of the tasks of all TTs on this process; thread safe.
+  /// Installing an observer twice has no effect.
+  inline void add_task_observer(std::shared_ptr<TaskObserver> observer) {
+    auto &registry = detail::task_observer_registry::instance();
+    detail::task_observer_registry::replaced_lists replaced;
+    {
+      std::lock_guard<std::mutex> lock(registry.mtx);
+      auto observers = registry.active();
+      if (std::find(observers.begin(), observers.end(), observer) != observers.end()) return;
+      observers.push_back(std::move(observer));
+      replaced = registry.activate(std::move(observers));
+    }
+    detail::task_observer_registry::free_when_unused(std::move(replaced));
+  }
+
+  /// Uninstalls @p observer; thread safe. Returns once no other thread can be notifying @p observer, after which it
+  /// is no longer referenced by the runtime; if called by an observer, while an event is notified, @p observer is
+  /// released by a later call to add_task_observer() or remove_task_observer().
+  inline void remove_task_observer(const std::shared_ptr<TaskObserver> &observer) {
+    auto &registry = detail::task_observer_registry::instance();
+    detail::task_observer_registry::replaced_lists replaced;
+    {
+      std::lock_guard<std::mutex> lock(registry.mtx);
+      auto observers = registry.active();
+      observers.erase(std::remove(observers.begin(), observers.end(), observer), observers.end());
+      replaced = registry.activate(std::move(observers));
+    }
+    detail::task_observer_registry::free_when_unused(std::move(replaced));
+  }
+
+  /// @return the installed observers
+  inline std::vector<std::shared_ptr<TaskObserver>> task_observers() {
+    auto &registry = detail::task_observer_registry::instance();
+    std::lock_guard<std::mutex> lock(registry.mtx);
+    return registry.active();
+  }
+
+}  // namespace ttg
+
+#endif  // TTG_BASE_OBSERVER_H
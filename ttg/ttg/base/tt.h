@@ -1,15 +1,24 @@
 #ifndef TTG_BASE_OP_H
 #define TTG_BASE_OP_H
 
+#include <cassert>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <iostream>
+#include <memory>
 #include <optional>
 #include <sstream>
 #include <string>
 #include <vector>
 
+#include "ttg/base/observer.h"
 #include "ttg/base/terminal.h"
+#include "ttg/execution.h"
 #include "ttg/util/demangle.h"
+#include "ttg/util/counters.h"
+#include "ttg/util/env.h"
+#include "ttg/util/memory_budget.h"
 
 namespace ttg {
 
@@ -42,6 +51,14 @@ namespace ttg {
     bool executable = false;  //!< ready to execute?
     bool is_ttg_ = false;
     bool lazy_pull_instance = false;
+    std::optional<ttg::Execution> execution_policy;  //!< if not set the backend's default policy is used
+    int max_inline_depth = ttg::detail::max_inline_depth();  //!< max number of tasks nested on a thread by inlining
+    std::size_t max_batch_size = 32;  //!< max number of tasks executed by one call to op_batch
+    std::chrono::microseconds batch_linger{0};  //!< how long a batch waits to fill before it is executed
+    bool fused = false;  //!< if true the tasks are executed within the tasks that send their input, see set_fused
+    std::unique_ptr<detail::memory_budget> budget =
+        std::make_unique<detail::memory_budget>();  //!< the budget of the pending tasks, see set_max_pending_tasks
+    std::unique_ptr<detail::tt_counter_slots> counter_slots;  //!< the runtime counters, see get_counters
 
     // Default copy/move/assign all OK
     static uint64_t next_instance_id() {
@@ -117,7 +134,14 @@ namespace ttg {
         , is_ttg_(std::move(other.is_ttg_))
         , name(std::move(other.name))
         , inputs(std::move(other.inputs))
-        , outputs(std::move(other.outputs)) {
+        , outputs(std::move(other.outputs))
+        , execution_policy(other.execution_policy)
+        , max_inline_depth(other.max_inline_depth)
+        , max_batch_size(other.max_batch_size)
+        , batch_linger(other.batch_linger)
+        , fused(other.fused)
+        , budget(std::move(other.budget))
+        , counter_slots(std::move(other.counter_slots)) {
       other.instance_id = -1;
     }
     TTBase &operator=(TTBase &&other) {
@@ -126,18 +150,37 @@ namespace ttg {
       name = std::move(other.name);
       inputs = std::move(other.inputs);
       outputs = std::move(other.outputs);
+      execution_policy = other.execution_policy;
+      max_inline_depth = other.max_inline_depth;
+      max_batch_size = other.max_batch_size;
+      batch_linger = other.batch_linger;
+      fused = other.fused;
+      budget = std::move(other.budget);
+      counter_slots = std::move(other.counter_slots);
       other.instance_id = -1;
       return *this;
     }
 
     TTBase(const std::string &name, size_t numins, size_t numouts)
-        : instance_id(next_instance_id()), is_ttg_(false), name(name), inputs(numins), outputs(numouts) {}
+        : instance_id(next_instance_id())
+        , is_ttg_(false)
+        , name(name)
+        , inputs(numins)
+        , outputs(numouts)
+        , counter_slots(std::make_unique<detail::tt_counter_slots>(numins)) {}
 
     static const std::vector<TerminalBase *> *&outputs_tls_ptr_accessor() {
       static thread_local const std::vector<TerminalBase *> *outputs_tls_ptr = nullptr;
       return outputs_tls_ptr;
     }
     void set_outputs_tls_ptr() { outputs_tls_ptr_accessor() = &this->outputs; }
+
+    /// @return the budget of the pending tasks of this TT, charged by the backends
+    detail::memory_budget &memory_budget() { return *budget; }
+
+    /// @return the runtime counters of this TT, updated by the backends
+    detail::tt_counter_slots &counters() { return *counter_slots; }
+
     void set_outputs_tls_ptr(const std::vector<TerminalBase *> *ptr) { outputs_tls_ptr_accessor() = ptr; }
 
    public:
@@ -146,6 +189,8 @@ namespace ttg {
     /// Use this to create a task that takes no data "manually"
     /// @warning calls std::abort() if the derived class TT did not override this;
     ///          only makes sense to override this if the derived TT uses void for key or data
+    /// @note like every injection of tasks, must not be called while a split-phase fence started by
+    ///       ttg::fence_begin() is in progress in the world of this TT
     virtual void invoke() {
       std::cerr << "TTBase::invoke() invoked on a TT that did not override it" << std::endl;
       abort();
@@ -198,6 +243,118 @@ namespace ttg {
 
     bool is_lazy_pull() { return ttg::detail::op_base_lazy_pull_accessor() || lazy_pull_instance; }
 
+    /// Sets the execution policy for the tasks of this TT that are made ready by a thread executing another task,
+    /// and returns the previous setting.
+    /// - ttg::Execution::Inline : the task is executed immediately on the calling thread (work-first), while its inputs
+    ///   are still hot in cache, unless the number of tasks nested on that thread reaches get_max_inline_depth()
+    /// - ttg::Execution::Async : the task is always handed to the scheduler
+    /// - not set (the default) : the backend's default policy is used; the MADNESS backend executes inline only
+    ///   if the key hash matches that of the calling task ("inline if cheap"), the PaRSEC backend behaves as Async
+    std::optional<ttg::Execution> set_execution_policy(std::optional<ttg::Execution> policy) {
+      std::swap(execution_policy, policy);
+      return policy;
+    }
+
+    /// @return the execution policy of this TT; if not set the backend's default policy is used
+    const std::optional<ttg::Execution> &get_execution_policy() const { return execution_policy; }
+
+    /// Sets the maximum number of tasks that can be nested on a thread by inline execution of the tasks of this TT,
+    /// and returns the previous setting. The default is given by ttg::detail::max_inline_depth().
+    int set_max_inline_depth(int depth) {
+      assert(depth >= 0);
+      std::swap(max_inline_depth, depth);
+      return depth;
+    }
+
+    /// @return the maximum number of tasks that can be nested on a thread by inline execution of the tasks of this TT
+    int get_max_inline_depth() const { return max_inline_depth; }
+
+    /// Sets the maximum number of ready tasks executed by one call to @c op_batch, and returns the previous setting.
+    /// Only used by the TTs whose class defines @c have_batch_op to true; their ready tasks are not executed one by one
+    /// by @c op but in batches, by @c op_batch, which receives the keys and the inputs of all tasks in the batch.
+    /// The default is 32.
+    std::size_t set_max_batch_size(std::size_t size) {
+      assert(size > 0);
+      std::swap(max_batch_size, size);
+      return size;
+    }
+
+    /// @return the maximum number of ready tasks executed by one call to @c op_batch
+    std::size_t get_max_batch_size() const { return max_batch_size; }
+
+    /// Sets how long a batch of ready tasks (see set_max_batch_size) that is not full waits for more tasks to become
+    /// ready before it is executed, and returns the previous setting. The wait occupies the thread that executes the
+    /// batch. The default is 0, i.e. a batch holds the tasks that became ready before the scheduler executes it.
+    std::chrono::microseconds set_batch_linger(std::chrono::microseconds linger) {
+      assert(linger.count() >= 0);
+      std::swap(batch_linger, linger);
+      return linger;
+    }
+
+    /// @return how long a batch of ready tasks that is not full waits for more tasks to become ready
+    std::chrono::microseconds get_batch_linger() const { return batch_linger; }
+
+    /// Fuses the tasks of this TT into the tasks that send their input, and returns the previous setting.
+    /// A task of a fused TT is not created nor scheduled when its input is sent, with its own key, by a task executing
+    /// on the process that owns it: its op is called immediately by the sending task, with a reference to the sent value
+    /// (copied only if the input is not read-only and the value was not sent as an rvalue), unless the number of tasks
+    /// nested on the thread reaches get_max_inline_depth(). Only TTs with a single input that is neither streaming nor
+    /// pulled are fused, the others ignore this setting. See ttg::fuse_tts() and ttg::make_graph_executable().
+    bool set_fused(bool value) {
+      std::swap(fused, value);
+      return value;
+    }
+
+    /// @return true if the tasks of this TT are fused into the tasks that send their input, see set_fused()
+    bool is_fused() const { return fused; }
+
+    /// Limits the number of pending tasks of this TT, i.e. created but not completed, and returns the previous limit;
+    /// 0, the default, means unlimited. While the limit is reached the tasks that send inputs to this TT, and
+    /// ttg::invoke(), are deferred until the pending tasks drain. The limit is soft: it is exceeded by the tasks
+    /// created by messages from other processes, and when no task completes for a while (see
+    /// ttg::detail::budget_stall_timeout()). See also ttg::base::World::set_max_pending_tasks.
+    std::size_t set_max_pending_tasks(std::size_t n) {
+      const auto previous = budget->get_max_pending_tasks();
+      budget->set_max_pending_tasks(n);
+      return previous;
+    }
+
+    /// @return the maximum number of pending tasks of this TT, 0 if unlimited
+    std::size_t get_max_pending_tasks() const { return budget->get_max_pending_tasks(); }
+
+    /// Limits the number of bytes of the inputs held by the pending tasks of this TT, as estimated by
+    /// ttg::footprint(), and returns the previous limit; 0, the default, means unlimited. Enforced like
+    /// set_max_pending_tasks().
+    std::size_t set_max_data_bytes(std::size_t n) {
+      const auto previous = budget->get_max_data_bytes();
+      budget->set_max_data_bytes(n);
+      return previous;
+    }
+
+    /// @return the maximum number of bytes of the inputs held by the pending tasks of this TT, 0 if unlimited
+    std::size_t get_max_data_bytes() const { return budget->get_max_data_bytes(); }
+
+    /// @return the limits and the current usage of the pending tasks of this TT
+    const detail::memory_budget &get_memory_budget() const { return *budget; }
+
+    /// appends to @p counters the runtime counters of this TT or, if this is a TTG, those of its TTs; see
+    /// ttg::Completion
+    virtual void get_counter_slots(std::vector<const detail::tt_counter_slots *> &counters) const {
+      counters.push_back(counter_slots.get());
+    }
+
+    /// @return the runtime counters of this TT on this process; always collected, at the cost of a relaxed atomic
+    ///         increment per event. See also ttg::World::counters() and ttg::write_counters().
+    TTCounters get_counters() const {
+      auto result = counter_slots->snapshot();
+      result.name = get_name();
+      result.peak_pending_tasks = budget->peak_pending_tasks();
+      return result;
+    }
+
+    /// zeroes the runtime counters of this TT on this process, except the peak number of pending tasks
+    void reset_counters() { counter_slots->reset(); }
+
     std::optional<std::reference_wrapper<const TTBase>> ttg() const {
       return owning_ttg ? std::cref(*owning_ttg) : std::optional<std::reference_wrapper<const TTBase>>{};
     }
@@ -1,14 +1,25 @@
 #ifndef TTG_BASE_WORLD_H
 #define TTG_BASE_WORLD_H
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <functional>
 #include <future>
 #include <iostream>
 #include <list>
+#include <map>
 #include <memory>
 #include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 #include "ttg/base/tt.h"
+#include "ttg/util/completion.h"
+#include "ttg/util/memory_budget.h"
 
 namespace ttg {
 
@@ -38,6 +49,13 @@ namespace ttg {
       }
 
       std::list<ttg::TTBase*> m_op_register;
+      /// a TT with streaming inputs that are finalized once no more values can arrive, see register_stream_finalizer
+      struct stream_finalizer {
+        ttg::TTBase* op;
+        std::function<bool()> pending;  // true if a task of op on this process awaits the finalization of a stream
+        std::function<void()> finalize;  // finalizes the awaited streams of the tasks of op on this process
+      };
+      std::vector<stream_finalizer> m_stream_finalizers;
       std::vector<std::shared_ptr<std::promise<void>>> m_statuses;
       std::vector<std::function<void()>> m_callbacks;
       std::vector<std::shared_ptr<void>> m_ptrs;
@@ -45,12 +63,66 @@ namespace ttg {
       int world_size;
       int world_rank;
       bool m_is_valid = true;
+      ttg::detail::memory_budget m_budget;  //!< the budget of the pending tasks of all TTs on this process
+      std::future<void> m_fence;  //!< the split-phase fence in progress, if valid, see fence_begin
+      std::atomic<std::uint64_t> m_quiescences = 0;  //!< the number of times this world became quiescent
 
      protected:
       void mark_invalid() { m_is_valid = false; }
 
       virtual void fence_impl(void) = 0;
 
+      /// replaces each element of @p flags by its logical or over all processes; collective
+      virtual void allreduce_or(std::vector<int>& flags) = 0;
+
+      /// @return true if @p to can receive messages sent, directly or indirectly, by @p from
+      static bool is_downstream(const ttg::TTBase* from, const ttg::TTBase* to) {
+        std::vector<const ttg::TTBase*> visited{from};
+        std::vector<const ttg::TTBase*> stack{from};
+        while (!stack.empty()) {
+          auto op = stack.back();
+          stack.pop_back();
+          for (auto out : op->get_outputs()) {
+            if (nullptr == out) continue;
+            for (auto in : out->get_connections()) {
+              const ttg::TTBase* successor = in->get_tt();
+              if (successor == to) return true;
+              if (std::find(visited.begin(), visited.end(), successor) == visited.end()) {
+                visited.push_back(successor);
+                stack.push_back(successor);
+              }
+            }
+          }
+        }
+        return false;
+      }
+
+      /// Called by fence() once the world is quiescent, i.e. once no task can run and no message is in flight:
+      /// the tasks that are still pending can then only be released by finalizing their streams. Finalizes the
+      /// streams of the TTs that have tasks awaiting it, except those of TTs that can receive values from another
+      /// such TT, which must wait for the latter's tasks to complete. TTs that send values to each other, directly
+      /// or indirectly, are finalized together.
+      /// @return true if any stream was finalized, i.e. if new tasks may be running; collective
+      bool finalize_quiescent_streams() {
+        if (m_stream_finalizers.empty()) return false;
+        const auto n = m_stream_finalizers.size();
+        std::vector<int> pending(n);
+        for (std::size_t k = 0; k != n; ++k) pending[k] = m_stream_finalizers[k].pending() ? 1 : 0;
+        allreduce_or(pending);
+        if (std::none_of(pending.begin(), pending.end(), [](int p) { return p != 0; })) return false;
+        for (std::size_t k = 0; k != n; ++k) {
+          if (!pending[k]) continue;
+          const auto op = m_stream_finalizers[k].op;
+          bool upstream_pending = false;
+          for (std::size_t j = 0; j != n && !upstream_pending; ++j) {
+            const auto other = m_stream_finalizers[j].op;
+            upstream_pending = j != k && pending[j] && is_downstream(other, op) && !is_downstream(op, other);
+          }
+          if (!upstream_pending) m_stream_finalizers[k].finalize();
+        }
+        return true;
+      }
+
       void release_ops(void) {
         while (!m_op_register.empty()) {
           (*m_op_register.begin())->release();
@@ -107,7 +179,59 @@ namespace ttg {
        * (i.e., fence() behaves as a barrier).
        */
       void fence(void) {
+        if (m_fence.valid()) throw std::logic_error("ttg::World::fence: a split-phase fence is in progress");
+        quiesce();
+        complete_fence();
+      }
+
+      /**
+       * Start a split-phase fence: fence() runs on a helper thread, while the calling thread
+       * returns immediately, e.g. to do host-side I/O or to prepare the data of the next phase,
+       * and completes it with fence_test() or fence_wait(). Like fence() this is a collective.
+       * Until the fence completes no task may be injected into this world and no TT may be created
+       * in it (see check_no_fence_in_progress), since the backends may reset their state for the TTs
+       * at the end of the fence, and the MPI library must allow calls from the helper thread.
+       */
+      void fence_begin(void) {
+        if (m_fence.valid()) throw std::logic_error("ttg::World::fence_begin: a split-phase fence is in progress");
+        m_fence = std::async(std::launch::async, [this]() { quiesce(); });
+      }
+
+      /**
+       * Test for the completion of the split-phase fence started by fence_begin(), without blocking.
+       * Returns true, and completes the fence, if all tasks in this world have finished on all ranks,
+       * or if no fence is in progress. Not a collective.
+       */
+      bool fence_test(void) {
+        if (!m_fence.valid()) return true;
+        if (m_fence.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return false;
+        fence_wait();
+        return true;
+      }
+
+      /**
+       * Wait for the completion of the split-phase fence started by fence_begin(), if any.
+       * Not a collective.
+       */
+      void fence_wait(void) {
+        if (!m_fence.valid()) return;
+        m_fence.get();  // rethrows the exceptions of the fence
+        complete_fence();
+      }
+
+     private:
+      /// waits for all tasks in this world to complete, including those waiting for streams finalized by the runtime
+      void quiesce() {
+        ttg::detail::notify_task_observers([](TaskObserver& o) { o.fence_started(); });
         fence_impl();
+        // the world is quiescent, release the tasks waiting for streams that can no longer receive values
+        while (finalize_quiescent_streams()) fence_impl();
+        m_quiescences.fetch_add(1, std::memory_order_release);
+        ttg::detail::notify_task_observers([](TaskObserver& o) { o.fence_finished(); });
+      }
+
+      /// fulfills the statuses and calls the callbacks registered with this world, once it is quiescent
+      void complete_fence() {
         for (auto& status : m_statuses) {
           status->set_value();
         }
@@ -118,6 +242,7 @@ namespace ttg {
         m_callbacks.clear();  // clear out the statuses
       }
 
+     public:
       /**
        * Start the execution of tasks in this world. The call to execute()
        * will return immediately, i.e., it will not wait for all tasks
@@ -133,10 +258,21 @@ namespace ttg {
        * destroyed during destruction of this world.
        */
       void register_op(ttg::TTBase* op) {
+        check_no_fence_in_progress(op->get_name());
         // TODO: do we need locking here?
         m_op_register.push_back(op);
       }
 
+      /**
+       * Throws std::logic_error if a split-phase fence is in progress, during which no TT may be
+       * created in this world; called by the backends when the TT named @p name is created.
+       * \sa fence_begin
+       */
+      void check_no_fence_in_progress(const std::string& name) const {
+        if (m_fence.valid())
+          throw std::logic_error("ttg::World: cannot create TT " + name + " while a split-phase fence is in progress");
+      }
+
       /**
        * Deregister a TT from this world. TTs deregister themselves during
        * destruction to avoid dangling references.
@@ -146,6 +282,26 @@ namespace ttg {
         m_op_register.remove(op);
       }
 
+      /**
+       * Register a TT with streaming inputs that are finalized by the runtime once no more
+       * values can arrive for them. fence() calls @p pending on every process once the world
+       * is quiescent and, if it returns true on any process, @p finalize on every process,
+       * then waits again for quiescence. Must be called on every process, in the same order.
+       * \sa TT::set_argstream_auto_finalize
+       */
+      void register_stream_finalizer(ttg::TTBase* op, std::function<bool()> pending, std::function<void()> finalize) {
+        m_stream_finalizers.push_back({op, std::move(pending), std::move(finalize)});
+      }
+
+      /**
+       * Deregister a TT registered with register_stream_finalizer().
+       */
+      void deregister_stream_finalizer(ttg::TTBase* op) {
+        m_stream_finalizers.erase(std::remove_if(m_stream_finalizers.begin(), m_stream_finalizers.end(),
+                                                 [op](const stream_finalizer& f) { return f.op == op; }),
+                                  m_stream_finalizers.end());
+      }
+
 
       /**
        * Whether this world is valid. A word is marked as invalid during destruction
@@ -153,6 +309,66 @@ namespace ttg {
        */
       bool is_valid(void) const { return m_is_valid; }
 
+      /**
+       * The budget of the pending tasks of all TTs of this world on this process,
+       * charged by the backends.
+       * \sa World::set_max_pending_tasks
+       */
+      ttg::detail::memory_budget& budget() { return m_budget; }
+      const ttg::detail::memory_budget& budget() const { return m_budget; }
+
+      /**
+       * The number of times this world became quiescent on this process, i.e. of fences
+       * (including split-phase fences) that detected the termination of all tasks.
+       */
+      const std::atomic<std::uint64_t>& quiescences() const { return m_quiescences; }
+
+      /**
+       * Returns a handle on the termination of @p tt, a TT or a TTG of this world: with a single
+       * process the handle observes the tasks of @p tt and of the TTs upstream of it, among those
+       * registered so far, otherwise the quiescence of this world.
+       * \sa ttg::Completion
+       */
+      Completion completion(const ttg::TTBase& tt) const {
+        // the TTs that send inputs to each TT
+        std::map<const ttg::TTBase*, std::vector<const ttg::TTBase*>> producers;
+        for (auto op : m_op_register) {
+          for (auto out : op->get_outputs()) {
+            if (nullptr == out) continue;
+            for (auto in : out->get_connections()) producers[in->get_tt()].push_back(op);
+          }
+        }
+        // the TTs of tt, then those upstream of them
+        std::vector<const ttg::TTBase*> observed;
+        std::set<const ttg::TTBase*> visited;
+        for (auto op : m_op_register) {
+          const ttg::TTBase* t = op;
+          while (t != nullptr && t != &tt) t = t->ttg_ptr();
+          if (t != nullptr && visited.insert(op).second) observed.push_back(op);
+        }
+        for (std::size_t i = 0; i < observed.size(); ++i) {
+          auto it = producers.find(observed[i]);
+          if (it == producers.end()) continue;
+          for (auto op : it->second) {
+            if (visited.insert(op).second) observed.push_back(op);
+          }
+        }
+        std::vector<const ttg::detail::tt_counter_slots*> counters;
+        for (auto op : observed) op->get_counter_slots(counters);
+        return Completion(std::move(counters), &m_quiescences, world_size == 1);
+      }
+
+      /**
+       * The runtime counters of the TTs registered with this world, on this process,
+       * in the order of their registration.
+       * \sa TTBase::get_counters
+       */
+      std::vector<TTCounters> tt_counters() const {
+        std::vector<TTCounters> result;
+        for (auto op : m_op_register) result.push_back(op->get_counters());
+        return result;
+      }
+
       virtual void final_task() {}
 
       virtual void profile_on() { }
@@ -223,6 +439,24 @@ namespace ttg {
         return *reinterpret_cast<WorldImplT*>(m_impl.get());
       }
 
+      /* Split-phase fence, see WorldImplBase::fence_begin */
+      void fence_begin() { m_impl->fence_begin(); }
+      bool fence_test() { return m_impl->fence_test(); }
+      void fence_wait() { m_impl->fence_wait(); }
+
+      /* Handle on the termination of a TT or TTG of this world, see WorldImplBase::completion */
+      Completion completion(const ttg::TTBase& tt) const { return m_impl->completion(tt); }
+
+      /* Limits the number of pending tasks of all TTs on this process, 0 (the default) means unlimited;
+       * the limit is soft, see TTBase::set_max_pending_tasks */
+      void set_max_pending_tasks(std::size_t n) { m_impl->budget().set_max_pending_tasks(n); }
+      std::size_t get_max_pending_tasks() const { return m_impl->budget().get_max_pending_tasks(); }
+
+      /* Limits the number of bytes of the inputs held by the pending tasks of all TTs on this process,
+       * 0 (the default) means unlimited; the limit is soft, see TTBase::set_max_data_bytes */
+      void set_max_data_bytes(std::size_t n) { m_impl->budget().set_max_data_bytes(n); }
+      std::size_t get_max_data_bytes() const { return m_impl->budget().get_max_data_bytes(); }
+
       void profile_on() { m_impl->profile_on(); }
       void profile_off() { m_impl->profile_off(); }
       bool profiling() { return m_impl->profiling(); }
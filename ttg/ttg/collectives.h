@@ -0,0 +1,408 @@
+#ifndef TTG_COLLECTIVES_H
+#define TTG_COLLECTIVES_H
+
+/**
+ * @file ttg/collectives.h
+ * Defines the typed collective operations of ttg::World (see ttg/world.h) for the default backend.
+ * All backends run on top of MPI, the collectives are implemented on the communicator of the World.
+ */
+
+#include <mpi.h>
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "ttg/serialization/data_descriptor.h"
+#include "ttg/serialization/splitmd_data_descriptor.h"
+#include "ttg/util/print.h"
+#include "ttg/world.h"
+
+namespace ttg {
+
+  namespace detail {
+    namespace coll {
+
+      /// true if objects of type @p T are communicated as their bytes
+      template <typename T>
+      inline constexpr bool is_bytewise_v = std::is_trivially_copyable_v<T> &&
+                                            !ttg::detail::is_user_buffer_serializable_v<T> &&
+                                            !ttg::has_split_metadata<T>::value;
+
+      /// @return the predefined MPI datatype corresponding to @p T, or MPI_DATATYPE_NULL if there is none
+      template <typename T>
+      MPI_Datatype mpi_datatype() {
+        if constexpr (std::is_same_v<T, char>) return MPI_CHAR;
+        else if constexpr (std::is_same_v<T, signed char>) return MPI_SIGNED_CHAR;
+        else if constexpr (std::is_same_v<T, unsigned char>) return MPI_UNSIGNED_CHAR;
+        else if constexpr (std::is_same_v<T, short>) return MPI_SHORT;
+        else if constexpr (std::is_same_v<T, unsigned short>) return MPI_UNSIGNED_SHORT;
+        else if constexpr (std::is_same_v<T, int>) return MPI_INT;
+        else if constexpr (std::is_same_v<T, unsigned int>) return MPI_UNSIGNED;
+        else if constexpr (std::is_same_v<T, long>) return MPI_LONG;
+        else if constexpr (std::is_same_v<T, unsigned long>) return MPI_UNSIGNED_LONG;
+        else if constexpr (std::is_same_v<T, long long>) return MPI_LONG_LONG;
+        else if constexpr (std::is_same_v<T, unsigned long long>) return MPI_UNSIGNED_LONG_LONG;
+        else if constexpr (std::is_same_v<T, float>) return MPI_FLOAT;
+        else if constexpr (std::is_same_v<T, double>) return MPI_DOUBLE;
+        else if constexpr (std::is_same_v<T, long double>) return MPI_LONG_DOUBLE;
+        else return MPI_DATATYPE_NULL;
+      }
+
+      /// true if @p T has a predefined MPI datatype
+      template <typename T>
+      inline constexpr bool has_mpi_datatype_v =
+          std::is_same_v<T, char> || std::is_same_v<T, signed char> || std::is_same_v<T, unsigned char> ||
+          std::is_same_v<T, short> || std::is_same_v<T, unsigned short> || std::is_same_v<T, int> ||
+          std::is_same_v<T, unsigned int> || std::is_same_v<T, long> || std::is_same_v<T, unsigned long> ||
+          std::is_same_v<T, long long> || std::is_same_v<T, unsigned long long> || std::is_same_v<T, float> ||
+          std::is_same_v<T, double> || std::is_same_v<T, long double>;
+
+      /// @return the predefined MPI reduction operation equivalent to @p Op applied to objects of type @p T,
+      ///         or MPI_OP_NULL if there is none
+      template <typename Op, typename T>
+      MPI_Op mpi_op() {
+        if constexpr (std::is_same_v<Op, std::plus<>> || std::is_same_v<Op, std::plus<T>>) return MPI_SUM;
+        else if constexpr (std::is_same_v<Op, std::multiplies<>> || std::is_same_v<Op, std::multiplies<T>>)
+          return MPI_PROD;
+        else if constexpr (std::is_integral_v<T> &&
+                           (std::is_same_v<Op, std::bit_and<>> || std::is_same_v<Op, std::bit_and<T>>))
+          return MPI_BAND;
+        else if constexpr (std::is_integral_v<T> &&
+                           (std::is_same_v<Op, std::bit_or<>> || std::is_same_v<Op, std::bit_or<T>>))
+          return MPI_BOR;
+        else if constexpr (std::is_integral_v<T> &&
+                           (std::is_same_v<Op, std::bit_xor<>> || std::is_same_v<Op, std::bit_xor<T>>))
+          return MPI_BXOR;
+        else return MPI_OP_NULL;
+      }
+
+      /// true if reducing objects of type @p T with @p Op maps to a predefined MPI reduction
+      template <typename Op, typename T>
+      inline constexpr bool has_mpi_op_v =
+          has_mpi_datatype_v<T> &&
+          (std::is_same_v<Op, std::plus<>> || std::is_same_v<Op, std::plus<T>> ||
+           std::is_same_v<Op, std::multiplies<>> || std::is_same_v<Op, std::multiplies<T>> ||
+           (std::is_integral_v<T> && (std::is_same_v<Op, std::bit_and<>> || std::is_same_v<Op, std::bit_and<T>> ||
+                                      std::is_same_v<Op, std::bit_or<>> || std::is_same_v<Op, std::bit_or<T>> ||
+                                      std::is_same_v<Op, std::bit_xor<>> || std::is_same_v<Op, std::bit_xor<T>>)));
+
+      /// @return @p count as an MPI count
+      /// @throw std::runtime_error if @p count does not fit into an int
+      inline int mpi_count(std::size_t count) {
+        if (count > static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+          ttg::print_error("ttg::World collectives: message of ", count, " bytes exceeds the MPI count limit");
+          throw std::runtime_error("ttg::World collectives: message exceeds the MPI count limit");
+        }
+        return static_cast<int>(count);
+      }
+
+      /// Serializes @p n objects starting at @p values, appending to @p buf
+      /// memory layout: [<payload_size, payload>...]
+      template <typename T>
+      void pack(const T *values, std::size_t n, std::vector<unsigned char> &buf) {
+        using descriptor_t = ttg::default_data_descriptor<T>;
+        for (std::size_t k = 0; k < n; ++k) {
+          uint64_t size = descriptor_t::payload_size(&values[k]);
+          auto pos = buf.size();
+          buf.resize(pos + sizeof(size) + size);
+          std::memcpy(buf.data() + pos, &size, sizeof(size));
+          descriptor_t::pack_payload(&values[k], size, pos + sizeof(size), buf.data());
+        }
+      }
+
+      /// Deserializes the objects packed by pack() in [@p buf, @p buf + @p size), appending to @p values
+      template <typename T>
+      void unpack(const unsigned char *buf, std::size_t size, std::vector<T> &values) {
+        using descriptor_t = ttg::default_data_descriptor<T>;
+        std::size_t pos = 0;
+        while (pos < size) {
+          uint64_t payload_size;
+          std::memcpy(&payload_size, buf + pos, sizeof(payload_size));
+          pos += sizeof(payload_size);
+          values.emplace_back();
+          descriptor_t::unpack_payload(&values.back(), payload_size, pos, buf);
+          pos += payload_size;
+        }
+        assert(pos == size);
+      }
+
+      /// Gathers @p sendcount bytes from all ranks into @p recvbuf on @p root, or on all ranks if @p root is negative
+      /// @return the byte displacements of the contributions of each rank in @p recvbuf, followed by the total size,
+      ///         empty on ranks that receive nothing; @p recvbuf is resized to the total size by @p resize
+      template <typename Resize>
+      std::vector<int> gatherv_bytes(MPI_Comm comm, const void *sendbuf, int sendcount, int root, Resize &&resize) {
+        int rank, size;
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &size);
+        const bool all = root < 0;
+        const bool receiver = all || rank == root;
+        std::vector<int> counts(receiver ? size : 0);
+        if (all)
+          MPI_Allgather(&sendcount, 1, MPI_INT, counts.data(), 1, MPI_INT, comm);
+        else
+          MPI_Gather(&sendcount, 1, MPI_INT, counts.data(), 1, MPI_INT, root, comm);
+        std::vector<int> displs;
+        void *recvbuf = nullptr;
+        if (receiver) {
+          displs.resize(size + 1);
+          std::size_t total = 0;
+          for (int r = 0; r < size; ++r) {
+            displs[r] = mpi_count(total);
+            total += counts[r];
+          }
+          displs[size] = mpi_count(total);
+          recvbuf = resize(total);
+        }
+        if (all)
+          MPI_Allgatherv(sendbuf, sendcount, MPI_BYTE, recvbuf, counts.data(), displs.data(), MPI_BYTE, comm);
+        else
+          MPI_Gatherv(sendbuf, sendcount, MPI_BYTE, recvbuf, counts.data(), displs.data(), MPI_BYTE, root, comm);
+        return displs;
+      }
+
+      /// Gathers the @p n objects at @p values of every rank, in rank order, on @p root,
+      /// or on all ranks if @p root is negative
+      /// @return the gathered objects, empty on ranks other than @p root
+      template <typename T>
+      std::vector<T> gatherv(MPI_Comm comm, const T *values, std::size_t n, int root) {
+        std::vector<T> result;
+        if constexpr (is_bytewise_v<T>) {
+          /* received directly into the result */
+          gatherv_bytes(comm, values, mpi_count(n * sizeof(T)), root, [&](std::size_t bytes) -> void * {
+            result.resize(bytes / sizeof(T));
+            return result.data();
+          });
+        } else {
+          std::vector<unsigned char> sendbuf;
+          pack(values, n, sendbuf);
+          std::vector<unsigned char> recvbuf;
+          auto displs = gatherv_bytes(comm, sendbuf.data(), mpi_count(sendbuf.size()), root,
+                                      [&](std::size_t bytes) -> void * {
+                                        recvbuf.resize(bytes);
+                                        return recvbuf.data();
+                                      });
+          if (!displs.empty()) unpack(recvbuf.data(), recvbuf.size(), result);
+        }
+        return result;
+      }
+
+      /// Gathers the split-metadata objects @p value of all ranks on all ranks; the payload is received
+      /// directly into the created objects
+      template <typename T>
+      std::vector<T> allgather_splitmd(MPI_Comm comm, const T &value) {
+        int rank, size;
+        MPI_Comm_rank(comm, &rank);
+        MPI_Comm_size(comm, &size);
+        ttg::SplitMetadataDescriptor<T> descr;
+        auto metadata = descr.get_metadata(value);
+        using metadata_t = decltype(metadata);
+        std::vector<metadata_t> metadata_all(size);
+        MPI_Allgather(&metadata, sizeof(metadata_t), MPI_BYTE, metadata_all.data(), sizeof(metadata_t), MPI_BYTE,
+                      comm);
+        std::vector<T> result;
+        result.reserve(size);
+        for (int r = 0; r < size; ++r) {
+          result.push_back(descr.create_from_metadata(metadata_all[r]));
+        }
+        std::vector<MPI_Request> requests;
+        for (int r = 0; r < size; ++r) {
+          auto &src = (r == rank) ? const_cast<T &>(value) : result[r];
+          for (auto &&iov : descr.get_data(src)) {
+            requests.emplace_back();
+            MPI_Ibcast(iov.data, mpi_count(iov.num_bytes), MPI_BYTE, r, comm, &requests.back());
+          }
+        }
+        MPI_Waitall(mpi_count(requests.size()), requests.data(), MPI_STATUSES_IGNORE);
+        /* the local contribution was sent from value, copy it */
+        auto src_iovs = descr.get_data(const_cast<T &>(value));
+        auto dst_iovs = descr.get_data(result[rank]);
+        auto dst_it = std::begin(dst_iovs);
+        for (auto &&iov : src_iovs) {
+          assert(dst_it != std::end(dst_iovs) && dst_it->num_bytes == iov.num_bytes);
+          std::memcpy(dst_it->data, iov.data, iov.num_bytes);
+          ++dst_it;
+        }
+        return result;
+      }
+
+      /// @return @p values folded in order with @p op
+      template <typename T, typename Op>
+      T fold(std::vector<T> &&values, Op &op) {
+        assert(!values.empty());
+        T result = std::move(values[0]);
+        for (std::size_t r = 1; r < values.size(); ++r) {
+          result = op(std::move(result), values[r]);
+        }
+        return result;
+      }
+
+    }  // namespace coll
+  }    // namespace detail
+
+  template <typename T, typename Op>
+  T World::allreduce(const T &value, Op op) const {
+    MPI_Comm comm = impl().comm();
+    if constexpr (detail::coll::has_mpi_op_v<Op, T>) {
+      T result;
+      MPI_Allreduce(&value, &result, 1, detail::coll::mpi_datatype<T>(), detail::coll::mpi_op<Op, T>(), comm);
+      return result;
+    } else {
+      return detail::coll::fold(allgather(value), op);
+    }
+  }
+
+  template <typename T, typename Op>
+  T World::reduce(const T &value, int root, Op op) const {
+    MPI_Comm comm = impl().comm();
+    if constexpr (detail::coll::has_mpi_op_v<Op, T>) {
+      T result = value;
+      MPI_Reduce(&value, &result, 1, detail::coll::mpi_datatype<T>(), detail::coll::mpi_op<Op, T>(), root, comm);
+      return result;
+    } else if constexpr (ttg::has_split_metadata<T>::value) {
+      /* the payload of split-metadata types is exchanged in place, which is only implemented for all ranks */
+      auto values = detail::coll::allgather_splitmd(comm, value);
+      return (rank() == root) ? detail::coll::fold(std::move(values), op) : value;
+    } else {
+      auto values = detail::coll::gatherv(comm, &value, 1, root);
+      return (rank() == root) ? detail::coll::fold(std::move(values), op) : value;
+    }
+  }
+
+  template <typename T>
+  void World::broadcast(T &value, int root) const {
+    MPI_Comm comm = impl().comm();
+    if constexpr (detail::coll::is_bytewise_v<T>) {
+      MPI_Bcast(&value, sizeof(T), MPI_BYTE, root, comm);
+    } else if constexpr (ttg::has_split_metadata<T>::value) {
+      /* only the metadata is serialized, the payload is received in place */
+      ttg::SplitMetadataDescriptor<T> descr;
+      auto metadata = descr.get_metadata(value);
+      MPI_Bcast(&metadata, sizeof(metadata), MPI_BYTE, root, comm);
+      if (rank() != root) value = descr.create_from_metadata(metadata);
+      for (auto &&iov : descr.get_data(value)) {
+        MPI_Bcast(iov.data, detail::coll::mpi_count(iov.num_bytes), MPI_BYTE, root, comm);
+      }
+    } else {
+      using descriptor_t = ttg::default_data_descriptor<T>;
+      uint64_t size = (rank() == root) ? descriptor_t::payload_size(&value) : 0;
+      MPI_Bcast(&size, 1, MPI_UINT64_T, root, comm);
+      std::vector<unsigned char> buf(size);
+      if (rank() == root) descriptor_t::pack_payload(&value, size, 0, buf.data());
+      MPI_Bcast(buf.data(), detail::coll::mpi_count(size), MPI_BYTE, root, comm);
+      if (rank() != root) descriptor_t::unpack_payload(&value, size, 0, buf.data());
+    }
+  }
+
+  template <typename T>
+  std::vector<T> World::allgather(const T &value) const {
+    MPI_Comm comm = impl().comm();
+    if constexpr (ttg::has_split_metadata<T>::value) {
+      return detail::coll::allgather_splitmd(comm, value);
+    } else {
+      return detail::coll::gatherv(comm, &value, 1, -1);
+    }
+  }
+
+  template <typename T>
+  std::vector<T> World::allgatherv(const std::vector<T> &values) const {
+    return detail::coll::gatherv(impl().comm(), values.data(), values.size(), -1);
+  }
+
+  template <typename T, typename Op>
+  std::future<T> World::iallreduce(const T &value, Op op) const {
+    MPI_Comm comm = impl().comm();
+    if constexpr (detail::coll::has_mpi_op_v<Op, T>) {
+      struct state_t {
+        T result;
+        MPI_Request request;
+      };
+      auto state = std::make_shared<state_t>();
+      /* the send buffer must outlive the operation */
+      auto sendbuf = std::make_shared<T>(value);
+      MPI_Iallreduce(sendbuf.get(), &state->result, 1, detail::coll::mpi_datatype<T>(),
+                     detail::coll::mpi_op<Op, T>(), comm, &state->request);
+      return std::async(std::launch::deferred, [state, sendbuf]() {
+        MPI_Wait(&state->request, MPI_STATUS_IGNORE);
+        return state->result;
+      });
+    } else {
+      auto values = iallgather(value);
+      return std::async(std::launch::deferred,
+                        [values = std::move(values), op]() mutable { return detail::coll::fold(values.get(), op); });
+    }
+  }
+
+  template <typename T>
+  std::future<std::vector<T>> World::iallgather(const T &value) const {
+    MPI_Comm comm = impl().comm();
+    if constexpr (detail::coll::is_bytewise_v<T>) {
+      struct state_t {
+        T value;
+        std::vector<T> result;
+        MPI_Request request;
+      };
+      auto state = std::make_shared<state_t>();
+      state->value = value;
+      state->result.resize(size());
+      MPI_Iallgather(&state->value, sizeof(T), MPI_BYTE, state->result.data(), sizeof(T), MPI_BYTE, comm,
+                     &state->request);
+      return std::async(std::launch::deferred, [state]() {
+        MPI_Wait(&state->request, MPI_STATUS_IGNORE);
+        return std::move(state->result);
+      });
+    } else {
+      /* the sizes of the serialized objects are not known in advance, the exchange happens in get() */
+      return std::async(std::launch::deferred, [world = *this, value]() { return world.allgather(value); });
+    }
+  }
+
+  inline std::vector<TTCounters> World::counters(bool all_processes) const {
+    auto result = impl().tt_counters();
+    if (!all_processes) return result;
+    /* sum the counters, and take the maximum of the peaks, as flat arrays */
+    std::vector<std::uint64_t> sums;
+    std::vector<std::uint64_t> peaks;
+    for (auto &c : result) {
+      for (auto value : {c.tasks_created, c.tasks_executed, c.tasks_inlined, c.set_arg_local, c.set_arg_remote,
+                         c.reducer_calls, c.data_copies_created, c.data_copies_deep_copied})
+        sums.push_back(value);
+      sums.insert(sums.end(), c.bytes_sent.begin(), c.bytes_sent.end());
+      sums.insert(sums.end(), c.bytes_received.begin(), c.bytes_received.end());
+      peaks.push_back(c.peak_pending_tasks);
+    }
+    const std::uint64_t layout[2] = {static_cast<std::uint64_t>(sums.size()), static_cast<std::uint64_t>(peaks.size())};
+    std::uint64_t min_layout[2], max_layout[2];
+    MPI_Comm comm = impl().comm();
+    MPI_Allreduce(layout, min_layout, 2, MPI_UINT64_T, MPI_MIN, comm);
+    MPI_Allreduce(layout, max_layout, 2, MPI_UINT64_T, MPI_MAX, comm);
+    if (min_layout[0] != max_layout[0] || min_layout[1] != max_layout[1]) {
+      ttg::print_error("ttg::World::counters: the processes have different TTs");
+      throw std::logic_error("ttg::World::counters: the processes have different TTs");
+    }
+    MPI_Allreduce(MPI_IN_PLACE, sums.data(), detail::coll::mpi_count(sums.size()), MPI_UINT64_T, MPI_SUM, comm);
+    MPI_Allreduce(MPI_IN_PLACE, peaks.data(), detail::coll::mpi_count(peaks.size()), MPI_UINT64_T, MPI_MAX, comm);
+    std::size_t pos = 0;
+    for (std::size_t k = 0; k < result.size(); ++k) {
+      auto &c = result[k];
+      for (auto value : {&c.tasks_created, &c.tasks_executed, &c.tasks_inlined, &c.set_arg_local, &c.set_arg_remote,
+                         &c.reducer_calls, &c.data_copies_created, &c.data_copies_deep_copied})
+        *value = sums[pos++];
+      for (auto &value : c.bytes_sent) value = sums[pos++];
+      for (auto &value : c.bytes_received) value = sums[pos++];
+      c.peak_pending_tasks = peaks[k];
+    }
+    return result;
+  }
+
+}  // namespace ttg
+
+#endif  // TTG_COLLECTIVES_H
@@ -20,6 +20,14 @@ enum class ExecutionSpace {
   Invalid
 };
 
+/// denotes how the values received by a streaming input terminal are reduced, see TT::set_input_reducer
+enum class ReduceMode {
+  Locked,    // each value is reduced into the input of the task under the lock of the task
+  Atomic,    // values of arithmetic type are reduced with compare-and-swap, without locking
+  PerThread  // each thread reduces into its own partial result, partial results are combined when the stream is
+             // complete
+};
+
 };
 
 #endif //TTG_EXECUTION_H
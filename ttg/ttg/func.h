@@ -8,6 +8,12 @@
 #include "ttg/terminal.h"
 #include "ttg/traverse.h"
 #include "ttg/tt.h"
+#include "ttg/util/env.h"
+#include "ttg/util/print.h"
+
+#include <map>
+#include <stdexcept>
+#include <vector>
 
 namespace ttg {
 
@@ -69,17 +75,82 @@ namespace ttg {
       return terminal_ptr;
     }
 
+    /// Fuses the linear chains of @p tts (see TTBase::set_fused): a TT is fused if its only input is fed by a
+    /// single output terminal, of another TT and with the same key type, that feeds no other input. The TTs whose
+    /// execution policy is ttg::Execution::Async are not fused.
+    inline void fuse_linear_chains(const std::vector<TTBase *> &tts) {
+      std::map<const TerminalBase *, std::vector<const TerminalBase *>> producers;  // in terminal -> out terminals
+      for (auto *tt : tts) {
+        for (auto *out : tt->get_outputs()) {
+          if (!out) continue;
+          for (auto *in : out->get_connections()) producers[in].push_back(out);
+        }
+      }
+      for (auto *tt : tts) {
+        if (tt->is_ttg() || tt->get_inputs().size() != 1) continue;
+        const auto &policy = tt->get_execution_policy();
+        if (policy && *policy == ttg::Execution::Async) continue;
+        const auto *in = tt->get_inputs()[0];
+        if (!in || in->is_pull_terminal) continue;
+        const auto it = producers.find(in);
+        if (it == producers.end() || it->second.size() != 1) continue;
+        const auto *out = it->second.front();
+        if (out->get_tt() == tt || out->get_connections().size() != 1 ||
+            out->get_key_type_str() != in->get_key_type_str())
+          continue;
+        tt->set_fused(true);
+      }
+    }
+
   }  // namespace detail
 
   /// \brief Make the TTG \c tts executable.
-  /// Applies \sa make_executable method to every op in the graph
+  /// Applies \sa make_executable method to every op in the graph, and fuses its linear chains of TTs (see
+  /// \sa fuse_linear_chains) if requested by the environment variable `TTG_AUTO_FUSE=1`.
   /// \param tts The task graph to make executable.
   /// \return true if there are no dangling out terminals
   template <typename... TTBasePtrs>
   inline std::enable_if_t<(std::is_convertible_v<decltype(*(std::declval<TTBasePtrs>())), TTBase &> && ...), bool>
   make_graph_executable(TTBasePtrs &&...tts) {
-    return ttg::make_traverse([](auto &&x) { std::forward<decltype(x)>(x)->make_executable(); })(
-        std::forward<TTBasePtrs>(tts)...);
+    std::vector<TTBase *> graph;
+    const auto status = ttg::make_traverse([&graph](auto &&x) {
+      graph.push_back(x);
+      std::forward<decltype(x)>(x)->make_executable();
+    })(std::forward<TTBasePtrs>(tts)...);
+    if (ttg::detail::auto_fuse()) detail::fuse_linear_chains(graph);
+    return status;
+  }
+
+  /// \brief Fuse the linear chains of the TTG \c tts.
+  /// A TT of the graph is fused (see TTBase::set_fused), i.e. executes its tasks within the tasks that send its input
+  /// with the same key, if its only input is fed by a single output terminal, of another TT and with the same key
+  /// type, that feeds no other input. The TTs whose execution policy is ttg::Execution::Async are not fused.
+  /// \param tts The task graph whose chains to fuse.
+  template <typename... TTBasePtrs>
+  inline std::enable_if_t<(std::is_convertible_v<decltype(*(std::declval<TTBasePtrs>())), TTBase &> && ...), void>
+  fuse_linear_chains(TTBasePtrs &&...tts) {
+    std::vector<TTBase *> graph;
+    ttg::make_traverse([&graph](auto &&x) { graph.push_back(x); })(std::forward<TTBasePtrs>(tts)...);
+    detail::fuse_linear_chains(graph);
+  }
+
+  /// \brief Fuse the tasks of TTs into the tasks that send their inputs.
+  /// Each TT of \c tts executes its tasks within the tasks that send its input with the same key, see
+  /// TTBase::set_fused. Unlike the chains fused by \sa fuse_linear_chains, \c tts may have several producers.
+  /// \param tts The TTs to fuse, each with a single input.
+  /// \throw std::logic_error if a TT does not have exactly one input
+  template <typename... TTBasePtrs>
+  inline std::enable_if_t<(std::is_convertible_v<decltype(*(std::declval<TTBasePtrs>())), TTBase &> && ...), void>
+  fuse_tts(TTBasePtrs &&...tts) {
+    auto fuse = [](TTBase &tt) {
+      if (tt.get_inputs().size() != 1) {
+        ttg::print_error(tt.get_name(), " : fuse_tts: only a TT with a single input can be fused, this TT has ",
+                         tt.get_inputs().size());
+        throw std::logic_error("ttg::fuse_tts: only a TT with a single input can be fused");
+      }
+      tt.set_fused(true);
+    };
+    (fuse(*tts), ...);
   }
 
   /// \brief Connect output terminal to successor input terminal
@@ -0,0 +1,273 @@
+#ifndef TTG_KEYMAPS_H
+#define TTG_KEYMAPS_H
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "ttg/util/hash.h"
+#include "ttg/util/meta.h"
+
+/// @file keymaps.h
+/// Keymaps that place neighbouring keys on the same or on nearby processes, to be used instead of the default
+/// keymap (which hashes the keys) for dense and tree algorithms. All of them are copyable and cheap to evaluate.
+
+namespace ttg {
+
+  namespace detail {
+
+    template <typename Key, typename Enabler = void>
+    struct has_subscript : std::false_type {};
+    template <typename Key>
+    struct has_subscript<Key, meta::void_t<decltype(std::declval<const Key &>()[std::size_t{0}])>>
+        : std::true_type {};
+
+    /// @return index @p d of @p key, a ttg::MultiIndex or any key with a subscript operator, or a tuple-like key
+    template <std::size_t d, typename Key>
+    std::int64_t key_index(const Key &key) {
+      if constexpr (has_subscript<Key>::value) {
+        return static_cast<std::int64_t>(key[d]);
+      } else {
+        return static_cast<std::int64_t>(std::get<d>(key));
+      }
+    }
+
+    /// @return @p i modulo @p n in @c [0,n), also for negative @p i
+    inline int nonnegative_mod(std::int64_t i, int n) {
+      const auto r = static_cast<int>(i % n);
+      return r < 0 ? r + n : r;
+    }
+
+  }  // namespace detail
+
+  /// @return the shape {P,Q} of the 2-d process grid of @p nproc processes that is closest to square, with @c P<=Q
+  inline std::pair<int, int> process_grid_2d(int nproc) {
+    assert(nproc > 0);
+    int P = 1;
+    for (int p = 1; p * p <= nproc; ++p)
+      if (nproc % p == 0) P = p;
+    return {P, nproc / P};
+  }
+
+  /// 2-d block-cyclic distribution of the keys {i,j} over a P×Q grid of processes, as in ScaLAPACK: block
+  /// {i/mb, j/nb} is owned by process @c (i/mb)%P + ((j/nb)%Q)*P, i.e. processes are numbered column-major in the grid.
+  /// The keys are ttg::MultiIndex<2> or any key whose first 2 indices are obtained with @c key[d] or @c std::get<d>(key).
+  class BlockCyclic2DKeymap {
+   public:
+    /// @param P the number of process rows
+    /// @param Q the number of process columns
+    /// @param mb the number of consecutive rows mapped to the same process row
+    /// @param nb the number of consecutive columns mapped to the same process column
+    BlockCyclic2DKeymap(int P, int Q, int mb = 1, int nb = 1) : P_(P), Q_(Q), mb_(mb), nb_(nb) {
+      assert(P > 0 && Q > 0 && mb > 0 && nb > 0);
+    }
+
+    /// distributes over the closest to square grid of @p nproc processes, see process_grid_2d()
+    explicit BlockCyclic2DKeymap(int nproc)
+        : BlockCyclic2DKeymap(process_grid_2d(nproc).first, process_grid_2d(nproc).second) {}
+
+    /// @return the process that owns block {i,j}
+    int rank_of(std::int64_t i, std::int64_t j) const {
+      return detail::nonnegative_mod(i / mb_, P_) + detail::nonnegative_mod(j / nb_, Q_) * P_;
+    }
+
+    template <typename Key>
+    int operator()(const Key &key) const {
+      return rank_of(detail::key_index<0>(key), detail::key_index<1>(key));
+    }
+
+    int P() const { return P_; }
+    int Q() const { return Q_; }
+
+   private:
+    int P_, Q_, mb_, nb_;
+  };
+
+  /// Distribution of the keys {i,j,k} over a P×Q×R grid of processes: each of the R layers of the grid holds a 2-d
+  /// cyclic distribution of the {i,j} plane, and the keys are assigned to the layers cyclically in k. E.g. in a
+  /// 2.5-d/3-d matrix multiplication the task {i,j,k} runs on layer k%R and each layer accumulates a partial C.
+  class ProcessGrid3DKeymap {
+   public:
+    /// @param P the number of process rows of each layer
+    /// @param Q the number of process columns of each layer
+    /// @param R the number of layers (replication factor)
+    ProcessGrid3DKeymap(int P, int Q, int R) : P_(P), Q_(Q), R_(R) { assert(P > 0 && Q > 0 && R > 0); }
+
+    /// @return the process that owns {i,j} in layer @p layer
+    int rank_of(std::int64_t i, std::int64_t j, int layer) const {
+      return detail::nonnegative_mod(i, P_) + detail::nonnegative_mod(j, Q_) * P_ + layer * P_ * Q_;
+    }
+
+    /// @return the layer of the keys with third index @p k
+    int layer_of(std::int64_t k) const { return detail::nonnegative_mod(k, R_); }
+
+    template <typename Key>
+    int operator()(const Key &key) const {
+      return rank_of(detail::key_index<0>(key), detail::key_index<1>(key), layer_of(detail::key_index<2>(key)));
+    }
+
+    /// @return the keymap of the {i,j} plane of @p layer, e.g. for the 2-d data replicated in each layer
+    auto layer_keymap(int layer) const {
+      return [P = P_, Q = Q_, offset = layer * P_ * Q_](const auto &key) {
+        return detail::nonnegative_mod(detail::key_index<0>(key), P) +
+               detail::nonnegative_mod(detail::key_index<1>(key), Q) * P + offset;
+      };
+    }
+
+    int P() const { return P_; }
+    int Q() const { return Q_; }
+    int R() const { return R_; }
+
+   private:
+    int P_, Q_, R_;
+  };
+
+  /// Space-filling-curve partitioning of the keys of a Rank-dimensional box @c [0,extents[0])×...: the keys are ordered
+  /// along the Z-order (Morton) curve and the curve is cut into @c nproc contiguous pieces of equal numbers of keys,
+  /// so that each process owns a compact region of the box. Boxes whose extents are not powers of 2 are handled
+  /// exactly, by counting only the keys inside the box.
+  /// @tparam Rank the number of indices of the keys, 1 to 3
+  template <std::size_t Rank>
+  class ZOrderKeymap {
+    static_assert(Rank >= 1 && Rank <= 3, "ZOrderKeymap: only implemented for Rank={1,2,3}");
+
+   public:
+    /// @param nproc the number of processes
+    /// @param extents the number of keys along each dimension
+    ZOrderKeymap(int nproc, const std::array<std::int64_t, Rank> &extents) : nproc_(nproc), extents_(extents) {
+      assert(nproc > 0);
+      std::int64_t max_extent = 1;
+      total_ = 1;
+      for (auto e : extents) {
+        assert(e > 0);
+        max_extent = std::max(max_extent, e);
+        total_ *= e;
+      }
+      while ((std::int64_t{1} << bits_) < max_extent) ++bits_;
+      chunk_ = (total_ + nproc - 1) / nproc;
+    }
+
+    /// @return the position of the key with indices @p idx along the Z-order curve restricted to the box
+    std::int64_t curve_index(const std::array<std::int64_t, Rank> &idx) const {
+      std::int64_t result = 0;
+      std::array<std::int64_t, Rank> origin{};
+      for (int b = bits_ - 1; b >= 0; --b) {
+        // the children of the current cube, of side 2^b, are visited in the order of their Morton digit;
+        // count the keys in the children that precede the one containing idx
+        std::size_t digit = 0;
+        for (std::size_t d = 0; d < Rank; ++d) digit |= static_cast<std::size_t>((idx[d] >> b) & 1) << d;
+        for (std::size_t child = 0; child < digit; ++child) {
+          std::int64_t count = 1;
+          for (std::size_t d = 0; d < Rank && count > 0; ++d) {
+            const auto lo = origin[d] + (static_cast<std::int64_t>((child >> d) & 1) << b);
+            count *= std::clamp<std::int64_t>(extents_[d] - lo, 0, std::int64_t{1} << b);
+          }
+          result += count;
+        }
+        for (std::size_t d = 0; d < Rank; ++d) origin[d] += static_cast<std::int64_t>((digit >> d) & 1) << b;
+      }
+      return result;
+    }
+
+    template <typename Key>
+    int operator()(const Key &key) const {
+      std::array<std::int64_t, Rank> idx;
+      fill_indices(key, idx, std::make_index_sequence<Rank>{});
+      for (std::size_t d = 0; d < Rank; ++d) assert(idx[d] >= 0 && idx[d] < extents_[d]);
+      return static_cast<int>(curve_index(idx) / chunk_);
+    }
+
+   private:
+    template <typename Key, std::size_t... Ds>
+    static void fill_indices(const Key &key, std::array<std::int64_t, Rank> &idx, std::index_sequence<Ds...>) {
+      ((idx[Ds] = detail::key_index<Ds>(key)), ...);
+    }
+
+    int nproc_;
+    std::array<std::int64_t, Rank> extents_;
+    std::int64_t total_ = 1;
+    std::int64_t chunk_ = 1;
+    int bits_ = 0;
+  };
+
+  /// Describes the keys of tree nodes to the tree keymaps. The default requires @c key.level(), the level of the
+  /// node (0 = root), and @c key.parent(n), the key of its ancestor @c n levels up, as provided e.g. by the
+  /// MADNESS keys; specialize for other key types.
+  template <typename Key, typename Enabler = void>
+  struct tree_key_traits {
+    static int level(const Key &key) { return static_cast<int>(key.level()); }
+    static Key ancestor(const Key &key, int generations) { return key.parent(generations); }
+  };
+
+  /// Maps the nodes of a tree so that each subtree rooted at level @c target_level resides on one process: the
+  /// nodes down to @c target_level are distributed by hashing, the deeper nodes are colocated with their
+  /// ancestor at @c target_level. Suits algorithms that traverse subtrees independently, e.g. projection or
+  /// compression of adaptive functions.
+  template <typename Key>
+  class SubtreeKeymap {
+   public:
+    /// @param nproc the number of processes
+    /// @param fanout the number of children of a node, e.g. 2^NDIM for a NDIM-dimensional tree
+    /// @param target_level the level of the distributed subtrees; if 0, the smallest level with at least as many
+    ///        nodes as processes
+    SubtreeKeymap(int nproc, int fanout, int target_level = 0) : nproc_(nproc), target_level_(target_level) {
+      assert(nproc > 0 && fanout > 1);
+      if (target_level_ <= 0) {
+        target_level_ = 1;
+        for (std::int64_t n = fanout; n < nproc; n *= fanout) ++target_level_;
+      }
+    }
+
+    int operator()(const Key &key) const {
+      using traits = tree_key_traits<Key>;
+      const auto n = traits::level(key);
+      if (n <= target_level_) return static_cast<int>(ttg::hash<Key>{}(key) % nproc_);
+      return static_cast<int>(ttg::hash<Key>{}(traits::ancestor(key, n - target_level_)) % nproc_);
+    }
+
+    int target_level() const { return target_level_; }
+
+   private:
+    int nproc_;
+    int target_level_;
+  };
+
+  /// Maps the nodes of a tree so that the children are colocated with their parent in groups of @c group_size
+  /// levels below @c min_level: the node at level @c n>min_level is mapped with its ancestor at level
+  /// @c n-(n-min_level)%group_size. The nodes down to @c min_level, and the heads of the groups, are distributed by
+  /// hashing, so the load stays balanced while the messages from a child to its parent stay mostly local.
+  /// The root is on process 0. With @c min_level=3 and @c group_size=2 even-level nodes are colocated with their parents.
+  template <typename Key>
+  class ParentColocatingKeymap {
+   public:
+    /// @param nproc the number of processes
+    /// @param min_level the deepest level whose nodes are all distributed by hashing
+    /// @param group_size the number of consecutive levels colocated with their head
+    ParentColocatingKeymap(int nproc, int min_level = 3, int group_size = 2)
+        : nproc_(nproc), min_level_(min_level), group_size_(group_size) {
+      assert(nproc > 0 && min_level >= 0 && group_size > 0);
+    }
+
+    int operator()(const Key &key) const {
+      using traits = tree_key_traits<Key>;
+      const auto n = traits::level(key);
+      if (n == 0) return 0;
+      const auto generations = n <= min_level_ ? 0 : (n - min_level_) % group_size_;
+      if (generations == 0) return static_cast<int>(ttg::hash<Key>{}(key) % nproc_);
+      return static_cast<int>(ttg::hash<Key>{}(traits::ancestor(key, generations)) % nproc_);
+    }
+
+   private:
+    int nproc_;
+    int min_level_;
+    int group_size_;
+  };
+
+}  // namespace ttg
+
+#endif  // TTG_KEYMAPS_H
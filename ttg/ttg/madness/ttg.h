@@ -16,16 +16,23 @@
 #include "ttg/runtimes.h"
 #include "ttg/tt.h"
 #include "ttg/util/bug.h"
+#include "ttg/util/dense_table.h"
 #include "ttg/util/env.h"
 #include "ttg/util/hash.h"
 #include "ttg/util/macro.h"
+#include "ttg/util/memory_budget.h"
 #include "ttg/util/meta.h"
 #include "ttg/util/meta/callable.h"
+#include "ttg/util/slab_allocator.h"
+#include "ttg/util/stream_accumulator.h"
+#include "ttg/util/task_batch.h"
 #include "ttg/util/void.h"
 #include "ttg/world.h"
 
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <cstdint>
 #include <functional>
 #include <future>
 #include <iostream>
@@ -33,6 +40,7 @@
 #include <memory>
 #include <string>
 #include <tuple>
+#include <typeinfo>
 #include <vector>
 
 #include <madness/world/MADworld.h>
@@ -90,6 +98,10 @@ namespace ttg_madness {
 
     virtual void fence_impl(void) override { m_impl.gop.fence(); }
 
+    virtual void allreduce_or(std::vector<int> &flags) override {
+      MPI_Allreduce(MPI_IN_PLACE, flags.data(), static_cast<int>(flags.size()), MPI_INT, MPI_LOR, comm());
+    }
+
     ttg::Edge<> &ctl_edge() { return m_ctl_edge; }
 
     const ttg::Edge<> &ctl_edge() const { return m_ctl_edge; }
@@ -111,6 +123,8 @@ namespace ttg_madness {
 
     const ::madness::World &impl() const { return m_impl; }
 
+    MPI_Comm comm() const { return m_impl.mpi.Get_mpi_comm(); }
+
 #ifdef ENABLE_PARSEC
     parsec_context_t *context() { return ::madness::ThreadPool::instance()->parsec; }
 #endif
@@ -168,6 +182,210 @@ namespace ttg_madness {
     world.impl().impl().gop.broadcast_serializable(data, source_rank);
   }
 
+  namespace detail {
+    /// @return reference to the number of TT tasks nested on this thread (0 if this thread is not executing a task)
+    inline std::size_t &thread_task_depth() {
+      static thread_local std::size_t depth = 0;
+      return depth;
+    }
+
+    /// Refers to the key of a task, whatever its type
+    struct task_key_ref {
+      const void *key = nullptr;
+      const void *type = nullptr;  //!< see ttg::meta::type_id
+
+      task_key_ref() = default;
+      template <typename Key>
+      explicit task_key_ref(const Key &key) : key(&key), type(ttg::meta::type_id<Key>()) {}
+
+      /// @return true if the key has type @c Key and is equal to @p other
+      template <typename Key>
+      bool equals(const Key &other) const {
+        return type == ttg::meta::type_id<Key>() && *static_cast<const Key *>(key) == other;
+      }
+    };
+
+    /// @return reference to the key of the innermost TT task executing on this thread
+    inline task_key_ref &thread_task_key() {
+      static thread_local task_key_ref key;
+      return key;
+    }
+
+    /// Holds a value read (i.e., taken as a const input) by a local task, possibly shared with other readers
+    template <typename T>
+    class shared_value {
+     public:
+      shared_value() = default;
+      explicit shared_value(std::shared_ptr<const T> ptr) : ptr_(std::move(ptr)) {}
+
+      const T &operator*() const { return *ptr_; }
+      const std::shared_ptr<const T> &ptr() const { return ptr_; }
+
+      /// @return reference to the value, copied first if shared with other readers
+      /// @note used by stream reducers, which accumulate into the value
+      T &mutate() {
+        if (ptr_.use_count() > 1) ptr_ = std::make_shared<T>(*ptr_);
+        // N.B. the value was created by make_shared<T>, i.e. is not const
+        return const_cast<T &>(*ptr_);
+      }
+
+     private:
+      std::shared_ptr<const T> ptr_;
+    };
+
+    /// The values on this thread that local readers can share instead of copying: the const inputs of the tasks
+    /// executing on this thread, and the copies made for the readers of a value being sent
+    class shared_values {
+     public:
+      static shared_values &instance() {
+        static thread_local shared_values values;
+        return values;
+      }
+
+      /// @return the value shared for the object of type @p T at @p addr, null if none
+      template <typename T>
+      std::shared_ptr<const T> find(const T *addr) const {
+        for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+          if (it->addr == addr && *it->type == typeid(T)) return std::static_pointer_cast<const T>(it->ptr);
+        }
+        return {};
+      }
+
+      /// shares @p ptr with the readers of the object of type @p T at @p addr
+      template <typename T>
+      void add(const T *addr, const std::shared_ptr<const T> &ptr) {
+        entries.push_back({addr, &typeid(T), ptr});
+      }
+
+      /// @return true if copies of sent values can be shared, i.e. within a send_scope
+      bool can_share_copies() const { return num_send_scopes > 0; }
+
+     private:
+      friend class send_scope;
+      friend class task_scope;
+
+      struct entry {
+        const void *addr;
+        const std::type_info *type;
+        std::shared_ptr<const void> ptr;
+      };
+      std::vector<entry> entries;
+      std::size_t num_send_scopes = 0;
+
+      void truncate(std::size_t size) { entries.erase(entries.begin() + size, entries.end()); }
+    };
+
+    /// Scope of a send or broadcast: the copies made for the local readers of the sent value are shared by all of them
+    /// @note the value must not change within the scope, which is why the scope should only span a single send
+    class send_scope {
+     public:
+      send_scope() : size(shared_values::instance().entries.size()) { ++shared_values::instance().num_send_scopes; }
+      ~send_scope() {
+        auto &values = shared_values::instance();
+        --values.num_send_scopes;
+        values.truncate(size);
+      }
+
+     private:
+      std::size_t size;
+    };
+
+    /// Scope of a task: its const inputs can be shared with the local readers of the values it sends; enclosing send
+    /// scopes are suspended since the locals of the task may occupy the addresses of values sent previously
+    class task_scope {
+     public:
+      task_scope() : size(shared_values::instance().entries.size()) {
+        std::swap(num_send_scopes, shared_values::instance().num_send_scopes);
+      }
+      ~task_scope() {
+        auto &values = shared_values::instance();
+        std::swap(num_send_scopes, values.num_send_scopes);
+        values.truncate(size);
+      }
+
+      template <typename T>
+      void add(const shared_value<T> &value) {
+        if (value.ptr()) shared_values::instance().add(value.ptr().get(), value.ptr());
+      }
+
+      /// inputs that are not read-only are not shared
+      template <typename T>
+      void add(const T &) {}
+
+     private:
+      std::size_t size;
+      std::size_t num_send_scopes = 0;
+    };
+
+    /// @return @p value held for a local reader, shared with the other readers if possible; the copies it creates
+    ///         are counted in @p counters
+    template <typename T, typename Value>
+    shared_value<T> make_shared_value(Value &&value, ttg::detail::tt_counter_slots &counters) {
+      auto &values = shared_values::instance();
+      auto ptr = values.find<T>(&value);
+      if (!ptr) {
+        counters.add(ttg::detail::tt_counter_slots::data_copies_created);
+        if constexpr (std::is_rvalue_reference_v<Value &&> && !std::is_const_v<std::remove_reference_t<Value>>) {
+          ptr = std::make_shared<T>(std::move(value));  // no other reader can refer to an rvalue
+        } else {
+          ptr = std::make_shared<T>(value);
+          counters.add(ttg::detail::tt_counter_slots::data_copies_deep_copied);
+          if (values.can_share_copies()) values.add<T>(&value, ptr);
+        }
+      }
+      return shared_value<T>(std::move(ptr));
+    }
+
+    /// the type of the storage of an input of type @p T: read-only inputs are held through shared_value
+    template <typename T>
+    using input_storage_t = std::conditional_t<std::is_const_v<T>, shared_value<std::remove_const_t<T>>, T>;
+
+    template <typename Tuple>
+    struct input_storage_tuple;
+
+    template <typename... Ts>
+    struct input_storage_tuple<std::tuple<Ts...>> {
+      using type = std::tuple<input_storage_t<Ts>...>;
+    };
+
+    template <typename Tuple>
+    using input_storage_tuple_t = typename input_storage_tuple<Tuple>::type;
+
+    template <typename T>
+    T &input_value(T &value) {
+      return value;
+    }
+
+    template <typename T>
+    const T &input_value(shared_value<T> &value) {
+      return *value;
+    }
+
+    template <typename T>
+    T &mutable_input_value(T &value) {
+      return value;
+    }
+
+    template <typename T>
+    T &mutable_input_value(shared_value<T> &value) {
+      return value.mutate();
+    }
+
+    /// stores @p value in the input @p storage of a task; the copies it creates are counted in @p counters
+    template <typename T, typename Value>
+    void assign_input_value(T &storage, Value &&value, ttg::detail::tt_counter_slots &counters) {
+      counters.add(ttg::detail::tt_counter_slots::data_copies_created);
+      if constexpr (!std::is_rvalue_reference_v<Value &&> || std::is_const_v<std::remove_reference_t<Value>>)
+        counters.add(ttg::detail::tt_counter_slots::data_copies_deep_copied);
+      storage = std::forward<Value>(value);
+    }
+
+    template <typename T, typename Value>
+    void assign_input_value(shared_value<T> &storage, Value &&value, ttg::detail::tt_counter_slots &counters) {
+      storage = make_shared_value<T>(std::forward<Value>(value), counters);
+    }
+  }  // namespace detail
+
   /// CRTP base for MADNESS-based TT classes
   /// \tparam keyT a Key type
   /// \tparam output_terminalsT
@@ -200,6 +418,32 @@ namespace ttg_madness {
     int num_pullins = 0;
 
     std::array<std::size_t, std::tuple_size_v<actual_input_tuple_type>> static_streamsize;
+    std::array<ttg::ReduceMode, std::tuple_size_v<actual_input_tuple_type>>
+        input_reduce_modes = {};  //!< how the streaming inputs are reduced, see set_input_reduce_mode
+    std::array<bool, std::tuple_size_v<actual_input_tuple_type>>
+        auto_finalize_streams = {};  //!< the streaming inputs finalized by the runtime, see set_argstream_auto_finalize
+
+    /// evaluates the keymap: the keymap bound by derivedT if it has bound maps (see ttg::bind_maps), else keymap
+    /// @return the rank of the process that executes the task with key @p key (no argument for void keys)
+    template <typename... Key>
+    int owner_of(const Key &...key) const {
+      if constexpr (ttg::detail::derived_has_bound_maps<derivedT>()) {
+        return static_cast<const derivedT *>(this)->keymap_impl(key...);
+      } else {
+        return keymap(key...);
+      }
+    }
+
+    /// evaluates the priomap: the priomap bound by derivedT if it has bound maps (see ttg::bind_maps), else priomap
+    /// @return the priority of the task with key @p key (no argument for void keys)
+    template <typename... Key>
+    int priority_of(const Key &...key) const {
+      if constexpr (ttg::detail::derived_has_bound_maps<derivedT>()) {
+        return static_cast<const derivedT *>(this)->priomap_impl(key...);
+      } else {
+        return priomap(key...);
+      }
+    }
 
    public:
     ttg::World get_world() const { return world; }
@@ -234,6 +478,8 @@ namespace ttg_madness {
     using input_values_tuple_type = ttg::meta::drop_void_t<ttg::meta::decayed_typelist_t<input_tuple_type>>;
     using input_refs_tuple_type = ttg::meta::drop_void_t<ttg::meta::add_glvalue_reference_tuple_t<input_tuple_type>>;
     static_assert(!ttg::meta::is_any_void_v<input_values_tuple_type>);
+    /// the storage of the input values of a task, read-only inputs are shared with other local readers
+    using input_storage_tuple_type = detail::input_storage_tuple_t<ttg::meta::drop_void_t<input_tuple_type>>;
 
     using output_terminals_type = output_terminalsT;
     using output_edges_type = typename ttg::terminals_to_edges<output_terminalsT>::type;
@@ -256,11 +502,15 @@ namespace ttg_madness {
     const auto &get_output_terminals() const { return output_terminals; }
 
    private:
-    struct TTArgs : ::madness::TaskInterface {
+    /// allocated from the per-thread slab pool of its size class; deleted by the task queue via TaskInterface*
+    struct TTArgs : ::madness::TaskInterface, ttg::detail::slab_allocated<TTArgs> {
      private:
       using TaskInterface = ::madness::TaskInterface;
 
      public:
+      using ttg::detail::slab_allocated<TTArgs>::operator new;
+      using ttg::detail::slab_allocated<TTArgs>::operator delete;
+
       int counter;  // Tracks the number of arguments finalized
       std::array<std::int64_t, numins>
           nargs;  // Tracks the number of expected values minus the number of received values
@@ -269,16 +519,24 @@ namespace ttg_madness {
                   // which indicates that the value needs to be initialized
       std::array<std::size_t, numins> stream_size;  // Expected number of values to receive, to be used for streaming
                                                     // inputs (0 = unbounded stream, >0 = bounded stream)
-      input_values_tuple_type input_values;         // The input values (does not include control)
+      input_storage_tuple_type input_values;        // The input values (does not include control)
+      ttg::detail::stream_accumulators_t<input_values_full_tuple_type>
+          accumulators;  // Accumulators of the streaming inputs that are not reduced under the lock
       derivedT *derived;                            // Pointer to derived class instance
       bool pull_terminals_invoked = false;
       std::conditional_t<ttg::meta::is_void_v<keyT>, ttg::Void, keyT> key;  // Task key
+      ttg::detail::budget_charge charge;  // The usage of the memory budgets, released when the task is deleted
 
       /// makes a tuple of references out of tuple of
       template <typename Tuple, std::size_t... Is>
       static input_refs_tuple_type make_input_refs_impl(Tuple &&inputs, std::index_sequence<Is...>) {
-        return input_refs_tuple_type{
-            get<Is, std::tuple_element_t<Is, input_refs_tuple_type>>(std::forward<Tuple>(inputs))...};
+        return input_refs_tuple_type{static_cast<std::tuple_element_t<Is, input_refs_tuple_type>>(
+            detail::input_value(std::get<Is>(std::forward<Tuple>(inputs))))...};
+      }
+
+      /// shares the read-only inputs with the local readers of the values sent by this task
+      void share_inputs(detail::task_scope &scope) {
+        std::apply([&scope](auto &...values) { (scope.add(values), ...); }, input_values);
       }
 
       /// makes a tuple of references out of input_values
@@ -287,8 +545,11 @@ namespace ttg_madness {
                                     std::make_index_sequence<std::tuple_size_v<input_values_tuple_type>>{});
       }
 
+      int priority;  // The priority of the task, as given by priomap
+
       TTArgs(int prio = 0)
-          : TaskInterface(TaskAttributes(prio ? TaskAttributes::HIGHPRIORITY : 0))
+          : TaskInterface(TaskAttributes(prio > 0 ? TaskAttributes::HIGHPRIORITY : 0))
+          , priority(prio)
           , counter(numins)
           , nargs()
           , stream_size()
@@ -299,24 +560,42 @@ namespace ttg_madness {
       virtual void run(::madness::World &world) override {
         // ttg::print("starting task");
 
-        using ttg::hash;
-        ttT::threaddata.key_hash = hash<decltype(key)>{}(key);
-        ttT::threaddata.call_depth++;
-
-        if constexpr (!ttg::meta::is_void_v<keyT> && !ttg::meta::is_empty_tuple_v<input_values_tuple_type>) {
-          derived->op(key, this->make_input_refs(),
-                      derived->output_terminals);  // !!! NOTE converting input values to refs
-        } else if constexpr (!ttg::meta::is_void_v<keyT> && ttg::meta::is_empty_tuple_v<input_values_tuple_type>) {
-          derived->op(key, derived->output_terminals);
-        } else if constexpr (ttg::meta::is_void_v<keyT> && !ttg::meta::is_empty_tuple_v<input_values_tuple_type>) {
-          derived->op(this->make_input_refs(),
-                      derived->output_terminals);  // !!! NOTE converting input values to refs
-        } else if constexpr (ttg::meta::is_void_v<keyT> && ttg::meta::is_empty_tuple_v<input_values_tuple_type>) {
-          derived->op(derived->output_terminals);
-        } else
-          abort();
-
-        ttT::threaddata.call_depth--;
+        if constexpr (ttg::detail::derived_has_batch_op<derivedT>()) {
+          static_cast<ttT *>(derived)->execute_batch(this);
+        } else {
+          using ttg::hash;
+          ttT::threaddata.key_hash = hash<decltype(key)>{}(key);
+          ttT::threaddata.call_depth++;
+          detail::thread_task_depth()++;
+          const auto thread_key_save = detail::thread_task_key();
+          detail::thread_task_key() = detail::task_key_ref(key);
+          detail::task_scope scope;
+          share_inputs(scope);
+          ttg::detail::notify_task_observers(key, [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+            o.task_started(*derived, k);
+          });
+
+          if constexpr (!ttg::meta::is_void_v<keyT> && !ttg::meta::is_empty_tuple_v<input_values_tuple_type>) {
+            derived->op(key, this->make_input_refs(),
+                        derived->output_terminals);  // !!! NOTE converting input values to refs
+          } else if constexpr (!ttg::meta::is_void_v<keyT> && ttg::meta::is_empty_tuple_v<input_values_tuple_type>) {
+            derived->op(key, derived->output_terminals);
+          } else if constexpr (ttg::meta::is_void_v<keyT> && !ttg::meta::is_empty_tuple_v<input_values_tuple_type>) {
+            derived->op(this->make_input_refs(),
+                        derived->output_terminals);  // !!! NOTE converting input values to refs
+          } else if constexpr (ttg::meta::is_void_v<keyT> && ttg::meta::is_empty_tuple_v<input_values_tuple_type>) {
+            derived->op(derived->output_terminals);
+          } else
+            abort();
+          ttg::detail::notify_task_observers(key, [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+            o.task_finished(*derived, k);
+          });
+
+          detail::thread_task_key() = thread_key_save;
+          detail::thread_task_depth()--;
+          ttT::threaddata.call_depth--;
+          static_cast<ttT *>(derived)->counters().add(ttg::detail::tt_counter_slots::tasks_executed);
+        }
 
         // ttg::print("finishing task",ttT::threaddata.call_depth);
       }
@@ -334,6 +613,367 @@ namespace ttg_madness {
     using cacheT = ::madness::ConcurrentHashMap<hashable_keyT, TTArgs *, ttg::hash<hashable_keyT>>;
     using accessorT = typename cacheT::accessor;
     cacheT cache;
+    using dense_cacheT = ttg::detail::dense_table<TTArgs>;
+    std::unique_ptr<dense_cacheT> dense_cache;  //!< if set (see set_key_domain()) replaces cache
+    std::function<std::size_t(const hashable_keyT &)> key_linearizer;
+    ttg::detail::ready_batch_queue<TTArgs> ready_batch;  //!< the ready tasks, if derivedT has a batched op
+
+    /// @return a new task with key @p key and priority @p prio, charged to the memory budgets of this TT and of the
+    ///         world
+    template <typename Key>
+    TTArgs *new_task(const Key &key, int prio = 0) {
+      auto *args = new TTArgs(prio);  // It will be deleted by the task q
+      args->charge = ttg::detail::budget_charge(&this->memory_budget(), &world.impl().budget());
+      this->counters().add(ttg::detail::tt_counter_slots::tasks_created);
+      ttg::detail::notify_task_observers(key, [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+        o.task_created(*this, k);
+      });
+      return args;
+    }
+
+    /// defers the calling producer while the memory budget of this TT or of the world is exceeded, see
+    /// TTBase::set_max_pending_tasks
+    void throttle() { ttg::detail::throttle(this->memory_budget(), world.impl().budget()); }
+
+    /// hands the ready task @p args to the task queue; if derivedT has a batched op (see
+    /// ttg::detail::derived_has_batch_op) the task is queued in ready_batch, only its leader goes to the task queue
+    void submit_task(TTArgs *args) {
+      if constexpr (ttg::detail::derived_has_batch_op<derivedT>()) {
+        if (!ready_batch.push(args)) return;  // executed in the batch of the leader
+      }
+      world.impl().impl().taskq.add(args);
+    }
+
+    /// executes the batch of ready tasks led by @p leader with derivedT::op_batch, then deletes the tasks of the batch
+    /// other than the leader, which is owned by the task queue
+    void execute_batch(TTArgs *leader) {
+      static_assert(!ttg::meta::is_void_v<keyT>, "TT: op_batch requires a non-void key type");
+      std::vector<TTArgs *> batch;
+      auto *next_leader = ready_batch.pop(batch, this->get_max_batch_size(), this->get_batch_linger());
+      assert(batch.front() == leader);
+      if (next_leader) world.impl().impl().taskq.add(next_leader);
+      ttg::trace(world.rank(), ":", get_name(), " : executing a batch of ", batch.size(), " tasks");
+
+      std::vector<keyT> keys;
+      keys.reserve(batch.size());
+      for (auto *args : batch) keys.push_back(args->key);
+      const ttg::span<const keyT> keys_span(keys.data(), keys.size());
+      // the batch executes as its leader, e.g. the tasks fused into it (see executes_fused) have the key of the leader
+      ttT::threaddata.key_hash = ttg::hash<keyT>{}(leader->key);
+      ttT::threaddata.call_depth++;
+      detail::thread_task_depth()++;
+      const auto thread_key_save = detail::thread_task_key();
+      detail::thread_task_key() = detail::task_key_ref(leader->key);
+      {
+        detail::task_scope scope;
+        for (auto *args : batch) args->share_inputs(scope);
+        for (auto &&key : keys)
+          ttg::detail::notify_task_observers(key, [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+            o.task_started(*this, k);
+          });
+        if constexpr (!ttg::meta::is_empty_tuple_v<input_values_tuple_type>) {
+          std::vector<input_refs_tuple_type> inputs;
+          inputs.reserve(batch.size());
+          for (auto *args : batch) inputs.emplace_back(args->make_input_refs());
+          static_cast<derivedT *>(this)->op_batch(
+              keys_span, ttg::span<input_refs_tuple_type>(inputs.data(), inputs.size()), output_terminals);
+        } else {
+          static_cast<derivedT *>(this)->op_batch(keys_span, output_terminals);
+        }
+        // in the reverse order of the starts, so that the tasks of the batch nest on this thread
+        for (auto key = keys.rbegin(); key != keys.rend(); ++key)
+          ttg::detail::notify_task_observers(*key, [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+            o.task_finished(*this, k);
+          });
+      }
+      detail::thread_task_key() = thread_key_save;
+      detail::thread_task_depth()--;
+      ttT::threaddata.call_depth--;
+      this->counters().add(ttg::detail::tt_counter_slots::tasks_executed, batch.size());
+      for (std::size_t b = 1; b < batch.size(); ++b) delete batch[b];  // not owned by the task queue
+    }
+
+    /// @return true if the task with key @p key, which is local, is executed by the task executing on this thread,
+    ///         see TTBase::set_fused
+    bool executes_fused(const keyT &key) const {
+      if (!this->is_fused() || std::get<0>(input_reducers) || num_pullins > 0) return false;
+      const auto depth = detail::thread_task_depth();
+      return depth > 0 && depth < static_cast<std::size_t>(this->get_max_inline_depth()) &&
+             detail::thread_task_key().equals(key);
+    }
+
+    /// executes the task with key @p key and input @p value immediately, without creating it, see TTBase::set_fused
+    template <typename Value>
+    void execute_fused(const keyT &key, Value &&value) {
+      ttg::trace(world.rank(), ":", get_name(), " : ", key, ": executing fused task");
+      ttT::threaddata.call_depth++;
+      detail::thread_task_depth()++;
+      {
+        // suspends the enclosing send scopes, the locals of op may occupy the addresses of the values they share
+        detail::task_scope scope;
+        ttg::detail::notify_task_observers(key, [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+          o.task_started(*this, k);
+        });
+        if constexpr (!ttg::meta::is_empty_tuple_v<input_values_tuple_type>) {
+          using input_ref_type = std::tuple_element_t<0, input_refs_tuple_type>;
+          constexpr bool can_bind_value = std::is_const_v<std::remove_reference_t<input_ref_type>> ||
+                                          (std::is_rvalue_reference_v<Value &&> &&
+                                           !std::is_const_v<std::remove_reference_t<Value>>);
+          if constexpr (can_bind_value) {
+            static_cast<derivedT *>(this)->op(key, input_refs_tuple_type{value}, output_terminals);
+          } else {
+            std::decay_t<Value> copy(value);  // the task consumes its input
+            static_cast<derivedT *>(this)->op(key, input_refs_tuple_type{copy}, output_terminals);
+          }
+        } else {
+          static_cast<derivedT *>(this)->op(key, output_terminals);
+        }
+        ttg::detail::notify_task_observers(key, [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+          o.task_finished(*this, k);
+        });
+      }
+      detail::thread_task_depth()--;
+      ttT::threaddata.call_depth--;
+      // counted as created, like its input is counted by set_arg_local
+      this->counters().add(ttg::detail::tt_counter_slots::tasks_created);
+      this->counters().add(ttg::detail::tt_counter_slots::tasks_executed);
+      this->counters().add(ttg::detail::tt_counter_slots::tasks_inlined);
+    }
+
+    /// Accessor to an entry of the pending task cache, i.e. of dense_cache if set or of cache otherwise;
+    /// holds the lock of the entry until it is destroyed or the entry is erased
+    class cache_accessor {
+      friend ttT;
+      accessorT hash_acc;
+      dense_cacheT *table = nullptr;
+      std::size_t idx = 0;
+
+     public:
+      cache_accessor() = default;
+      cache_accessor(const cache_accessor &) = delete;
+      cache_accessor &operator=(const cache_accessor &) = delete;
+      ~cache_accessor() {
+        if (table) table->unlock(idx);
+      }
+
+      TTArgs *get() { return table ? table->get(idx) : hash_acc->second; }
+      void set(TTArgs *args) {
+        if (table)
+          table->set(idx, args);
+        else
+          hash_acc->second = args;
+      }
+    };
+
+    /// @return the index of @p key in dense_cache
+    std::size_t dense_cache_index(const hashable_keyT &key) const {
+      const auto idx = key_linearizer(key);
+      if (idx >= dense_cache->extent()) {
+        ttg::print_error(world.rank(), ":", get_name(), " : ", key, ": key is outside of the key domain, index ", idx,
+                         " >= ", dense_cache->extent());
+        throw std::out_of_range("TT: key is outside of the domain declared by set_key_domain");
+      }
+      return idx;
+    }
+
+    /// finds or creates the cache entry for @p key and locks it
+    /// @return true if the entry was created, in which case its value must be set
+    bool cache_insert(cache_accessor &acc, const hashable_keyT &key) {
+      if (dense_cache) {
+        acc.idx = dense_cache_index(key);
+        acc.table = dense_cache.get();
+        acc.table->lock(acc.idx);
+        return nullptr == acc.table->get(acc.idx);
+      }
+      return cache.insert(acc.hash_acc, key);
+    }
+
+    /// finds the cache entry for @p key and locks it
+    /// @return true if the entry was found, otherwise @p acc holds no lock
+    bool cache_find(cache_accessor &acc, const hashable_keyT &key) {
+      if (dense_cache) {
+        const auto idx = dense_cache_index(key);
+        dense_cache->lock(idx);
+        if (nullptr == dense_cache->get(idx)) {
+          dense_cache->unlock(idx);
+          return false;
+        }
+        acc.idx = idx;
+        acc.table = dense_cache.get();
+        return true;
+      }
+      return cache.find(acc.hash_acc, key);
+    }
+
+    /// erases the cache entry held by @p acc and releases its lock
+    void cache_erase(cache_accessor &acc) {
+      if (acc.table) {
+        acc.table->set(acc.idx, nullptr);
+        acc.table->unlock(acc.idx);
+        acc.table = nullptr;
+      } else {
+        cache.erase(acc.hash_acc);
+      }
+    }
+
+    /// releases the lock of the cache entry held by @p acc, the entry remains in the cache
+    void cache_release(cache_accessor &acc) {
+      if (acc.table) {
+        acc.table->unlock(acc.idx);
+        acc.table = nullptr;
+      } else {
+        acc.hash_acc.release();
+      }
+    }
+
+    /// @return the number of pending tasks
+    std::size_t cache_size() const { return dense_cache ? dense_cache->size() : cache.size(); }
+
+    /// moves the value reduced by the accumulator of streaming input @p i into the input of @p args and destroys
+    /// the accumulator; the stream must be complete, with no reductions in flight
+    template <std::size_t i>
+    void take_reduced_value(TTArgs *args) {
+      auto &accumulator = std::get<i>(args->accumulators);
+      if constexpr (i < std::tuple_size_v<input_values_tuple_type>) {
+        if (accumulator->has_value())
+          detail::assign_input_value(std::get<i>(args->input_values), accumulator->take(std::get<i>(input_reducers)),
+                                     this->counters());
+      }
+      accumulator.reset();
+    }
+
+    /// completes streaming input @p i of @p args, to be called once the expected number of values was received
+    /// @return false if values of the input are still being reduced, in which case the last of these reductions
+    ///         completes the input (see set_arg)
+    template <std::size_t i>
+    bool complete_stream(TTArgs *args) {
+      auto &accumulator = std::get<i>(args->accumulators);
+      if (!accumulator) return true;
+      if (!accumulator->complete()) return false;
+      take_reduced_value<i>(args);
+      return true;
+    }
+
+    /// upon the first value received by streaming input @p i of @p args initializes the number of expected values;
+    /// the lock of @p args must be held
+    /// @return true if this is the first value
+    template <std::size_t i>
+    bool begin_stream(TTArgs *args) {
+      if (args->nargs[i] != std::numeric_limits<std::int64_t>::max()) return false;
+      // if we have a stream size for the op, use it first
+      if (args->stream_size[i] != 0) {
+        assert(args->stream_size[i] <= static_cast<std::size_t>(std::numeric_limits<std::int64_t>::max()));
+        args->nargs[i] = args->stream_size[i];
+      } else if (static_streamsize[i] != 0) {
+        assert(static_streamsize[i] <= static_cast<std::size_t>(std::numeric_limits<std::int64_t>::max()));
+        args->stream_size[i] = static_streamsize[i];
+        args->nargs[i] = static_streamsize[i];
+      } else {
+        args->nargs[i] = 0;
+      }
+      return true;
+    }
+
+    /// @return true if the values of streaming input @p i are reduced by an accumulator, see set_input_reduce_mode
+    template <std::size_t i>
+    bool reduces_without_lock() const {
+      if constexpr (ttg::meta::is_void_v<std::tuple_element_t<i, input_values_full_tuple_type>>) {
+        return false;  // control inputs are always reduced under the lock
+      } else {
+        return input_reduce_modes[i] != ttg::ReduceMode::Locked;
+      }
+    }
+
+    /// reduces @p value received by streaming input @p i of @p args with its accumulator: the value is counted
+    /// under the locks, which are released by the time the value is reduced
+    /// @param acc the accessor of the cache entry of @p args, holds its lock on entry and on return of true
+    /// @return true if this thread completed the input, i.e. the task must be checked for readiness
+    template <std::size_t i, typename Key, typename Value>
+    bool reduce_without_lock(cache_accessor &acc, const Key &key, TTArgs *args, Value &&value) {
+      using valueT = std::tuple_element_t<i, input_values_full_tuple_type>;
+      if constexpr (!ttg::meta::is_void_v<valueT>) {
+        auto &accumulator = std::get<i>(args->accumulators);
+        args->lock();
+        begin_stream<i>(args);
+        if (!accumulator) {
+          accumulator = std::make_unique<ttg::detail::stream_accumulator<std::decay_t<valueT>>>(input_reduce_modes[i]);
+        }
+        accumulator->begin();
+        // is this the last message?
+        const bool stream_complete = (--args->nargs[i] == 0);
+        args->unlock();
+        cache_release(acc);
+
+        // the task cannot run before the accumulator reports the last reduction, so args remain valid until then
+        accumulator->reduce(std::forward<Value>(value), std::get<i>(input_reducers));
+        this->counters().add(ttg::detail::tt_counter_slots::reducer_calls);
+        bool last = accumulator->end();
+        if (stream_complete && accumulator->complete()) last = true;
+        if (!last) return false;
+
+        take_reduced_value<i>(args);
+        bool found;
+        if constexpr (!ttg::meta::is_void_v<Key>) {
+          found = cache_find(acc, key);
+        } else {
+          found = cache_find(acc, 0);
+        }
+        assert(found && "TT::set_arg: the cache entry of a task with an incomplete input was erased");
+        TTGUNUSED(found);
+        args->counter--;
+        return true;
+      } else {
+        abort();  // control inputs are always reduced under the lock
+      }
+    }
+
+    /// @return true if a streaming input of @p args finalized by the runtime received values but was not bounded,
+    ///         see set_argstream_auto_finalize
+    bool awaits_finalization(const TTArgs *args) const {
+      for (std::size_t i = 0; i < numins; ++i)
+        if (auto_finalize_streams[i] && args->nargs[i] < 0) return true;
+      return false;
+    }
+
+    /// @return the keys of the pending tasks with streams awaiting finalization by the runtime; the world must be
+    ///         quiescent
+    std::vector<hashable_keyT> keys_awaiting_finalization() {
+      std::vector<hashable_keyT> keys;
+      for (auto item : cache) {
+        if (awaits_finalization(item.second)) keys.push_back(item.first);
+      }
+      if constexpr (!ttg::meta::is_void_v<keyT>) {
+        if (dense_cache) {
+          dense_cache->for_each([&](std::size_t idx, TTArgs *args) {
+            if (awaits_finalization(args)) keys.push_back(args->key);
+          });
+        }
+      }
+      return keys;
+    }
+
+    /// finalizes streaming input @p i of the task with key @p key if the runtime finalizes it and it awaits it
+    template <std::size_t i>
+    void finalize_awaiting_stream(const hashable_keyT &key) {
+      if (!auto_finalize_streams[i]) return;
+      bool awaits = false;
+      {
+        cache_accessor acc;
+        if (cache_find(acc, key)) awaits = acc.get()->nargs[i] < 0;
+      }
+      if (!awaits) return;
+      if constexpr (ttg::meta::is_void_v<keyT>) {
+        finalize_argstream<i>();
+      } else {
+        finalize_argstream<i>(key);
+      }
+    }
+
+    /// finalizes the streams awaiting finalization by the runtime, called by the world once it is quiescent
+    template <std::size_t... Is>
+    void finalize_awaiting_streams(std::index_sequence<Is...>) {
+      for (const auto &key : keys_awaiting_finalization()) (finalize_awaiting_stream<Is>(key), ...);
+    }
 
    protected:
     template <typename terminalT, std::size_t i, typename Key>
@@ -358,7 +998,8 @@ namespace ttg_madness {
             }
 
             if (typeid(value) != typeid(std::nullptr_t) && i < std::tuple_size_v<input_values_tuple_type>) {
-              this->get<i, std::decay_t<decltype(value)> &>(args->input_values) = std::forward<decltype(value)>(value);
+              detail::assign_input_value(std::get<i>(args->input_values), std::forward<decltype(value)>(value),
+                                         this->counters());
               args->nargs[i] = 0;
               args->counter--;
             }
@@ -371,7 +1012,8 @@ namespace ttg_madness {
             }
 
             if (typeid(value) != typeid(std::nullptr_t) && i < std::tuple_size_v<input_values_tuple_type>) {
-              this->get<i, std::decay_t<decltype(value)> &>(args->input_values) = std::forward<decltype(value)>(value);
+              detail::assign_input_value(std::get<i>(args->input_values), std::forward<decltype(value)>(value),
+                                         this->counters());
               args->nargs[i] = 0;
               args->counter--;
             }
@@ -388,12 +1030,14 @@ namespace ttg_madness {
         auto &in = std::get<i>(input_terminals);
         if constexpr (!ttg::meta::is_void_v<Key>) {
           auto value = (in.container).get(key);
-          worldobjT::send(keymap(key), &ttT::template set_arg<i, Key, const std::remove_reference_t<decltype(value)> &>,
-                          key, value);
+          worldobjT::send(owner_of(key),
+                          &ttT::template set_arg_from_remote<i, Key, const std::remove_reference_t<decltype(value)> &>,
+                          ttg::detail::next_message_id(world.rank()), key, value);
         } else {
           auto value = (in.container).get();
-          worldobjT::send(keymap(), &ttT::template set_arg<i, void, const std::remove_reference_t<decltype(value)> &>,
-                          value);
+          worldobjT::send(owner_of(),
+                          &ttT::template set_arg_from_remote<i, void, const std::remove_reference_t<decltype(value)> &>,
+                          ttg::detail::next_message_id(world.rank()), value);
         }
       }
     }
@@ -424,9 +1068,9 @@ namespace ttg_madness {
 
       int owner;
       if constexpr (!ttg::meta::is_void_v<Key>) {
-        owner = keymap(key);
+        owner = owner_of(key);
       } else {
-        owner = keymap();
+        owner = owner_of();
       }
 
       if (owner != world.rank()) {
@@ -439,43 +1083,72 @@ namespace ttg_madness {
         // move arguments) and locally
         //      here we know that this will be a remove execution, so we prepare to take rvalues;
         //      send_am will need to separate local and remote paths to deal with this
+        this->counters().add(ttg::detail::tt_counter_slots::set_arg_remote);
+        const auto message = ttg::detail::next_message_id(world.rank());
+        if constexpr (!ttg::meta::is_void_v<Value>) {
+          this->counters().add_bytes_sent(i, ttg::footprint(value));
+          ttg::detail::notify_task_observers(key, [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+            o.message_sent(*this, k, i, owner, ttg::footprint(value), message);
+          });
+        } else {
+          ttg::detail::notify_task_observers(key, [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+            o.message_sent(*this, k, i, owner, 0, message);
+          });
+        }
         if constexpr (!ttg::meta::is_void_v<Key>) {
           if constexpr (!ttg::meta::is_void_v<Value>) {
-            worldobjT::send(owner, &ttT::template set_arg<i, Key, const std::remove_reference_t<Value> &>, key, value);
+            worldobjT::send(owner, &ttT::template set_arg_from_remote<i, Key, const std::remove_reference_t<Value> &>,
+                            message, key, value);
           } else {
             worldobjT::send(owner, &ttT::template set_arg<i, Key, void>, key);
           }
         } else {
           if constexpr (!ttg::meta::is_void_v<Value>) {
-            worldobjT::send(owner, &ttT::template set_arg<i, void, const std::remove_reference_t<Value> &>, value);
+            worldobjT::send(owner, &ttT::template set_arg_from_remote<i, void, const std::remove_reference_t<Value> &>,
+                            message, value);
           } else {
             worldobjT::send(owner, &ttT::template set_arg<i, void, void>);
           }
         }
       } else {
+        this->counters().add(ttg::detail::tt_counter_slots::set_arg_local);
+        if constexpr (numins == 1 && !ttg::meta::is_void_v<Key> && !ttg::detail::derived_has_batch_op<derivedT>()) {
+          if (executes_fused(key)) {
+            execute_fused(key, std::forward<Value>(value));
+            return;
+          }
+        }
+
+        // a task producing this input is deferred while the pending tasks exceed their budget
+        if (detail::thread_task_depth() > 0) throttle();
+
         ttg::trace(world.rank(), ":", get_name(), " : ", key, ": received value for argument : ", i);
+        ttg::detail::notify_task_observers(key, [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+          o.input_arrived(*this, k, i);
+        });
 
         bool pullT_invoked = false;
-        accessorT acc;
+        cache_accessor acc;
 
         int prio;
         if constexpr (!ttg::meta::is_void_v<Key>) {
-          prio = this->priomap(key);
-          if (cache.insert(acc, key)) {
-            acc->second = new TTArgs(prio);  // It will be deleted by the task q
+          prio = priority_of(key);
+          if (cache_insert(acc, key)) {
+            acc.set(new_task(key, prio));
+            acc.get()->key = key;  // identifies the entry of dense_cache, see keys_awaiting_finalization
             if (!is_lazy_pull()) {
               // Invoke pull terminals for only the terminals with non-void values.
               invoke_pull_terminals(std::make_index_sequence<std::tuple_size_v<input_values_tuple_type>>{}, key,
-                                    acc->second);
+                                    acc.get());
               pullT_invoked = true;
             }
           }
         } else {
-          prio = this->priomap();
-          if (cache.insert(acc, 0)) acc->second = new TTArgs(prio);  // It will be deleted by the task q
+          prio = priority_of();
+          if (cache_insert(acc, 0)) acc.set(new_task(key, prio));
         }
 
-        TTArgs *args = acc->second;
+        TTArgs *args = acc.get();
         if (!is_lazy_pull() && pullT_invoked) args->pull_terminals_invoked = true;
 
         if (args->nargs[i] == 0) {
@@ -484,39 +1157,29 @@ namespace ttg_madness {
         }
 
         const auto &reducer = std::get<i>(input_reducers);
-        if (reducer) {  // is this a streaming input? reduce the received value
+        if (reducer && reduces_without_lock<i>()) {  // is this a streaming input reduced without locking?
+          // N.B. unless this completed the input the task cannot be ready
+          if (!reduce_without_lock<i>(acc, key, args, std::forward<Value>(value))) return;
+        } else if (reducer) {  // is this a streaming input? reduce the received value
           // N.B. Right now reductions are done eagerly, without spawning tasks
           //      this means we must lock
           args->lock();
 
-          bool initialize_not_reduce = false;
-          if (args->nargs[i] == std::numeric_limits<std::int64_t>::max()) {
-            // upon first datum initialize, if needed
-            if constexpr (!ttg::meta::is_void_v<valueT>) {
-              initialize_not_reduce = true;
-            }
+          // upon first datum initialize, if needed
+          const bool initialize_not_reduce = begin_stream<i>(args);
 
-            // initialize nargs
-            // if we have a stream size for the op, use it first
-            if (args->stream_size[i] != 0) {
-              assert(args->stream_size[i] <= static_cast<std::size_t>(std::numeric_limits<std::int64_t>::max()));
-              args->nargs[i] = args->stream_size[i];
-            } else if (static_streamsize[i] != 0) {
-              assert(static_streamsize[i] <= static_cast<std::size_t>(std::numeric_limits<std::int64_t>::max()));
-              args->stream_size[i] = static_streamsize[i];
-              args->nargs[i] = static_streamsize[i];
+          if constexpr (!ttg::meta::is_void_v<valueT>) {  // for data values
+            if (initialize_not_reduce) {
+              args->charge.add_bytes(ttg::footprint(value));
+              detail::assign_input_value(std::get<i>(args->input_values), std::forward<Value>(value),
+                                         this->counters());
             } else {
-              args->nargs[i] = 0;
+              reducer(detail::mutable_input_value(std::get<i>(args->input_values)), value);
+              this->counters().add(ttg::detail::tt_counter_slots::reducer_calls);
             }
-          }
-
-          if constexpr (!ttg::meta::is_void_v<valueT>) {  // for data values
-            if (initialize_not_reduce)
-              this->get<i, std::decay_t<valueT> &>(args->input_values) = std::forward<Value>(value);
-            else
-              reducer(this->get<i, std::decay_t<valueT> &>(args->input_values), value);
           } else {
             reducer();  // even if this was a control input, must execute the reducer for possible side effects
+            this->counters().add(ttg::detail::tt_counter_slots::reducer_calls);
           }
 
           // update the counter
@@ -528,7 +1191,8 @@ namespace ttg_madness {
           args->unlock();
         } else {                                          // this is a nonstreaming input => set the value
           if constexpr (!ttg::meta::is_void_v<valueT>) {  // for data values
-            this->get<i, std::decay_t<valueT> &>(args->input_values) = std::forward<Value>(value);
+            args->charge.add_bytes(ttg::footprint(value));
+            detail::assign_input_value(std::get<i>(args->input_values), std::forward<Value>(value), this->counters());
           }
           args->nargs[i] = 0;
           args->counter--;
@@ -545,34 +1209,72 @@ namespace ttg_madness {
         // ready to run the task?
         if (args->counter == 0) {
           ttg::trace(world.rank(), ":", get_name(), " : ", key, ": submitting task for op ");
+          ttg::detail::notify_task_observers(key, [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+            o.task_ready(*this, k);
+          });
           args->derived = static_cast<derivedT *>(this);
           args->key = key;
 
+          // release the cache entry (and its lock) before executing, an inlined task may set arguments of this TT
+          cache_erase(acc);
+
           using ttg::hash;
           auto curhash = hash<keyT>{}(key);
 
-          if (curhash == threaddata.key_hash && threaddata.call_depth < 6) {  // Needs to be externally configurable
+          // decide whether to execute inline (on this thread) or to hand the task to the scheduler
+          bool run_inline = false;
+          const auto &policy = this->get_execution_policy();
+          if (!policy) {  // default: inline only if cheap, i.e. the task has the key of the calling task
+            run_inline = (curhash == threaddata.key_hash &&
+                          threaddata.call_depth < static_cast<std::size_t>(this->get_max_inline_depth()));
+          } else if (*policy == ttg::Execution::Inline) {  // inline if called from a task, up to max depth
+            const auto depth = detail::thread_task_depth();
+            run_inline = (depth > 0 && depth < static_cast<std::size_t>(this->get_max_inline_depth()));
+          }
 
+          if constexpr (ttg::detail::derived_has_batch_op<derivedT>()) {
+            submit_task(args);  // batched tasks are never executed inline
+          } else if (run_inline) {
             // ttg::print("directly invoking:", get_name(), key, curhash, threaddata.key_hash, threaddata.call_depth);
+            const auto key_hash_save = threaddata.key_hash;
+            const auto thread_key_save = detail::thread_task_key();
+            ttT::threaddata.key_hash = curhash;
             ttT::threaddata.call_depth++;
-            if constexpr (!ttg::meta::is_void_v<keyT> && !ttg::meta::is_empty_tuple_v<input_values_tuple_type>) {
-              static_cast<derivedT *>(this)->op(key, args->make_input_refs(), output_terminals);  // Runs immediately
-            } else if constexpr (!ttg::meta::is_void_v<keyT> && ttg::meta::is_empty_tuple_v<input_values_tuple_type>) {
-              static_cast<derivedT *>(this)->op(key, output_terminals);  // Runs immediately
-            } else if constexpr (ttg::meta::is_void_v<keyT> && !ttg::meta::is_empty_tuple_v<input_values_tuple_type>) {
-              static_cast<derivedT *>(this)->op(args->make_input_refs(), output_terminals);  // Runs immediately
-            } else if constexpr (ttg::meta::is_void_v<keyT> && ttg::meta::is_empty_tuple_v<input_values_tuple_type>) {
-              static_cast<derivedT *>(this)->op(output_terminals);  // Runs immediately
-            } else
-              abort();
+            detail::thread_task_depth()++;
+            detail::thread_task_key() = detail::task_key_ref(args->key);
+            {
+              detail::task_scope scope;
+              args->share_inputs(scope);
+              ttg::detail::notify_task_observers(key, [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+                o.task_started(*this, k);
+              });
+              if constexpr (!ttg::meta::is_void_v<keyT> && !ttg::meta::is_empty_tuple_v<input_values_tuple_type>) {
+                static_cast<derivedT *>(this)->op(key, args->make_input_refs(), output_terminals);  // Runs immediately
+              } else if constexpr (!ttg::meta::is_void_v<keyT> &&
+                                   ttg::meta::is_empty_tuple_v<input_values_tuple_type>) {
+                static_cast<derivedT *>(this)->op(key, output_terminals);  // Runs immediately
+              } else if constexpr (ttg::meta::is_void_v<keyT> &&
+                                   !ttg::meta::is_empty_tuple_v<input_values_tuple_type>) {
+                static_cast<derivedT *>(this)->op(args->make_input_refs(), output_terminals);  // Runs immediately
+              } else if constexpr (ttg::meta::is_void_v<keyT> && ttg::meta::is_empty_tuple_v<input_values_tuple_type>) {
+                static_cast<derivedT *>(this)->op(output_terminals);  // Runs immediately
+              } else
+                abort();
+              ttg::detail::notify_task_observers(key, [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+                o.task_finished(*this, k);
+              });
+            }
+            detail::thread_task_key() = thread_key_save;
+            detail::thread_task_depth()--;
             ttT::threaddata.call_depth--;
-
+            ttT::threaddata.key_hash = key_hash_save;
+            this->counters().add(ttg::detail::tt_counter_slots::tasks_executed);
+            this->counters().add(ttg::detail::tt_counter_slots::tasks_inlined);
+            delete args;  // not owned by the task queue
           } else {
             // ttg::print("enqueuing task", get_name(), key, curhash, threaddata.key_hash, threaddata.call_depth);
-            world.impl().impl().taskq.add(args);
+            submit_task(args);
           }
-
-          cache.erase(acc);
         }
       }
     }
@@ -595,6 +1297,100 @@ namespace ttg_madness {
       set_arg<i, ttg::Void, ttg::Void>(ttg::Void{}, ttg::Void{});
     }
 
+    /// sets argument @p i of the task identified by @p key to @p value received from another process in message
+    /// @p message (see ttg::detail::next_message_id)
+    /// @note this is the receiving end of the remote case of set_arg, it counts the received bytes
+    template <std::size_t i, typename Key, typename Value>
+    std::enable_if_t<!ttg::meta::is_void_v<Key>, void> set_arg_from_remote(std::uint64_t message, const Key &key,
+                                                                           Value &&value) {
+      this->counters().add_bytes_received(i, ttg::footprint(value));
+      ttg::detail::notify_task_observers(key, [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+        o.message_received(*this, k, i, ttg::footprint(value), message);
+      });
+      set_arg<i, Key, Value>(key, std::forward<Value>(value));
+    }
+
+    template <std::size_t i, typename Key, typename Value>
+    std::enable_if_t<ttg::meta::is_void_v<Key>, void> set_arg_from_remote(std::uint64_t message, Value &&value) {
+      this->counters().add_bytes_received(i, ttg::footprint(value));
+      ttg::detail::notify_task_observers(ttg::Void{}, [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+        o.message_received(*this, k, i, ttg::footprint(value), message);
+      });
+      set_arg<i, Key, Value>(std::forward<Value>(value));
+    }
+
+    /// sets argument @p i of the local tasks identified by @p keylist to @p value, received in message @p message
+    /// @note this is the receiving end of broadcast_arg: @p value was deserialized once for all keys of this rank
+    template <std::size_t i, typename Key, typename Value>
+    void broadcast_arg_local(std::uint64_t message, const std::vector<Key> &keylist, const Value &value) {
+      this->counters().add_bytes_received(i, ttg::footprint(value));
+      ttg::detail::notify_task_observers(keylist.front(), [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+        o.message_received(*this, k, i, ttg::footprint(value), message);
+      });
+      detail::send_scope scope;  // the local readers share a single copy
+      for (auto &&key : keylist) {
+        ttg::trace(world.rank(), ":", get_name(), " : ", key, ": received broadcast value for argument : ", i);
+        set_arg<i, Key, const Value &>(key, value);
+      }
+    }
+
+    /// broadcasts @p value to argument @p i of the tasks identified by @p keylist
+    /// @note keys are grouped by owner, hence @p value is serialized and sent at most once per remote rank
+    template <std::size_t i, typename Key, typename Value>
+    std::enable_if_t<!ttg::meta::is_void_v<Key> && !std::is_void_v<std::decay_t<Value>>, void> broadcast_arg(
+        const ttg::span<const Key> &keylist, const Value &value) {
+      const auto rank = world.rank();
+
+      // evaluate keymap once per key, then order keys by owner (stable to preserve the order within each owner)
+      std::vector<std::pair<int, std::size_t>> owner_idx;
+      owner_idx.reserve(keylist.size());
+      bool have_remote = false;
+      for (std::size_t k = 0; k != keylist.size(); ++k) {
+        const int owner = owner_of(keylist[k]);
+        have_remote = have_remote || (owner != rank);
+        owner_idx.emplace_back(owner, k);
+      }
+
+      detail::send_scope scope;  // the local readers share a single copy
+      if (!have_remote) {
+        for (auto &&key : keylist) set_arg<i, Key, const Value &>(key, value);
+        return;
+      }
+
+      std::stable_sort(owner_idx.begin(), owner_idx.end(),
+                       [](const auto &a, const auto &b) { return a.first < b.first; });
+
+      // send to remote owners first so that communication overlaps with the processing of the local keys
+      auto local_begin = owner_idx.end();
+      auto local_end = owner_idx.end();
+      std::vector<Key> keys;
+      for (auto it = owner_idx.begin(); it != owner_idx.end(); /* increment inline */) {
+        const int owner = it->first;
+        auto owner_end = std::find_if(it, owner_idx.end(), [owner](const auto &oi) { return oi.first != owner; });
+        if (owner == rank) {
+          local_begin = it;
+          local_end = owner_end;
+        } else {
+          keys.clear();
+          keys.reserve(std::distance(it, owner_end));
+          for (auto kit = it; kit != owner_end; ++kit) keys.push_back(keylist[kit->second]);
+          ttg::trace(world.rank(), ":", get_name(), " : forwarding broadcast of argument ", i, " for ", keys.size(),
+                     " keys to rank ", owner);
+          this->counters().add(ttg::detail::tt_counter_slots::set_arg_remote, keys.size());
+          this->counters().add_bytes_sent(i, ttg::footprint(value));
+          const auto message = ttg::detail::next_message_id(rank);
+          ttg::detail::notify_task_observers(keys.front(), [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+            o.message_sent(*this, k, i, owner, ttg::footprint(value), message);
+          });
+          worldobjT::send(owner, &ttT::template broadcast_arg_local<i, Key, std::decay_t<Value>>, message, keys,
+                          value);
+        }
+        it = owner_end;
+      }
+
+      for (auto it = local_begin; it != local_end; ++it) set_arg<i, Key, const Value &>(keylist[it->second], value);
+    }
+
     // Used by invoke to set all arguments associated with a task
     // Is: index sequence of elements in args
     // Js: index sequence of input terminals to set
@@ -645,16 +1441,16 @@ namespace ttg_madness {
       assert(size > 0 && "TT::set_argstream_size(size) called with size=0");
 
       // body
-      const auto owner = keymap();
+      const auto owner = owner_of();
       if (owner != world.rank()) {
         ttg::trace(world.rank(), ":", get_name(), " : forwarding stream size for terminal ", i);
         worldobjT::send(owner, &ttT::template set_argstream_size<i, true>, size);
       } else {
         ttg::trace(world.rank(), ":", get_name(), " : setting stream size to ", size, " for terminal ", i);
 
-        accessorT acc;
-        if (cache.insert(acc, 0)) acc->second = new TTArgs();  // It will be deleted by the task q
-        TTArgs *args = acc->second;
+        cache_accessor acc;
+        if (cache_insert(acc, 0)) acc.set(new_task(ttg::Void{}));
+        TTArgs *args = acc.get();
 
         args->lock();
 
@@ -684,17 +1480,20 @@ namespace ttg_madness {
           args->nargs[i] += size;
         }
         // if done, update the counter
-        if (args->nargs[i] == 0) args->counter--;
+        if (args->nargs[i] == 0 && complete_stream<i>(args)) args->counter--;
         args->unlock();
 
         // ready to run the task?
         if (args->counter == 0) {
           ttg::trace(world.rank(), ":", get_name(), " : submitting task for op ");
+          ttg::detail::notify_task_observers(ttg::Void{}, [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+            o.task_ready(*this, k);
+          });
           args->derived = static_cast<derivedT *>(this);
 
-          world.impl().impl().taskq.add(args);
+          submit_task(args);
 
-          cache.erase(acc);
+          cache_erase(acc);
         }
       }
     }
@@ -727,16 +1526,19 @@ namespace ttg_madness {
       assert(size > 0 && "TT::set_argstream_size(key,size) called with size=0");
 
       // body
-      const auto owner = keymap(key);
+      const auto owner = owner_of(key);
       if (owner != world.rank()) {
         ttg::trace(world.rank(), ":", get_name(), " : ", key, ": forwarding stream size for terminal ", i);
         worldobjT::send(owner, &ttT::template set_argstream_size<i>, key, size);
       } else {
         ttg::trace(world.rank(), ":", get_name(), " : ", key, ": setting stream size for terminal ", i);
 
-        accessorT acc;
-        if (cache.insert(acc, key)) acc->second = new TTArgs(this->priomap(key));  // It will be deleted by the task q
-        TTArgs *args = acc->second;
+        cache_accessor acc;
+        if (cache_insert(acc, key)) {
+          acc.set(new_task(key, priority_of(key)));
+          acc.get()->key = key;
+        }
+        TTArgs *args = acc.get();
 
         args->lock();
 
@@ -758,19 +1560,22 @@ namespace ttg_madness {
         const auto messages_received_already = args->nargs[i] != std::numeric_limits<std::int64_t>::max();
         if (messages_received_already) args->nargs[i] += size;
         // if done, update the counter
-        if (args->nargs[i] == 0) args->counter--;
+        if (args->nargs[i] == 0 && complete_stream<i>(args)) args->counter--;
 
         args->unlock();
 
         // ready to run the task?
         if (args->counter == 0) {
           ttg::trace(world.rank(), ":", get_name(), " : ", key, ": submitting task for op ");
+          ttg::detail::notify_task_observers(key, [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+            o.task_ready(*this, k);
+          });
           args->derived = static_cast<derivedT *>(this);
           args->key = key;
 
-          world.impl().impl().taskq.add(args);
+          submit_task(args);
 
-          cache.erase(acc);
+          cache_erase(acc);
         }
       }
     }
@@ -782,18 +1587,18 @@ namespace ttg_madness {
       assert(std::get<i>(input_reducers) && "TT::finalize_argstream called on nonstreaming input terminal");
 
       // body
-      const auto owner = keymap(key);
+      const auto owner = owner_of(key);
       if (owner != world.rank()) {
         ttg::trace(world.rank(), ":", get_name(), " : ", key, ": forwarding stream finalize for terminal ", i);
         worldobjT::send(owner, &ttT::template finalize_argstream<i>, key);
       } else {
         ttg::trace(world.rank(), ":", get_name(), " : ", key, ": finalizing stream for terminal ", i);
 
-        accessorT acc;
-        const auto found = cache.find(acc, key);
+        cache_accessor acc;
+        const auto found = cache_find(acc, key);
         assert(found && "TT::finalize_argstream called but no values had been received yet for this key");
         TTGUNUSED(found);
-        TTArgs *args = acc->second;
+        TTArgs *args = acc.get();
 
         // check if stream is already bounded
         if (args->stream_size[i] > 0) {
@@ -809,17 +1614,20 @@ namespace ttg_madness {
 
         // commit changes
         args->nargs[i] = 0;
-        args->counter--;
+        if (complete_stream<i>(args)) args->counter--;
         // ready to run the task?
         if (args->counter == 0) {
           ttg::trace(world.rank(), ":", get_name(), " : ", key, ": submitting task for op ");
+          ttg::detail::notify_task_observers(key, [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+            o.task_ready(*this, k);
+          });
           args->derived = static_cast<derivedT *>(this);
           args->key = key;
 
-          world.impl().impl().taskq.add(args);
+          submit_task(args);
           // static_cast<derivedT*>(this)->op(key, std::move(args->t), output_terminals); // Runs immediately
 
-          cache.erase(acc);
+          cache_erase(acc);
         }
       }
     }
@@ -831,18 +1639,18 @@ namespace ttg_madness {
       assert(std::get<i>(input_reducers) && "TT::finalize_argstream called on nonstreaming input terminal");
 
       // body
-      const int owner = keymap();
+      const int owner = owner_of();
       if (owner != world.rank()) {
         ttg::trace(world.rank(), ":", get_name(), " : forwarding stream finalize for terminal ", i);
         worldobjT::send(owner, &ttT::template finalize_argstream<i, true>);
       } else {
         ttg::trace(world.rank(), ":", get_name(), " : finalizing stream for terminal ", i);
 
-        accessorT acc;
-        const auto found = cache.find(acc, 0);
+        cache_accessor acc;
+        const auto found = cache_find(acc, 0);
         assert(found && "TT::finalize_argstream called but no values had been received yet for this key");
         TTGUNUSED(found);
-        TTArgs *args = acc->second;
+        TTArgs *args = acc.get();
 
         // check if stream is already bounded
         if (args->stream_size[i] > 0) {
@@ -858,20 +1666,42 @@ namespace ttg_madness {
 
         // commit changes
         args->nargs[i] = 0;
-        args->counter--;
+        if (complete_stream<i>(args)) args->counter--;
         // ready to run the task?
         if (args->counter == 0) {
           ttg::trace(world.rank(), ":", get_name(), " : submitting task for op ");
+          ttg::detail::notify_task_observers(ttg::Void{}, [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+            o.task_ready(*this, k);
+          });
           args->derived = static_cast<derivedT *>(this);
 
-          world.impl().impl().taskq.add(args);
+          submit_task(args);
           // static_cast<derivedT*>(this)->op(key, std::move(args->t), output_terminals); // Runs immediately
 
-          cache.erase(acc);
+          cache_erase(acc);
         }
       }
     }
 
+    /// lets the runtime finalize unbounded stream \c i: a task whose stream received values without being bounded
+    /// or finalized is released once no more values can arrive for it, i.e. once the world becomes quiescent
+    /// during a fence, after the tasks that can send values to this TT have completed.
+    /// Must be called on every process, for the TTs in the same order, before any value is sent to this TT.
+    /// \tparam <i>: index of the input terminal
+    template <std::size_t i>
+    void set_argstream_auto_finalize() {
+      assert(std::get<i>(input_reducers) && "TT::set_argstream_auto_finalize called on nonstreaming input terminal");
+      ttg::trace(world.rank(), ":", get_name(), " : finalizing stream of terminal ", i, " upon quiescence");
+      const bool registered =
+          std::find(auto_finalize_streams.begin(), auto_finalize_streams.end(), true) != auto_finalize_streams.end();
+      auto_finalize_streams[i] = true;
+      if (!registered) {
+        world.impl().register_stream_finalizer(
+            this, [this]() { return !keys_awaiting_finalization().empty(); },
+            [this]() { finalize_awaiting_streams(std::make_index_sequence<numins>{}); });
+      }
+    }
+
    private:
     // Copy/assign/move forbidden ... we could make it work using
     // PIMPL for this base class.  However, this instance of the base
@@ -909,9 +1739,12 @@ namespace ttg_madness {
         auto send_callback = [this](const keyT &key, const valueT &value) {
           set_arg<i, keyT, const valueT &>(key, value);
         };
+        auto broadcast_callback = [this](const ttg::span<const keyT> &keylist, const valueT &value) {
+          broadcast_arg<i, keyT, valueT>(keylist, value);
+        };
         auto setsize_callback = [this](const keyT &key, std::size_t size) { set_argstream_size<i>(key, size); };
         auto finalize_callback = [this](const keyT &key) { finalize_argstream<i>(key); };
-        input.set_callback(send_callback, move_callback, {}, setsize_callback, finalize_callback);
+        input.set_callback(send_callback, move_callback, broadcast_callback, setsize_callback, finalize_callback);
       }
       //////////////////////////////////////////////////////////////////
       // case 4: void key, nonvoid value
@@ -990,6 +1823,7 @@ namespace ttg_madness {
                      ? decltype(keymap)(ttg::detail::default_keymap<keyT>(world))
                      : decltype(keymap)(std::forward<keymapT>(keymap_)))
         , priomap(decltype(keymap)(std::forward<priomapT>(priomap_))) {
+      world.impl().register_op(this);  // e.g. for World::counters
       // Cannot call these in base constructor since terminals not yet constructed
       if (innames.size() != numinedges) {
         ttg::print_error(world.rank(), ":", get_name(), "#input_names", innames.size(), "!= #input_terminals",
@@ -1052,7 +1886,10 @@ namespace ttg_madness {
 
     // Destructor checks for unexecuted tasks
     virtual ~TT() {
-      if (cache.size() != 0) {
+      world.impl().deregister_op(this);
+      if (std::find(auto_finalize_streams.begin(), auto_finalize_streams.end(), true) != auto_finalize_streams.end())
+        world.impl().deregister_stream_finalizer(this);
+      if (cache_size() != 0) {
         std::cerr << world.rank() << ":"
                   << "warning: unprocessed tasks in destructor of operation '" << get_name()
                   << "' (class name = " << get_class_name() << ")" << std::endl;
@@ -1070,6 +1907,15 @@ namespace ttg_madness {
           for (std::size_t i = 0; i < numins; i++) std::cerr << (item.second->nargs[i] == 0 ? "T" : "F") << " ";
           std::cerr << ")" << std::endl;
         }
+        if (dense_cache) {
+          dense_cache->for_each([&](std::size_t idx, TTArgs *args) {
+            if (nprint++ > 10) return;
+            std::cerr << world.rank() << ":"
+                      << "   unused: key index " << idx << " : ( ";
+            for (std::size_t i = 0; i < numins; i++) std::cerr << (args->nargs[i] == 0 ? "T" : "F") << " ";
+            std::cerr << ")" << std::endl;
+          });
+        }
         abort();
       }
     }
@@ -1098,21 +1944,97 @@ namespace ttg_madness {
       set_static_argstream_size<i>(size);
     }
 
+    /// define the reducer function to be called when additional inputs are
+    /// received on a streaming terminal, and how it is invoked
+    ///   @tparam <i> the index of the input terminal that is used as a streaming terminal
+    ///   @param[in] reducer: a function of prototype (input_type<i> &a, const input_type<i> &b)
+    ///                       that function should aggregate b into a
+    ///   @param[in] mode: how the reducer is invoked, see set_input_reduce_mode
+    template <std::size_t i, typename Reducer>
+    void set_input_reducer(Reducer &&reducer, ttg::ReduceMode mode) {
+      set_input_reducer<i>(std::forward<Reducer>(reducer));
+      set_input_reduce_mode<i>(mode);
+    }
+
+    /// define the reducer function to be called when additional inputs are
+    /// received on a streaming terminal, and how it is invoked
+    ///   @tparam <i> the index of the input terminal that is used as a streaming terminal
+    ///   @param[in] reducer: a function of prototype (input_type<i> &a, const input_type<i> &b)
+    ///                       that function should aggregate b into a
+    ///   @param[in] size: the default number of inputs that are received in this streaming terminal,
+    ///                    for each task
+    ///   @param[in] mode: how the reducer is invoked, see set_input_reduce_mode
+    template <std::size_t i, typename Reducer>
+    void set_input_reducer(Reducer &&reducer, std::size_t size, ttg::ReduceMode mode) {
+      set_input_reducer<i>(std::forward<Reducer>(reducer), size);
+      set_input_reduce_mode<i>(mode);
+    }
+
+    /// selects how the values received by streaming terminal @p i are reduced. With ttg::ReduceMode::Locked (the
+    /// default) every value is reduced into the input of the task while holding its lock, hence the senders of the
+    /// values serialize. ttg::ReduceMode::Atomic reduces values of arithmetic type with compare-and-swap,
+    /// ttg::ReduceMode::PerThread lets each thread reduce into its own partial result, the partial results are
+    /// combined when the stream is complete. The latter two modes require the reducer to be associative and
+    /// commutative and, since the reducer may be called concurrently, reentrant. Control inputs are always reduced
+    /// under the lock.
+    ///   @tparam <i> the index of the input terminal that is used as a streaming terminal
+    ///   @param[in] mode: the reduction mode; ttg::ReduceMode::Atomic is only valid for inputs of arithmetic type
+    template <std::size_t i>
+    void set_input_reduce_mode(ttg::ReduceMode mode) {
+      using valueT = std::decay_t<std::tuple_element_t<i, input_values_full_tuple_type>>;
+      if (mode == ttg::ReduceMode::Atomic && !ttg::detail::is_atomic_reducible_v<valueT>) {
+        ttg::print_error(world.rank(), ":", get_name(), " : error atomic reduction of a non-arithmetic input : ", i);
+        throw std::logic_error("TT::set_input_reduce_mode: ReduceMode::Atomic requires an input of arithmetic type");
+      }
+      input_reduce_modes[i] = mode;
+    }
+
+    /// @return how the values received by streaming terminal @p i are reduced, see set_input_reduce_mode
+    template <std::size_t i>
+    ttg::ReduceMode get_input_reduce_mode() const {
+      return input_reduce_modes[i];
+    }
+
     template <typename Keymap>
     void set_keymap(Keymap &&km) {
+      if constexpr (ttg::detail::derived_has_bound_maps<derivedT>()) {
+        ttg::print_error(world.rank(), ":", get_name(), " : set_keymap called on a TT with bound maps");
+        throw std::logic_error("TT::set_keymap: the keymap is bound by its type, see ttg::bind_maps");
+      }
       keymap = km;
     }
 
     auto get_priomap(void) const { return priomap; }
 
     /// Set the priority map, mapping a Key to an integral value.
-    /// Higher values indicate higher priority. The default priority is 0, higher
-    /// values are treated as high priority tasks in the MADNESS backend.
+    /// Higher values indicate higher priority, the default priority is 0.
+    /// The MADNESS task queue only distinguishes two priority classes: tasks with positive
+    /// priority are queued ahead of all other tasks, tasks with zero or negative priority
+    /// are queued in order of submission.
     template <typename Priomap>
     void set_priomap(Priomap &&pm) {
+      if constexpr (ttg::detail::derived_has_bound_maps<derivedT>()) {
+        ttg::print_error(world.rank(), ":", get_name(), " : set_priomap called on a TT with bound maps");
+        throw std::logic_error("TT::set_priomap: the priomap is bound by its type, see ttg::bind_maps");
+      }
       priomap = std::forward<Priomap>(pm);
     }
 
+    /// Declares the domain of the keys of the tasks of this TT executed on this process: pending tasks are then kept
+    /// in a table indexed by the linearized key instead of a hash table. Must be called before make_executable().
+    /// @param extent the number of keys in the domain
+    /// @param linearize a function that maps a key to a unique index in [0, extent); only the keys of tasks
+    ///        mapped to this process by the keymap need be mapped, e.g. to a process-local index
+    template <typename Linearizer, typename Key = keyT>
+    std::enable_if_t<!ttg::meta::is_void_v<Key>> set_key_domain(std::size_t extent, Linearizer &&linearize) {
+      if (is_executable()) {
+        ttg::print_error(world.rank(), ":", get_name(), " : set_key_domain called after make_executable");
+        throw std::logic_error("TT::set_key_domain called after make_executable");
+      }
+      key_linearizer = std::forward<Linearizer>(linearize);
+      dense_cache = std::make_unique<dense_cacheT>(extent);
+    }
+
     /// implementation of TTBase::make_executable()
     void make_executable() override {
       TTBase::make_executable();
@@ -1127,6 +2049,9 @@ namespace ttg_madness {
     /// fence TTGs independently, then give each its own world.
     void fence() override { ttg_fence(world); }
 
+    /// called when the world is destroyed before this TT
+    void release() override { world.impl().deregister_op(this); }
+
     /// Returns pointer to input terminal i to facilitate connection --- terminal cannot be copied, moved or assigned
     template <std::size_t i>
     std::tuple_element_t<i, input_terminals_type> *in() {
@@ -1144,6 +2069,7 @@ namespace ttg_madness {
     std::enable_if_t<!ttg::meta::is_void_v<Key> && !ttg::meta::is_empty_tuple_v<input_values_tuple_type>, void> invoke(
         const Key &key, const input_values_tuple_type &args) {
       TTG_OP_ASSERT_EXECUTABLE();
+      throttle();
       /* trigger non-void inputs */
       set_args(ttg::meta::nonvoid_index_seq<actual_input_tuple_type>{}, key, args);
       /* trigger void inputs */
@@ -1156,6 +2082,7 @@ namespace ttg_madness {
     std::enable_if_t<ttg::meta::is_void_v<Key> && !ttg::meta::is_empty_tuple_v<input_values_tuple_type>, void> invoke(
         const input_values_tuple_type &args) {
       TTG_OP_ASSERT_EXECUTABLE();
+      throttle();
       /* trigger non-void inputs */
       set_args(ttg::meta::nonvoid_index_seq<actual_input_tuple_type>{}, args);
       /* trigger void inputs */
@@ -1168,6 +2095,7 @@ namespace ttg_madness {
     std::enable_if_t<!ttg::meta::is_void_v<Key> && ttg::meta::is_empty_tuple_v<input_values_tuple_type>, void> invoke(
         const Key &key) {
       TTG_OP_ASSERT_EXECUTABLE();
+      throttle();
       /* trigger void inputs */
       using void_index_seq = ttg::meta::void_index_seq<actual_input_tuple_type>;
       set_args(void_index_seq{}, key, ttg::detail::make_void_tuple<void_index_seq::size()>());
@@ -1177,6 +2105,7 @@ namespace ttg_madness {
     template <typename Key = keyT>
     std::enable_if_t<ttg::meta::is_void_v<Key> && ttg::meta::is_empty_tuple_v<input_values_tuple_type>, void> invoke() {
       TTG_OP_ASSERT_EXECUTABLE();
+      throttle();
       /* trigger void inputs */
       using void_index_seq = ttg::meta::void_index_seq<actual_input_tuple_type>;
       set_args(void_index_seq{}, ttg::detail::make_void_tuple<void_index_seq::size()>());
@@ -1202,14 +2131,14 @@ namespace ttg_madness {
     /// @return the owner of @c key
     template <typename Key>
     std::enable_if_t<!ttg::meta::is_void_v<Key>, int> owner(const Key &key) const {
-      return keymap(key);
+      return owner_of(key);
     }
 
     /// computes the owner of void key
     /// @return the owner of void key
     template <typename Key>
     std::enable_if_t<ttg::meta::is_void_v<Key>, int> owner() const {
-      return keymap();
+      return owner_of();
     }
   };
 
@@ -1219,4 +2148,20 @@ namespace ttg_madness {
 
 #include "ttg/madness/watch.h"
 
+/**
+ * The MADNESS backend shares the copies of a sent value among the local tasks reading it (taking it as a const
+ * input), hence the handler opens a scope spanning the send or broadcast.
+ */
+template <>
+struct ttg::detail::value_copy_handler<ttg::Runtime::MADWorld> {
+ private:
+  ttg_madness::detail::send_scope scope;
+
+ public:
+  template <typename Value>
+  inline constexpr decltype(auto) operator()(Value &&value) const {
+    return std::forward<Value>(value);
+  }
+};
+
 #endif  // MADNESS_TTG_H_INCLUDED
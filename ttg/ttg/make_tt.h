@@ -125,12 +125,15 @@ struct CallableWrapTTUnwrapTypelist<funcT, funcT_receives_outterm_tuple, keyT, o
 // case 1 (keyT != void): void op(auto&& key, input_valuesT&&..., std::tuple<output_terminalsT...>&)
 // case 2 (keyT == void): void op(input_valuesT&&..., std::tuple<output_terminalsT...>&)
 //
-template <typename funcT, bool funcT_receives_outterm_tuple, typename keyT, typename output_terminalsT,
+// mapsT is ttg::detail::unbound_maps or the ttg::BoundMaps holding the keymap and priomap bound by their types
+//
+template <typename funcT, bool funcT_receives_outterm_tuple, typename keyT, typename output_terminalsT, typename mapsT,
           typename... input_valuesT>
 class CallableWrapTTArgs
-    : public TT<keyT, output_terminalsT,
-                CallableWrapTTArgs<funcT, funcT_receives_outterm_tuple, keyT, output_terminalsT, input_valuesT...>,
-                ttg::typelist<input_valuesT...>> {
+    : public TT<
+          keyT, output_terminalsT,
+          CallableWrapTTArgs<funcT, funcT_receives_outterm_tuple, keyT, output_terminalsT, mapsT, input_valuesT...>,
+          ttg::typelist<input_valuesT...>> {
   using baseT = typename CallableWrapTTArgs::ttT;
 
   using input_values_tuple_type = typename baseT::input_values_tuple_type;
@@ -140,6 +143,7 @@ class CallableWrapTTArgs
 
   using noref_funcT = std::remove_reference_t<funcT>;
   std::conditional_t<std::is_function_v<noref_funcT>, std::add_pointer_t<noref_funcT>, noref_funcT> func;
+  mapsT maps;
 
   template <typename Key, typename Tuple, std::size_t... S>
   void call_func(Key &&key, Tuple &&args_tuple, output_terminalsT &out, std::index_sequence<S...>) {
@@ -200,12 +204,34 @@ class CallableWrapTTArgs
   }
 
  public:
+  /// the keymap and priomap are evaluated by keymap_impl and priomap_impl, see ttg::bind_maps
+  static constexpr bool have_bound_maps = !std::is_same_v<mapsT, ttg::detail::unbound_maps>;
+
   template <typename funcT_>
   CallableWrapTTArgs(funcT_ &&f, const input_edges_type &inedges, const typename baseT::output_edges_type &outedges,
                      const std::string &name, const std::vector<std::string> &innames,
                      const std::vector<std::string> &outnames)
       : baseT(inedges, outedges, name, innames, outnames), func(std::forward<funcT_>(f)) {}
 
+  /// the type-erased maps of the TT are copies of the bound maps, e.g. for get_keymap()
+  template <typename funcT_>
+  CallableWrapTTArgs(funcT_ &&f, const mapsT &maps_, const input_edges_type &inedges,
+                     const typename baseT::output_edges_type &outedges, const std::string &name,
+                     const std::vector<std::string> &innames, const std::vector<std::string> &outnames)
+      : baseT(inedges, outedges, name, innames, outnames, maps_.keymap, maps_.priomap)
+      , func(std::forward<funcT_>(f))
+      , maps(maps_) {}
+
+  template <typename... Key>
+  int keymap_impl(const Key &...key) const {
+    return maps.keymap(key...);
+  }
+
+  template <typename... Key>
+  int priomap_impl(const Key &...key) const {
+    return maps.priomap(key...);
+  }
+
   template <typename funcT_>
   CallableWrapTTArgs(funcT_ &&f, const std::string &name, const std::vector<std::string> &innames,
                      const std::vector<std::string> &outnames)
@@ -245,23 +271,23 @@ class CallableWrapTTArgs
   };
 };
 
-template <typename funcT, bool funcT_receives_outterm_tuple, typename keyT, typename output_terminalsT,
+template <typename funcT, bool funcT_receives_outterm_tuple, typename keyT, typename output_terminalsT, typename mapsT,
           typename input_values_typelistT>
 struct CallableWrapTTArgsAsTypelist;
 
-template <typename funcT, bool funcT_receives_outterm_tuple, typename keyT, typename output_terminalsT,
+template <typename funcT, bool funcT_receives_outterm_tuple, typename keyT, typename output_terminalsT, typename mapsT,
           typename... input_valuesT>
-struct CallableWrapTTArgsAsTypelist<funcT, funcT_receives_outterm_tuple, keyT, output_terminalsT,
+struct CallableWrapTTArgsAsTypelist<funcT, funcT_receives_outterm_tuple, keyT, output_terminalsT, mapsT,
                                     std::tuple<input_valuesT...>> {
-  using type = CallableWrapTTArgs<funcT, funcT_receives_outterm_tuple, keyT, output_terminalsT,
+  using type = CallableWrapTTArgs<funcT, funcT_receives_outterm_tuple, keyT, output_terminalsT, mapsT,
                                   std::remove_reference_t<input_valuesT>...>;
 };
 
-template <typename funcT, bool funcT_receives_outterm_tuple, typename keyT, typename output_terminalsT,
+template <typename funcT, bool funcT_receives_outterm_tuple, typename keyT, typename output_terminalsT, typename mapsT,
           typename... input_valuesT>
-struct CallableWrapTTArgsAsTypelist<funcT, funcT_receives_outterm_tuple, keyT, output_terminalsT,
+struct CallableWrapTTArgsAsTypelist<funcT, funcT_receives_outterm_tuple, keyT, output_terminalsT, mapsT,
                                     ttg::meta::typelist<input_valuesT...>> {
-  using type = CallableWrapTTArgs<funcT, funcT_receives_outterm_tuple, keyT, output_terminalsT,
+  using type = CallableWrapTTArgs<funcT, funcT_receives_outterm_tuple, keyT, output_terminalsT, mapsT,
                                   std::remove_reference_t<input_valuesT>...>;
 };
 
@@ -291,6 +317,8 @@ struct CallableWrapTTArgsAsTypelist<funcT, funcT_receives_outterm_tuple, keyT, o
 /// @param[in] outnames string labels for the respective output terminals of the resulting TT
 ///
 /// @note Handling of generic @p func is described in the documentation of make_tt()
+/// @note Throws std::logic_error while a split-phase fence started by ttg::fence_begin() is in progress in the default
+///       execution context, until it completes: TTs can only be created, and tasks injected, between fences.
 // clang-format on
 template <typename keyT = void, typename funcT, typename... input_edge_valuesT, typename... output_edgesT>
 auto make_tt_tpl(funcT &&func, const std::tuple<ttg::Edge<keyT, input_edge_valuesT>...> &inedges = std::tuple<>{},
@@ -398,6 +426,8 @@ auto make_tt_tpl(funcT &&func, const std::tuple<ttg::Edge<keyT, input_edge_value
 /// @param[in] name a string label for the resulting TT
 /// @param[in] innames string labels for the respective input terminals of the resulting TT
 /// @param[in] outnames string labels for the respective output terminals of the resulting TT
+/// @param[in] maps the keymap and priomap bound by their types, see ttg::bind_maps(); by default the TT evaluates the
+///            type-erased maps given to set_keymap() and set_priomap()
 ///
 /// @warning You MUST NOT use generic callables that use concrete types for some data arguments, i.e. make either
 ///          ALL data types or NONE of them generic. This warning only applies to the data arguments and
@@ -420,12 +450,17 @@ auto make_tt_tpl(funcT &&func, const std::tuple<ttg::Edge<keyT, input_edge_value
 ///
 /// @warning Although generic arguments annotated by `const auto&` are also permitted, their use is discouraged to avoid confusion;
 ///          namely, `const auto&` denotes a _consumable_ argument, NOT read-only, despite the `const`.
+///
+/// @note Throws std::logic_error while a split-phase fence started by ttg::fence_begin() is in progress in the default
+///       execution context, until it completes: TTs can only be created, and tasks injected, between fences.
 // clang-format on
-template <typename keyT = void, typename funcT, typename... input_edge_valuesT, typename... output_edgesT>
+template <typename keyT = void, typename funcT, typename... input_edge_valuesT, typename... output_edgesT,
+          typename mapsT = ttg::detail::unbound_maps>
 auto make_tt(funcT &&func, const std::tuple<ttg::Edge<keyT, input_edge_valuesT>...> &inedges = std::tuple<>{},
              const std::tuple<output_edgesT...> &outedges = std::tuple<>{}, const std::string &name = "wrapper",
              const std::vector<std::string> &innames = std::vector<std::string>(sizeof...(input_edge_valuesT), "input"),
-             const std::vector<std::string> &outnames = std::vector<std::string>(sizeof...(output_edgesT), "output")) {
+             const std::vector<std::string> &outnames = std::vector<std::string>(sizeof...(output_edgesT), "output"),
+             const mapsT &maps = mapsT{}) {
   // ensure input types do not contain Void
   static_assert(ttg::meta::is_none_Void_v<input_edge_valuesT...>, "ttg::Void is for internal use only, do not use it");
 
@@ -493,10 +528,14 @@ auto make_tt(funcT &&func, const std::tuple<ttg::Edge<keyT, input_edge_valuesT>.
   using decayed_input_args_t = ttg::meta::decayed_typelist_t<input_args_t>;
   // 3. full_input_args_t = edge-types with non-void types replaced by input_args_t
   using full_input_args_t = ttg::meta::replace_nonvoid_t<input_edge_value_types, input_args_t>;
-  using wrapT = typename CallableWrapTTArgsAsTypelist<funcT, have_outterm_tuple, keyT, output_terminals_type,
+  using wrapT = typename CallableWrapTTArgsAsTypelist<funcT, have_outterm_tuple, keyT, output_terminals_type, mapsT,
                                                       full_input_args_t>::type;
 
-  return std::make_unique<wrapT>(std::forward<funcT>(func), inedges, outedges, name, innames, outnames);
+  if constexpr (wrapT::have_bound_maps) {
+    return std::make_unique<wrapT>(std::forward<funcT>(func), maps, inedges, outedges, name, innames, outnames);
+  } else {
+    return std::make_unique<wrapT>(std::forward<funcT>(func), inedges, outedges, name, innames, outnames);
+  }
 }
 
 template <typename keyT, typename funcT, typename... input_valuesT, typename... output_edgesT>
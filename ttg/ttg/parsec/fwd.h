@@ -44,7 +44,8 @@ namespace ttg_parsec {
 
   inline ttg::Edge<> &ttg_ctl_edge(ttg::World world);
 
-  inline void ttg_sum(ttg::World world, double &value);
+  template <typename T>
+  inline void ttg_sum(ttg::World world, T &value);
 
   /// broadcast
   /// @tparam T a serializable type
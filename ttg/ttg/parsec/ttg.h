@@ -23,9 +23,12 @@
 #include "ttg/tt.h"
 #include "ttg/util/env.h"
 #include "ttg/util/hash.h"
+#include "ttg/util/memory_budget.h"
 #include "ttg/util/meta.h"
 #include "ttg/util/meta/callable.h"
 #include "ttg/util/print.h"
+#include "ttg/util/stream_accumulator.h"
+#include "ttg/util/task_batch.h"
 #include "ttg/util/trace.h"
 #include "ttg/util/typelist.h"
 
@@ -35,7 +38,9 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
+#include <cstdint>
 #include <cstring>
 #include <experimental/type_traits>
 #include <functional>
@@ -45,9 +50,12 @@
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <sstream>
 #include <string>
 #include <tuple>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <parsec.h>
@@ -70,6 +78,7 @@
 #include <cstring>
 
 #include "ttg/parsec/ttg_data_copy.h"
+#include "ttg/util/dense_table.h"
 
 #undef TTG_PARSEC_DEBUG_TRACK_DATA_COPIES
 
@@ -109,6 +118,7 @@ namespace ttg_parsec {
     fn_id_t fn_id;
     int32_t param_id;
     int num_keys;
+    uint64_t message_id;  //!< the id of a MSG_SET_ARG message, see ttg::detail::next_message_id
   };
 
   static void unregister_parsec_tags(void *_);
@@ -470,6 +480,10 @@ namespace ttg_parsec {
       execute();
     }
 
+    virtual void allreduce_or(std::vector<int> &flags) override {
+      MPI_Allreduce(MPI_IN_PLACE, flags.data(), static_cast<int>(flags.size()), MPI_INT, MPI_LOR, comm());
+    }
+
    private:
     parsec_context_t *ctx = nullptr;
     bool own_ctx = false;  //< whether I own the context
@@ -548,6 +562,7 @@ namespace ttg_parsec {
        */
       release_task_fn* release_task_cb = nullptr;
       bool remove_from_hash = true;
+      ttg::detail::budget_charge charge;  //< usage of the memory budgets, released once the task completes
 
       /*
       virtual void release_task() = 0;
@@ -570,6 +585,7 @@ namespace ttg_parsec {
         parsec_task.mempool_owner = mempool;
         parsec_task.task_class = task_class;
         parsec_task.priority = 0;
+        *(uintptr_t*)&(parsec_task.locals[4]) = 0; // there is no key, see parsec_ttg_task_t
       }
 
       parsec_ttg_task_base_t(parsec_thread_mempool_t *mempool, parsec_task_class_t *task_class,
@@ -579,7 +595,6 @@ namespace ttg_parsec {
           : data_count(data_count)
           , defer_writer(defer_writer)
           , release_task_cb(release_fn) {
-            int32_t p = priority;
         PARSEC_LIST_ITEM_SINGLETON(&parsec_task.super);
         parsec_task.mempool_owner = mempool;
         parsec_task.task_class = task_class;
@@ -587,6 +602,7 @@ namespace ttg_parsec {
         parsec_task.taskpool = taskpool;
         parsec_task.priority = priority;
         parsec_task.chore_id = 0;
+        *(uintptr_t*)&(parsec_task.locals[4]) = 0; // there is no key, see parsec_ttg_task_t
       }
 
     public:
@@ -601,6 +617,10 @@ namespace ttg_parsec {
       TT* tt;
       key_type key;
       size_goal_t stream[num_streams] = {};
+      /* storage of the inputs that are stored inline, see ttg_data_inline_copy_t */
+      ttg_data_inline_storage_tuple_t<typename TT::input_values_full_tuple_type> inline_values;
+      /* accumulators of the streaming inputs that are not reduced under the lock, see TT::set_input_reduce_mode */
+      ttg::detail::stream_accumulators_t<typename TT::input_values_full_tuple_type> accumulators;
 
       parsec_ttg_task_t(parsec_thread_mempool_t *mempool, parsec_task_class_t *task_class)
           : parsec_ttg_task_base_t(mempool, task_class, num_streams) {
@@ -627,10 +647,12 @@ namespace ttg_parsec {
           parsec_task.data[i].data_in = nullptr;
         }
 
-        // We store the hash of the key and the address where it can be found in locals considered as a scratchpad
+        // We store the hash of the key, the address where it can be found and its type (see ttg::meta::type_id)
+        // in locals considered as a scratchpad
         uint64_t hv = ttg::hash<std::decay_t<decltype(key)>>{}(key);
         *(uintptr_t*)&(parsec_task.locals[0]) = hv;
         *(uintptr_t*)&(parsec_task.locals[2]) = reinterpret_cast<uintptr_t>(&this->key);
+        *(uintptr_t*)&(parsec_task.locals[4]) = reinterpret_cast<uintptr_t>(ttg::meta::type_id<key_type>());
       }
 
       static void release_task(parsec_ttg_task_base_t* task_base) {
@@ -647,6 +669,10 @@ namespace ttg_parsec {
       static constexpr size_t num_streams = TT::numins;
       TT* tt;
       size_goal_t stream[num_streams] = {};
+      /* storage of the inputs that are stored inline, see ttg_data_inline_copy_t */
+      ttg_data_inline_storage_tuple_t<typename TT::input_values_full_tuple_type> inline_values;
+      /* accumulators of the streaming inputs that are not reduced under the lock, see TT::set_input_reduce_mode */
+      ttg::detail::stream_accumulators_t<typename TT::input_values_full_tuple_type> accumulators;
 
       parsec_ttg_task_t(parsec_thread_mempool_t *mempool, parsec_task_class_t *task_class)
           : parsec_ttg_task_base_t(mempool, task_class, num_streams) {
@@ -685,7 +711,8 @@ namespace ttg_parsec {
       }
       for (int i = 0; i < task->data_count; ++i) {
         auto copy = static_cast<ttg_data_copy_t *>(task->parsec_task.data[i].data_in);
-        if (NULL != copy && copy->device_private == ptr) {
+        /* inline copies are owned by the task, the value must be copied */
+        if (NULL != copy && copy->device_private == ptr && !copy->is_inline) {
           res = copy;
           break;
         }
@@ -874,7 +901,252 @@ namespace ttg_parsec {
       return PARSEC_SUCCESS;
     }
 
+    /// the default size (in bytes) above which serialized values are sent by the rendezvous protocol
+    static constexpr std::size_t default_rendezvous_threshold = 64 * 1024;
+
+    /// The serialized image of a value sent by the rendezvous protocol, registered for RMA.
+    /// It is shared by all transfers of the image (e.g. to all ranks of a broadcast) and released
+    /// once the last transfer has completed.
+    struct rendezvous_image_t {
+      /// the size of the chunks in which the receiver gets the image
+      static constexpr std::size_t chunk_size = 1024 * 1024;
+
+      std::unique_ptr<unsigned char[]> data;
+      std::size_t size;
+      parsec_ce_mem_reg_handle_t lreg = nullptr;
+      size_t lreg_size = 0;
+
+      explicit rendezvous_image_t(std::size_t size) : data(new unsigned char[size]), size(size) {}
+
+      rendezvous_image_t(const rendezvous_image_t &) = delete;
+      rendezvous_image_t &operator=(const rendezvous_image_t &) = delete;
+
+      /// registers the image for RMA, to be called once the image has been written
+      void expose() {
+        parsec_ce.mem_register(data.get(), PARSEC_MEM_TYPE_NONCONTIGUOUS, size, parsec_datatype_int8_t, size, &lreg,
+                               &lreg_size);
+      }
+
+      /// @return the number of chunks in which the image is transferred
+      int32_t num_chunks() const { return static_cast<int32_t>((size + chunk_size - 1) / chunk_size); }
+
+      ~rendezvous_image_t() {
+        if (nullptr != lreg) parsec_ce.mem_unregister(&lreg);
+      }
+    };
+
+    /// Receives the chunks of a value sent by the rendezvous protocol and activates
+    /// the target tasks once all chunks have arrived.
+    template <typename KeyT, typename ActivationCallbackT>
+    class rendezvous_activate {
+      std::vector<KeyT> _keylist;
+      std::unique_ptr<unsigned char[]> _image;
+      std::size_t _size;
+      parsec_ce_mem_reg_handle_t _lreg;
+      std::atomic<int> _outstanding_chunks;
+      ActivationCallbackT _cb;
+
+     public:
+      rendezvous_activate(std::vector<KeyT> &&keylist, std::size_t size, int num_chunks, ActivationCallbackT cb)
+          : _keylist(std::move(keylist))
+          , _image(new unsigned char[size])
+          , _size(size)
+          , _outstanding_chunks(num_chunks)
+          , _cb(cb) {
+        size_t lreg_size;
+        parsec_ce.mem_register(_image.get(), PARSEC_MEM_TYPE_NONCONTIGUOUS, size, parsec_datatype_int8_t, size, &_lreg,
+                               &lreg_size);
+      }
+
+      ~rendezvous_activate() { parsec_ce.mem_unregister(&_lreg); }
+
+      /// @return the registration handle of the receive buffer
+      parsec_ce_mem_reg_handle_t lreg() const { return _lreg; }
+
+      /// @return true if this was the last chunk, in which case the target tasks have been activated
+      bool complete_chunk(void) {
+        int left = --_outstanding_chunks;
+        if (0 == left) {
+          _cb(std::move(_keylist), _image.get(), _size);
+          return true;
+        }
+        return false;
+      }
+    };
+
+    template <typename ActivationT>
+    static int rendezvous_get_complete_cb(parsec_comm_engine_t *comm_engine, parsec_ce_mem_reg_handle_t lreg,
+                                          ptrdiff_t ldispl, parsec_ce_mem_reg_handle_t rreg, ptrdiff_t rdispl,
+                                          size_t size, int remote, void *cb_data) {
+      bool reset_es = false;
+      // this callback is likely invoked by the comm thread so set the execution stream
+      if (nullptr == parsec_ttg_es) {
+        parsec_ttg_es = &parsec_comm_es;
+        reset_es = true;
+      }
+      /* the receive buffer is registered once for all chunks and released by the activation */
+      ActivationT *activation = static_cast<ActivationT *>(cb_data);
+      if (activation->complete_chunk()) {
+        delete activation;
+      }
+      if (reset_es) {
+        parsec_ttg_es = nullptr;
+      }
+      return PARSEC_SUCCESS;
+    }
+
+    /// Cache of memory registrations for RMA transfers of split-metadata values.
+
+    /// Registrations are keyed by (address, length) and shared by all transfers of the same memory, e.g. when a
+    /// tile is sent to many ranks or re-sent across iterations. The cache holds at most capacity() registrations
+    /// and evicts the least recently used one; a registration is released once it has been evicted (or invalidated)
+    /// and all transfers using it have completed. Registrations are associated with the data copy owning the memory
+    /// and are invalidated when the copy is freed, since the memory could be reused. The registrations are spread
+    /// over independently locked shards, by owner, so that the threads sending different data do not contend. The
+    /// cache must be cleared before the communication engine is finalized, see ttg_finalize().
+    class mem_reg_cache {
+     public:
+      /// the size of the registration handle and the handle, which unregisters the memory when released
+      using registration_t = std::pair<int32_t, std::shared_ptr<void>>;
+
+      static constexpr std::size_t default_capacity = 1024;
+      static constexpr std::size_t num_shards = 16;
+
+      static mem_reg_cache &instance() {
+        static mem_reg_cache cache;
+        return cache;
+      }
+
+      /// @return the registration of memory [ptr, ptr+size) owned by @p owner, registers the memory if needed
+      registration_t acquire(void *ptr, std::size_t size, ttg_data_copy_t *owner) {
+        const key_type key{ptr, size};
+        auto &shard = shard_of(owner);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        auto it = shard.entries.find(key);
+        if (it != shard.entries.end() && it->second.owner == owner) {
+          shard.lru.splice(shard.lru.begin(), shard.lru, it->second.lru_pos);
+          num_hits.fetch_add(1, std::memory_order_relaxed);
+          return it->second.reg;
+        }
+        if (it != shard.entries.end()) shard.erase(it);  // stale, the memory changed owners
+        num_misses.fetch_add(1, std::memory_order_relaxed);
+        parsec_ce_mem_reg_handle_t lreg;
+        size_t lreg_size;
+        parsec_ce.mem_register(ptr, PARSEC_MEM_TYPE_NONCONTIGUOUS, size, parsec_datatype_int8_t, size, &lreg,
+                               &lreg_size);
+        /* TODO: this assumes that parsec_ce_mem_reg_handle_t is void* */
+        registration_t reg{static_cast<int32_t>(lreg_size), std::shared_ptr<void>{lreg, [](void *ptr) {
+                                                              parsec_ce_mem_reg_handle_t memreg =
+                                                                  (parsec_ce_mem_reg_handle_t)ptr;
+                                                              parsec_ce.mem_unregister(&memreg);
+                                                            }}};
+        shard.lru.push_front(key);
+        shard.entries.emplace(key, entry_type{reg, shard.lru.begin(), owner});
+        shard.owners.emplace(owner, key);
+        owner->has_cached_registrations.store(true, std::memory_order_relaxed);
+        shard.trim(shard_capacity());
+        return reg;
+      }
+
+      /// drops the registrations of memory owned by @p owner; must be called before that memory is freed
+      void invalidate(ttg_data_copy_t *owner) {
+        auto &shard = shard_of(owner);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        auto range = shard.owners.equal_range(owner);
+        for (auto it = range.first; it != range.second; ++it) {
+          auto eit = shard.entries.find(it->second);
+          if (eit != shard.entries.end() && eit->second.owner == owner) {
+            shard.lru.erase(eit->second.lru_pos);
+            shard.entries.erase(eit);
+          }
+        }
+        shard.owners.erase(range.first, range.second);
+        owner->has_cached_registrations.store(false, std::memory_order_relaxed);
+      }
+
+      /// drops all registrations; the memory is unregistered once the transfers using it have completed
+      void clear() {
+        for (auto &shard : shards) {
+          std::lock_guard<std::mutex> lock(shard.mtx);
+          shard.trim(0);
+        }
+      }
+
+      /// @return the maximum number of cached registrations
+      std::size_t capacity() const { return max_entries.load(std::memory_order_relaxed); }
+
+      /// sets the maximum number of cached registrations, 0 disables caching
+      void set_capacity(std::size_t capacity) {
+        max_entries.store(capacity, std::memory_order_relaxed);
+        for (auto &shard : shards) {
+          std::lock_guard<std::mutex> lock(shard.mtx);
+          shard.trim(shard_capacity());
+        }
+      }
+
+      /// @return the number of registrations found in the cache
+      std::size_t hits() const { return num_hits; }
+
+      /// @return the number of registrations that had to be created
+      std::size_t misses() const { return num_misses; }
+
+     private:
+      using key_type = std::pair<void *, std::size_t>;
+      struct key_hash {
+        std::size_t operator()(const key_type &key) const {
+          return std::hash<void *>{}(key.first) ^ (std::hash<std::size_t>{}(key.second) << 1);
+        }
+      };
+      struct entry_type {
+        registration_t reg;
+        std::list<key_type>::iterator lru_pos;
+        ttg_data_copy_t *owner;
+      };
+
+      struct alignas(64) shard_type {
+        std::mutex mtx;
+        std::list<key_type> lru;  // most recently used first
+        std::unordered_map<key_type, entry_type, key_hash> entries;
+        std::unordered_multimap<ttg_data_copy_t *, key_type> owners;
+
+        template <typename Iterator>
+        void erase(Iterator it) {
+          auto range = owners.equal_range(it->second.owner);
+          for (auto oit = range.first; oit != range.second; ++oit) {
+            if (oit->second == it->first) {
+              owners.erase(oit);
+              break;
+            }
+          }
+          lru.erase(it->second.lru_pos);
+          entries.erase(it);
+        }
+
+        /// evicts the least recently used registrations until at most @p capacity remain
+        void trim(std::size_t capacity) {
+          while (entries.size() > capacity) erase(entries.find(lru.back()));
+        }
+      };
+
+      mem_reg_cache() = default;
+
+      shard_type &shard_of(const ttg_data_copy_t *owner) {
+        return shards[(reinterpret_cast<std::uintptr_t>(owner) / alignof(ttg_data_copy_t)) % num_shards];
+      }
+
+      /// the capacity of each shard, capacity() rounded up to a multiple of the number of shards
+      std::size_t shard_capacity() const { return (capacity() + num_shards - 1) / num_shards; }
+
+      shard_type shards[num_shards];
+      std::atomic<std::size_t> max_entries = default_capacity;
+      std::atomic<std::size_t> num_hits = 0;
+      std::atomic<std::size_t> num_misses = 0;
+    };
+
     inline void release_data_copy(ttg_data_copy_t *copy) {
+      /* inline copies are destroyed by the task that owns them, see TT::complete_task_and_release */
+      if (copy->is_inline) return;
+
       if (copy->is_mutable()) {
         /* current task mutated the data but there are no consumers so prepare
         * the copy to be freed below */
@@ -914,6 +1186,8 @@ namespace ttg_parsec {
                                             PARSEC_PROFILING_EVENT_COUNTER|PARSEC_PROFILING_EVENT_HAS_INFO);
           }
 #endif
+          if (copy->has_cached_registrations.load(std::memory_order_relaxed))
+            mem_reg_cache::instance().invalidate(copy);
           delete copy;
         }
       }
@@ -1017,6 +1291,55 @@ namespace ttg_parsec {
 
   inline thread_local detail::parsec_ttg_task_base_t *parsec_ttg_caller;
 
+  namespace detail {
+    /// the tasks of the batch executing on this thread, if any (see TT::execute_batch)
+    inline thread_local std::vector<parsec_ttg_task_base_t *> *parsec_ttg_batch = nullptr;
+
+    /// While in scope, makes the task of the batch executing on this thread that holds the data copy of a value the
+    /// caller (see parsec_ttg_caller), so that the values sent by a batched op are tracked by the tasks they belong
+    /// to; the caller is unchanged if no batch is executing or if no task of the batch holds the value.
+    class batch_caller_scope {
+     public:
+      explicit batch_caller_scope(const void *ptr) : saved_caller(parsec_ttg_caller) {
+        if (nullptr == parsec_ttg_batch) return;
+        for (auto *task : *parsec_ttg_batch) {
+          if (find_index_of_copy_in_task(task, ptr) >= 0) {
+            parsec_ttg_caller = task;
+            break;
+          }
+        }
+      }
+      ~batch_caller_scope() { parsec_ttg_caller = saved_caller; }
+      batch_caller_scope(const batch_caller_scope &) = delete;
+      batch_caller_scope &operator=(const batch_caller_scope &) = delete;
+
+     private:
+      parsec_ttg_task_base_t *saved_caller;
+    };
+  }  // namespace detail
+
+  /// Controls the protocol used to send serialized values of type @p T to other ranks.
+
+  /// Values whose serialized size exceeds the threshold are sent by the rendezvous protocol: the sender
+  /// exposes the serialized image for RMA and the receiver gets it in chunks, instead of the image being
+  /// copied into (and out of) the active message. Values too large for an active message always use the
+  /// rendezvous protocol. Does not apply to types with split metadata (see ttg::SplitMetadataDescriptor),
+  /// which are always transferred by RMA, or to TTs with void keys.
+  /// @return reference to the threshold (in bytes) for type @p T
+  template <typename T>
+  inline std::size_t &rendezvous_threshold() {
+    static std::size_t threshold = detail::default_rendezvous_threshold;
+    return threshold;
+  }
+
+  namespace detail {
+    /// @return reference to the number of tasks executed inline (nested) on this thread
+    inline int &parsec_ttg_inline_depth() {
+      static thread_local int depth = 0;
+      return depth;
+    }
+  }  // namespace detail
+
   inline void ttg_initialize(int argc, char **argv, int num_threads, parsec_context_t *ctx) {
     if (detail::initialized_mpi()) throw std::runtime_error("ttg_parsec::ttg_initialize: can only be called once");
 
@@ -1044,6 +1367,7 @@ namespace ttg_parsec {
     if(0 == ttg::default_execution_context().rank())
       ttg::default_execution_context().impl().final_task();
     ttg::detail::set_default_world(ttg::World{});  // reset the default world
+    detail::mem_reg_cache::instance().clear();     // unregisters the memory while the comm engine is up
     ttg::detail::destroy_worlds<ttg_parsec::WorldImpl>();
     if (detail::initialized_mpi()) MPI_Finalize();
   }
@@ -1073,31 +1397,18 @@ namespace ttg_parsec {
 
   inline ttg::Edge<> &ttg_ctl_edge(ttg::World world) { return world.impl().ctl_edge(); }
 
-  inline void ttg_sum(ttg::World world, double &value) {
-    double result = 0.0;
-    MPI_Allreduce(&value, &result, 1, MPI_DOUBLE, MPI_SUM, world.impl().comm());
-    value = result;
+  /// sum over all processes, see ttg::World::allreduce
+  /// @tparam T a serializable type
+  template <typename T>
+  inline void ttg_sum(ttg::World world, T &value) {
+    value = world.allreduce(value, std::plus<>{});
   }
 
-  /// broadcast
+  /// broadcast, see ttg::World::broadcast
   /// @tparam T a serializable type
   template <typename T>
   void ttg_broadcast(::ttg::World world, T &data, int source_rank) {
-    int64_t BUFLEN;
-    if (world.rank() == source_rank) {
-      BUFLEN = ttg::default_data_descriptor<T>::payload_size(&data);
-    }
-    MPI_Bcast(&BUFLEN, 1, MPI_INT64_T, source_rank, world.impl().comm());
-
-    unsigned char *buf = new unsigned char[BUFLEN];
-    if (world.rank() == source_rank) {
-      ttg::default_data_descriptor<T>::pack_payload(&data, BUFLEN, 0, buf);
-    }
-    MPI_Bcast(buf, BUFLEN, MPI_UNSIGNED_CHAR, source_rank, world.impl().comm());
-    if (world.rank() != source_rank) {
-      ttg::default_data_descriptor<T>::unpack_payload(&data, BUFLEN, 0, buf);
-    }
-    delete[] buf;
+    world.broadcast(data, source_rank);
   }
 
   namespace detail {
@@ -1117,6 +1428,93 @@ namespace ttg_parsec {
       msg_t(uint64_t tt_id, uint32_t taskpool_id, msg_header_t::fn_id_t fn_id, int32_t param_id, int num_keys = 1)
           : tt_id{taskpool_id, tt_id, fn_id, param_id, num_keys} {}
     };
+
+    /// Per-thread pool of active message buffers in several size classes.
+
+    /// The communication engine copies the message in send_am, hence a buffer can be recycled as soon as
+    /// send_am returns. Each thread keeps a small number of free buffers per size class so that
+    /// (after warm-up) sending a message does not allocate, and small messages touch small buffers.
+    class msg_buffer_pool {
+     public:
+      /// the buffer sizes (header included); the largest class is the maximum AM size
+      static constexpr std::array<std::size_t, 4> size_classes = {256, 4 * 1024, 64 * 1024,
+                                                                  WorldImpl::PARSEC_TTG_MAX_AM_SIZE};
+      /// the maximum number of free buffers kept per size class and thread
+      static constexpr std::size_t max_cached = 8;
+
+      /// @return the pool of this thread
+      static msg_buffer_pool &instance() {
+        static thread_local msg_buffer_pool pool;
+        return pool;
+      }
+
+      /// @return the index of the smallest size class that holds @p size bytes, or size_classes.size() if none does
+      static std::size_t size_class(std::size_t size) {
+        std::size_t c = 0;
+        while (c < size_classes.size() && size_classes[c] < size) ++c;
+        return c;
+      }
+
+      /// @param c a size class
+      /// @return a buffer of size size_classes[c]
+      void *allocate(std::size_t c) {
+        assert(c < size_classes.size());
+        auto &free_list = free_lists[c];
+        if (!free_list.empty()) {
+          void *buf = free_list.back();
+          free_list.pop_back();
+          return buf;
+        }
+        return ::operator new(size_classes[c]);
+      }
+
+      /// returns @p buf, obtained from allocate(c), to the pool
+      void deallocate(void *buf, std::size_t c) {
+        assert(c < size_classes.size());
+        auto &free_list = free_lists[c];
+        if (free_list.size() < max_cached) {
+          free_list.push_back(buf);
+        } else {
+          ::operator delete(buf);
+        }
+      }
+
+      ~msg_buffer_pool() {
+        for (auto &free_list : free_lists)
+          for (void *buf : free_list) ::operator delete(buf);
+      }
+
+     private:
+      msg_buffer_pool() = default;
+      std::array<std::vector<void *>, size_classes.size()> free_lists;
+    };
+
+    /// returns a message buffer to the pool of the calling thread
+    struct msg_deleter {
+      std::size_t size_class;
+      void operator()(msg_t *msg) const { msg_buffer_pool::instance().deallocate(msg, size_class); }
+    };
+
+    using msg_ptr_t = std::unique_ptr<msg_t, msg_deleter>;
+
+    /// Creates a message whose payload can hold (at least) @p payload_size bytes.
+    /// @note only the first @p payload_size bytes of msg_t::bytes may be accessed
+    /// @throw std::runtime_error if the message exceeds WorldImpl::PARSEC_TTG_MAX_AM_SIZE
+    inline msg_ptr_t make_msg(std::size_t payload_size, uint64_t tt_id, uint32_t taskpool_id,
+                              msg_header_t::fn_id_t fn_id, int32_t param_id, int num_keys = 1) {
+      const auto c = msg_buffer_pool::size_class(sizeof(msg_header_t) + payload_size);
+      if (c == msg_buffer_pool::size_classes.size()) {
+        ttg::print_error("ttg_parsec: message of ", sizeof(msg_header_t) + payload_size,
+                         " bytes exceeds the maximum active message size of ", WorldImpl::PARSEC_TTG_MAX_AM_SIZE,
+                         " bytes");
+        throw std::runtime_error("ttg_parsec: message exceeds the maximum active message size");
+      }
+      void *buf = msg_buffer_pool::instance().allocate(c);
+      /* only construct the header, the payload is written by the packing code */
+      auto *msg = reinterpret_cast<msg_t *>(buf);
+      new (&msg->tt_id) msg_header_t{taskpool_id, tt_id, fn_id, param_id, num_keys};
+      return msg_ptr_t(msg, msg_deleter{c});
+    }
   }  // namespace detail
 
   template <typename keyT, typename output_terminalsT, typename derivedT, typename input_valueTs>
@@ -1240,10 +1638,38 @@ namespace ttg_parsec {
     ttg::meta::detail::input_reducers_t<actual_input_tuple_type>
         input_reducers;  //!< Reducers for the input terminals (empty = expect single value)
     std::array<std::size_t, numins> static_stream_goal;
+    std::array<ttg::ReduceMode, numins> input_reduce_modes = {};  //!< see set_input_reduce_mode()
+    std::array<bool, numins> auto_finalize_streams = {};  //!< see set_argstream_auto_finalize()
+    std::array<int, numins> bcast_tree_degrees{};  //!< degree of the broadcast forwarding tree per input, 0 = flat
+    std::unique_ptr<ttg::detail::dense_table<task_t>> dense_tasks;  //!< replaces tasks_table if set, see set_key_domain()
+    std::function<std::size_t(const std::conditional_t<ttg::meta::is_void_v<keyT>, int, keyT> &)> key_linearizer;
+    ttg::detail::ready_batch_queue<task_t> ready_batch;  //!< the ready tasks, if derivedT has a batched op
     int num_pullins = 0;
 
     bool m_defer_writer = TTG_PARSEC_DEFER_WRITER;
 
+    /// evaluates the keymap: the keymap bound by derivedT if it has bound maps (see ttg::bind_maps), else keymap
+    /// @return the rank of the process that executes the task with key @p key (no argument for void keys)
+    template <typename... Key>
+    int owner_of(const Key &...key) const {
+      if constexpr (ttg::detail::derived_has_bound_maps<derivedT>()) {
+        return static_cast<const derivedT *>(this)->keymap_impl(key...);
+      } else {
+        return keymap(key...);
+      }
+    }
+
+    /// evaluates the priomap: the priomap bound by derivedT if it has bound maps (see ttg::bind_maps), else priomap
+    /// @return the priority of the task with key @p key (no argument for void keys)
+    template <typename... Key>
+    int priority_of(const Key &...key) const {
+      if constexpr (ttg::detail::derived_has_bound_maps<derivedT>()) {
+        return static_cast<const derivedT *>(this)->priomap_impl(key...);
+      } else {
+        return priomap(key...);
+      }
+    }
+
    public:
     ttg::World get_world() const { return world; }
 
@@ -1276,11 +1702,10 @@ namespace ttg_parsec {
     template <std::size_t i, typename Key>
     void get_pull_terminal_data_from(const int owner,
                                      const Key &key) {
-      using msg_t = detail::msg_t;
       auto &world_impl = world.impl();
       parsec_taskpool_t *tp = world_impl.taskpool();
-      std::unique_ptr<msg_t> msg = std::make_unique<msg_t>(get_instance_id(), tp->taskpool_id,
-                                                            msg_header_t::MSG_GET_FROM_PULL, i, 1);
+      auto msg = detail::make_msg(packed_size(key), get_instance_id(), tp->taskpool_id,
+                                  msg_header_t::MSG_GET_FROM_PULL, i, 1);
       /* pack the key */
       size_t pos = 0;
       pos = pack(key, msg->bytes, pos);
@@ -1309,36 +1734,48 @@ namespace ttg_parsec {
     static void static_op(parsec_task_t *parsec_task) {
       task_t *task = (task_t*)parsec_task;
       ttT *baseobj = task->tt;
-      derivedT *obj = static_cast<derivedT *>(baseobj);
-      assert(parsec_ttg_caller == NULL);
-      parsec_ttg_caller = static_cast<detail::parsec_ttg_task_base_t*>(task);
-      if (obj->tracing()) {
-        if constexpr (!ttg::meta::is_void_v<keyT>)
-          ttg::trace(obj->get_world().rank(), ":", obj->get_name(), " : ", task->key, ": executing");
-        else
-          ttg::trace(obj->get_world().rank(), ":", obj->get_name(), " : executing");
-      }
-
-      if constexpr (!ttg::meta::is_void_v<keyT> && !ttg::meta::is_empty_tuple_v<input_values_tuple_type>) {
-        auto input = make_tuple_of_ref_from_array(task, std::make_index_sequence<numinvals>{});
-        baseobj->template op<Space>(task->key, std::move(input), obj->output_terminals);
-      } else if constexpr (!ttg::meta::is_void_v<keyT> && ttg::meta::is_empty_tuple_v<input_values_tuple_type>) {
-        baseobj->template op<Space>(task->key, obj->output_terminals);
-      } else if constexpr (ttg::meta::is_void_v<keyT> && !ttg::meta::is_empty_tuple_v<input_values_tuple_type>) {
-        auto input = make_tuple_of_ref_from_array(task, std::make_index_sequence<numinvals>{});
-        baseobj->template op<Space>(std::move(input), obj->output_terminals);
-      } else if constexpr (ttg::meta::is_void_v<keyT> && ttg::meta::is_empty_tuple_v<input_values_tuple_type>) {
-        baseobj->template op<Space>(obj->output_terminals);
+      if constexpr (ttg::detail::derived_has_batch_op<derivedT>()) {
+        static_assert(Space == ttg::ExecutionSpace::Host, "TT: op_batch can only be executed on the host");
+        baseobj->execute_batch(task);
       } else {
-        abort();
-      }
-      parsec_ttg_caller = NULL;
+        derivedT *obj = static_cast<derivedT *>(baseobj);
+        assert(parsec_ttg_caller == NULL);
+        parsec_ttg_caller = static_cast<detail::parsec_ttg_task_base_t*>(task);
+        if (obj->tracing()) {
+          if constexpr (!ttg::meta::is_void_v<keyT>)
+            ttg::trace(obj->get_world().rank(), ":", obj->get_name(), " : ", task->key, ": executing");
+          else
+            ttg::trace(obj->get_world().rank(), ":", obj->get_name(), " : executing");
+        }
 
-      if (obj->tracing()) {
-        if constexpr (!ttg::meta::is_void_v<keyT>)
-          ttg::trace(obj->get_world().rank(), ":", obj->get_name(), " : ", task->key, ": done executing");
-        else
-          ttg::trace(obj->get_world().rank(), ":", obj->get_name(), " : done executing");
+        ttg::detail::notify_task_observers(task_key(task), [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+          o.task_started(*baseobj, k);
+        });
+        if constexpr (!ttg::meta::is_void_v<keyT> && !ttg::meta::is_empty_tuple_v<input_values_tuple_type>) {
+          auto input = make_tuple_of_ref_from_array(task, std::make_index_sequence<numinvals>{});
+          baseobj->template op<Space>(task->key, std::move(input), obj->output_terminals);
+        } else if constexpr (!ttg::meta::is_void_v<keyT> && ttg::meta::is_empty_tuple_v<input_values_tuple_type>) {
+          baseobj->template op<Space>(task->key, obj->output_terminals);
+        } else if constexpr (ttg::meta::is_void_v<keyT> && !ttg::meta::is_empty_tuple_v<input_values_tuple_type>) {
+          auto input = make_tuple_of_ref_from_array(task, std::make_index_sequence<numinvals>{});
+          baseobj->template op<Space>(std::move(input), obj->output_terminals);
+        } else if constexpr (ttg::meta::is_void_v<keyT> && ttg::meta::is_empty_tuple_v<input_values_tuple_type>) {
+          baseobj->template op<Space>(obj->output_terminals);
+        } else {
+          abort();
+        }
+        ttg::detail::notify_task_observers(task_key(task), [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+          o.task_finished(*baseobj, k);
+        });
+        parsec_ttg_caller = NULL;
+        baseobj->counters().add(ttg::detail::tt_counter_slots::tasks_executed);
+
+        if (obj->tracing()) {
+          if constexpr (!ttg::meta::is_void_v<keyT>)
+            ttg::trace(obj->get_world().rank(), ":", obj->get_name(), " : ", task->key, ": done executing");
+          else
+            ttg::trace(obj->get_world().rank(), ":", obj->get_name(), " : done executing");
+        }
       }
     }
 
@@ -1349,13 +1786,20 @@ namespace ttg_parsec {
       derivedT *obj = (derivedT *)task->object_ptr;
       assert(parsec_ttg_caller == NULL);
       parsec_ttg_caller = task;
+      ttg::detail::notify_task_observers(task_key(task), [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+        o.task_started(*baseobj, k);
+      });
       if constexpr (!ttg::meta::is_void_v<keyT>) {
         baseobj->template op<Space>(task->key, obj->output_terminals);
       } else if constexpr (ttg::meta::is_void_v<keyT>) {
         baseobj->template op<Space>(obj->output_terminals);
       } else
         abort();
+      ttg::detail::notify_task_observers(task_key(task), [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+        o.task_finished(*baseobj, k);
+      });
       parsec_ttg_caller = NULL;
+      baseobj->counters().add(ttg::detail::tt_counter_slots::tasks_executed);
     }
 
    protected:
@@ -1374,6 +1818,142 @@ namespace ttg_parsec {
       return pos + payload_size;
     }
 
+    /// protocol markers preceding a (non-split-metadata) value in a message with keys;
+    /// the *_forward variants are followed by the destinations the receiver forwards the value to (see broadcast_arg)
+    enum class value_protocol : unsigned char { eager = 0, rendezvous = 1, eager_forward = 2, rendezvous_forward = 3 };
+
+    /// destination ranks of a broadcast and the keys each of them owns
+    template <typename Key>
+    using bcast_dests_t = std::vector<std::pair<int, std::vector<Key>>>;
+
+    /// @return true if a serialized value of type @p Value occupying @p value_size bytes is sent by the rendezvous
+    ///         protocol, given that the rest of the message occupies @p other_size bytes
+    template <typename Value>
+    static bool use_rendezvous(std::size_t value_size, std::size_t other_size) {
+      return value_size > rendezvous_threshold<Value>() ||
+             sizeof(msg_header_t) + other_size + sizeof(value_protocol) + value_size >
+                 WorldImpl::PARSEC_TTG_MAX_AM_SIZE;
+    }
+
+    /// serializes @p value into an image exposed for RMA, to be sent by the rendezvous protocol
+    template <typename Value>
+    std::shared_ptr<detail::rendezvous_image_t> make_rendezvous_image(const Value &value) {
+      auto image = std::make_shared<detail::rendezvous_image_t>(packed_size(value));
+      pack(value, image->data.get(), 0);
+      image->expose();
+      return image;
+    }
+
+    /// @return the number of bytes that pack_rendezvous() writes for @p image
+    static std::size_t rendezvous_packed_size(const detail::rendezvous_image_t &image) {
+      return sizeof(uint64_t) + sizeof(uint64_t) + sizeof(int) + sizeof(int32_t) + sizeof(parsec_ce_tag_t) +
+             sizeof(int32_t) + image.lreg_size + image.num_chunks() * sizeof(std::intptr_t);
+    }
+
+    /// Packs the handle of @p image such that the receiver can get it
+    /// memory layout: [size, chunk_size, rank, num_chunks, cbtag, lreg_size, lreg, <release_cb_ptr>...]
+    uint64_t pack_rendezvous(const std::shared_ptr<detail::rendezvous_image_t> &image, unsigned char *bytes,
+                             uint64_t pos) {
+      uint64_t size = image->size;
+      std::memcpy(bytes + pos, &size, sizeof(size));
+      pos += sizeof(size);
+      uint64_t chunk_size = detail::rendezvous_image_t::chunk_size;
+      std::memcpy(bytes + pos, &chunk_size, sizeof(chunk_size));
+      pos += sizeof(chunk_size);
+      int rank = world.rank();
+      std::memcpy(bytes + pos, &rank, sizeof(rank));
+      pos += sizeof(rank);
+      int32_t num_chunks = image->num_chunks();
+      std::memcpy(bytes + pos, &num_chunks, sizeof(num_chunks));
+      pos += sizeof(num_chunks);
+      /* see set_arg_impl: the tag is treated as a raw function pointer by PaRSEC */
+      parsec_ce_tag_t cbtag = reinterpret_cast<parsec_ce_tag_t>(&detail::get_remote_complete_cb);
+      std::memcpy(bytes + pos, &cbtag, sizeof(cbtag));
+      pos += sizeof(cbtag);
+      int32_t lreg_size_i = image->lreg_size;
+      std::memcpy(bytes + pos, &lreg_size_i, sizeof(lreg_size_i));
+      pos += sizeof(lreg_size_i);
+      std::memcpy(bytes + pos, image->lreg, lreg_size_i);
+      pos += lreg_size_i;
+      /* each chunk holds a reference to the image, the last one to complete releases it */
+      for (int32_t c = 0; c < num_chunks; ++c) {
+        std::function<void(void)> *fn = new std::function<void(void)>([image]() mutable { image.reset(); });
+        std::intptr_t fn_ptr{reinterpret_cast<std::intptr_t>(fn)};
+        std::memcpy(bytes + pos, &fn_ptr, sizeof(fn_ptr));
+        pos += sizeof(fn_ptr);
+      }
+      return pos;
+    }
+
+    /// Starts getting the image of a value of type @p Value sent by the rendezvous protocol,
+    /// @return the position past the rendezvous handle in @p bytes
+    /// argument @p i of the tasks @p keylist is set once the image has arrived and the value has been forwarded to
+    /// @p dests
+    template <std::size_t i, typename Value>
+    uint64_t unpack_rendezvous(std::vector<keyT> &&keylist, bcast_dests_t<keyT> &&dests, unsigned char *bytes,
+                               uint64_t pos) {
+      uint64_t size;
+      std::memcpy(&size, bytes + pos, sizeof(size));
+      pos += sizeof(size);
+      this->counters().add_bytes_received(i, size);
+      uint64_t chunk_size;
+      std::memcpy(&chunk_size, bytes + pos, sizeof(chunk_size));
+      pos += sizeof(chunk_size);
+      int remote;
+      std::memcpy(&remote, bytes + pos, sizeof(remote));
+      pos += sizeof(remote);
+      assert(remote < world.size());
+      int32_t num_chunks;
+      std::memcpy(&num_chunks, bytes + pos, sizeof(num_chunks));
+      pos += sizeof(num_chunks);
+      parsec_ce_tag_t cbtag;
+      std::memcpy(&cbtag, bytes + pos, sizeof(cbtag));
+      pos += sizeof(cbtag);
+      int32_t rreg_size_i;
+      std::memcpy(&rreg_size_i, bytes + pos, sizeof(rreg_size_i));
+      pos += sizeof(rreg_size_i);
+      parsec_ce_mem_reg_handle_t rreg = static_cast<parsec_ce_mem_reg_handle_t>(bytes + pos);
+      pos += rreg_size_i;
+
+      auto activation = new detail::rendezvous_activate(
+          std::move(keylist), size, num_chunks,
+          [this, dests = std::move(dests)](std::vector<keyT> &&keylist, unsigned char *image, std::size_t size) {
+            detail::ttg_data_copy_t *copy = detail::create_new_datacopy(Value{});
+            this->counters().add(ttg::detail::tt_counter_slots::data_copies_created);
+            unpack(*static_cast<Value *>(copy->device_private), image, 0);
+            broadcast_tree_send<i>(dests, *static_cast<Value *>(copy->device_private));
+            set_arg_from_msg_keylist<i, Value>(ttg::span<keyT>(keylist.data(), keylist.size()), copy);
+            this->world.impl().decrement_inflight_msg();
+          });
+      using ActivationT = std::decay_t<decltype(*activation)>;
+      auto lreg = activation->lreg();
+
+      world.impl().increment_inflight_msg();
+      for (int32_t c = 0; c < num_chunks; ++c) {
+        std::intptr_t fn_ptr;
+        std::memcpy(&fn_ptr, bytes + pos, sizeof(fn_ptr));
+        pos += sizeof(fn_ptr);
+        const std::size_t offset = c * chunk_size;
+        const std::size_t len = std::min<std::size_t>(chunk_size, size - offset);
+        /* TODO: PaRSEC should treat the remote callback as a tag, not a function pointer! */
+        parsec_ce.get(&parsec_ce, lreg, offset, rreg, offset, len, remote,
+                      &detail::rendezvous_get_complete_cb<ActivationT>, activation, cbtag, &fn_ptr,
+                      sizeof(std::intptr_t));
+      }
+      return pos;
+    }
+
+    /// @return the number of bytes that pack() writes for @p obj
+    template <typename T>
+    uint64_t packed_size(const T &obj) {
+      const ttg_data_descriptor *dObj = ttg::get_data_descriptor<ttg::meta::remove_cvr_t<T>>();
+      uint64_t size = dObj->payload_size(&obj);
+      if constexpr (!ttg::default_data_descriptor<ttg::meta::remove_cvr_t<T>>::serialize_size_is_const) {
+        size += sizeof(uint64_t);
+      }
+      return size;
+    }
+
     template <typename T>
     uint64_t pack(T &obj, void *bytes, uint64_t pos) {
       const ttg_data_descriptor *dObj = ttg::get_data_descriptor<ttg::meta::remove_cvr_t<T>>();
@@ -1431,6 +2011,69 @@ namespace ttg_parsec {
       }
     }
 
+    /// @return the index in dense_tasks of the task with key @p hk
+    std::size_t dense_tasks_index(parsec_key_t hk) const {
+      if constexpr (!ttg::meta::is_void_v<keyT>) {
+        const keyT &key = *reinterpret_cast<const keyT *>(hk);
+        const auto idx = key_linearizer(key);
+        if (idx >= dense_tasks->extent()) {
+          ttg::print_error(world.rank(), ":", get_name(), " : ", key, ": key is outside of the key domain, index ", idx,
+                           " >= ", dense_tasks->extent());
+          throw std::out_of_range("TT: key is outside of the domain declared by set_key_domain");
+        }
+        return idx;
+      } else {
+        return 0;
+      }
+    }
+
+    /* Accessors of the pending tasks, kept in dense_tasks if the key domain was declared or in tasks_table otherwise.
+     * The nolock variants must be called while holding the lock of the task's key. */
+
+    void tasks_table_lock(parsec_key_t hk) {
+      if (dense_tasks)
+        dense_tasks->lock(dense_tasks_index(hk));
+      else
+        parsec_hash_table_lock_bucket(&tasks_table, hk);
+    }
+
+    void tasks_table_unlock(parsec_key_t hk) {
+      if (dense_tasks)
+        dense_tasks->unlock(dense_tasks_index(hk));
+      else
+        parsec_hash_table_unlock_bucket(&tasks_table, hk);
+    }
+
+    task_t *tasks_table_nolock_find(parsec_key_t hk) {
+      if (dense_tasks) return dense_tasks->get(dense_tasks_index(hk));
+      return (task_t *)parsec_hash_table_nolock_find(&tasks_table, hk);
+    }
+
+    void tasks_table_nolock_insert(task_t *task) {
+      if (dense_tasks)
+        dense_tasks->set(dense_tasks_index(task->pkey()), task);
+      else
+        parsec_hash_table_nolock_insert(&tasks_table, &task->tt_ht_item);
+    }
+
+    void tasks_table_nolock_remove(parsec_key_t hk) {
+      if (dense_tasks)
+        dense_tasks->set(dense_tasks_index(hk), nullptr);
+      else
+        parsec_hash_table_nolock_remove(&tasks_table, hk);
+    }
+
+    void tasks_table_remove(parsec_key_t hk) {
+      if (dense_tasks) {
+        const auto idx = dense_tasks_index(hk);
+        dense_tasks->lock(idx);
+        dense_tasks->set(idx, nullptr);
+        dense_tasks->unlock(idx);
+      } else {
+        parsec_hash_table_remove(&tasks_table, hk);
+      }
+    }
+
     /** Returns the task memory pool owned by the calling thread */
     inline parsec_thread_mempool_t *get_task_mempool(void) {
       auto &world_impl = world.impl();
@@ -1478,6 +2121,21 @@ namespace ttg_parsec {
       parsec_thread_mempool_free(mempool, &dummy->parsec_task);
     }
 
+    /// sets argument @p i of the tasks with keys @p keylist to @p value, which is stored inline in the tasks
+    template <size_t i, typename valueT>
+    void set_inline_arg_from_msg_keylist(ttg::span<keyT> &&keylist, const valueT &value) {
+      static_assert(detail::is_inline_value_v<valueT>);
+      parsec_task_t *task_ring = nullptr;
+      for (auto &&key : keylist) {
+        set_arg_local_impl<i>(key, value, nullptr, &task_ring);
+      }
+
+      if (nullptr != task_ring) {
+        auto &world_impl = world.impl();
+        __parsec_schedule(world_impl.execution_stream(), task_ring, 0);
+      }
+    }
+
     // there are 6 types of set_arg:
     // - case 1: nonvoid Key, complete Value type
     // - case 2: nonvoid Key, void Value, mixed (data+control) inputs
@@ -1492,6 +2150,12 @@ namespace ttg_parsec {
       using valueT = std::tuple_element_t<i, actual_input_tuple_type>;
       using msg_t = detail::msg_t;
       msg_t *msg = static_cast<msg_t *>(data);
+      this->counters().add_bytes_received(i, size);
+      const auto message = msg->tt_id.message_id;
+      if constexpr (ttg::meta::is_void_v<keyT>)
+        ttg::detail::notify_task_observers(ttg::Void{}, [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+          o.message_received(*this, k, i, size, message);
+        });
       if constexpr (!ttg::meta::is_void_v<keyT>) {
         /* unpack the keys */
         uint64_t pos = 0;
@@ -1502,17 +2166,44 @@ namespace ttg_parsec {
         for (int k = 0; k < num_keys; ++k) {
           keyT key;
           pos = unpack(key, msg->bytes, pos);
-          assert(keymap(key) == rank);
+          assert(owner_of(key) == rank);
           keylist.push_back(std::move(key));
         }
+        ttg::detail::notify_task_observers(keylist.front(), [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+          o.message_received(*this, k, i, size, message);
+        });
         // case 1
         if constexpr (!ttg::meta::is_void_v<valueT>) {
           using decvalueT = std::decay_t<valueT>;
           if constexpr (!ttg::has_split_metadata<decvalueT>::value) {
-            detail::ttg_data_copy_t *copy = detail::create_new_datacopy(decvalueT{});
-            unpack(*static_cast<decvalueT *>(copy->device_private), msg->bytes, pos);
-
-            set_arg_from_msg_keylist<i, decvalueT>(ttg::span<keyT>(&keylist[0], num_keys), copy);
+            value_protocol protocol;
+            std::memcpy(&protocol, msg->bytes + pos, sizeof(protocol));
+            pos += sizeof(protocol);
+            /* the ranks of the broadcast subtree rooted here, if any */
+            bcast_dests_t<keyT> dests;
+            if (protocol == value_protocol::eager_forward || protocol == value_protocol::rendezvous_forward) {
+              pos = unpack_bcast_dests(dests, msg->bytes, pos);
+            }
+            if (protocol == value_protocol::eager || protocol == value_protocol::eager_forward) {
+              if constexpr (detail::is_inline_value_v<decvalueT>) {
+                /* small values are copied into the tasks, no need for a shared copy */
+                decvalueT value;
+                unpack(value, msg->bytes, pos);
+                broadcast_tree_send<i>(dests, value);
+                set_inline_arg_from_msg_keylist<i>(ttg::span<keyT>(&keylist[0], num_keys), value);
+              } else {
+                detail::ttg_data_copy_t *copy = detail::create_new_datacopy(decvalueT{});
+                this->counters().add(ttg::detail::tt_counter_slots::data_copies_created);
+                unpack(*static_cast<decvalueT *>(copy->device_private), msg->bytes, pos);
+
+                /* forward before activating local tasks, the subtree is waiting for the value */
+                broadcast_tree_send<i>(dests, *static_cast<decvalueT *>(copy->device_private));
+                set_arg_from_msg_keylist<i, decvalueT>(ttg::span<keyT>(&keylist[0], num_keys), copy);
+              }
+            } else {
+              pos = unpack_rendezvous<i, decvalueT>(std::move(keylist), std::move(dests), msg->bytes, pos);
+              assert(size == (pos + sizeof(msg_header_t)));
+            }
           } else {
             /* unpack the header and start the RMA transfers */
             ttg::SplitMetadataDescriptor<decvalueT> descr;
@@ -1537,6 +2228,7 @@ namespace ttg_parsec {
             pos += sizeof(num_iovecs);
 
             detail::ttg_data_copy_t *copy = detail::create_new_datacopy(descr.create_from_metadata(metadata));
+            this->counters().add(ttg::detail::tt_counter_slots::data_copies_created);
             /* nothing else to do if the object is empty */
             if (0 == num_iovecs) {
               set_arg_from_msg_keylist<i, decvalueT>(keylist, copy);
@@ -1579,6 +2271,7 @@ namespace ttg_parsec {
                 size_t lreg_size;
                 parsec_ce.mem_register(iov.data, PARSEC_MEM_TYPE_NONCONTIGUOUS, iov.num_bytes, parsec_datatype_int8_t,
                                        iov.num_bytes, &lreg, &lreg_size);
+                this->counters().add_bytes_received(i, iov.num_bytes);
                 world.impl().increment_inflight_msg();
                 /* TODO: PaRSEC should treat the remote callback as a tag, not a function pointer! */
                 parsec_ce.get(&parsec_ce, lreg, 0, rreg, 0, iov.num_bytes, remote,
@@ -1622,11 +2315,11 @@ namespace ttg_parsec {
         auto rank = world.rank();
         keyT key;
         pos = unpack(key, msg->bytes, pos);
-        assert(keymap(key) == rank);
+        assert(owner_of(key) == rank);
         finalize_argstream<i>(key);
       } else {
         auto rank = world.rank();
-        assert(keymap() == rank);
+        assert(owner_of() == rank);
         finalize_argstream<i>();
       }
     }
@@ -1641,13 +2334,13 @@ namespace ttg_parsec {
         auto rank = world.rank();
         keyT key;
         pos = unpack(key, msg->bytes, pos);
-        assert(keymap(key) == rank);
+        assert(owner_of(key) == rank);
         std::size_t argstream_size;
         pos = unpack(argstream_size, msg->bytes, pos);
         set_argstream_size<i>(key, argstream_size);
       } else {
         auto rank = world.rank();
-        assert(keymap() == rank);
+        assert(owner_of() == rank);
         std::size_t argstream_size;
         pos = unpack(argstream_size, msg->bytes, pos);
         set_argstream_size<i>(argstream_size);
@@ -1698,6 +2391,14 @@ namespace ttg_parsec {
       set_arg_local_impl<i>(ttg::Void{}, *valueptr);
     }
 
+    /// @return the key of @p task, from which the events of the task observers build their ttg::TaskKey
+    static decltype(auto) task_key(const task_t *task) {
+      if constexpr (!ttg::meta::is_void_v<keyT>)
+        return (task->key);
+      else
+        return ttg::Void{};
+    }
+
     template <typename Key>
     task_t *create_new_task(const Key &key) {
       constexpr const bool keyT_is_Void = ttg::meta::is_void_v<keyT>;
@@ -1705,13 +2406,13 @@ namespace ttg_parsec {
       task_t *newtask;
       parsec_thread_mempool_t *mempool = get_task_mempool();
       char *taskobj = (char *)parsec_thread_mempool_allocate(mempool);
-      int32_t priority = 0;
+      int32_t priority;
       if constexpr (!keyT_is_Void) {
-        //priority = priomap(key);
+        priority = priority_of(key);
         /* placement-new the task */
         newtask = new (taskobj) task_t(key, mempool, &this->self, world_impl.taskpool(), this, priority);
       } else {
-        //priority = priomap();
+        priority = priority_of();
         /* placement-new the task */
         newtask = new (taskobj) task_t(mempool, &this->self, world_impl.taskpool(), this, priority);
       }
@@ -1726,10 +2427,165 @@ namespace ttg_parsec {
         newtask->stream[i].goal = static_stream_goal[i];
       }
 
+      newtask->charge = ttg::detail::budget_charge(&this->memory_budget(), &world_impl.budget());
+      this->counters().add(ttg::detail::tt_counter_slots::tasks_created);
+      ttg::detail::notify_task_observers(key, [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+        o.task_created(*this, k);
+      });
+
       ttg::trace(world.rank(), ":", get_name(), " : ", key, ": creating task");
       return newtask;
     }
 
+    /// @return true if the tasks are counted in the taskpool once ready rather than once created: tasks awaiting the
+    ///         finalization of a stream by the runtime must not prevent the taskpool from completing, see
+    ///         set_argstream_auto_finalize
+    bool counts_tasks_when_ready() const {
+      return std::find(auto_finalize_streams.begin(), auto_finalize_streams.end(), true) != auto_finalize_streams.end();
+    }
+
+    /// counts a task that was just created in the taskpool, unless counted once ready
+    void count_new_task() {
+      if (!counts_tasks_when_ready()) world.impl().increment_created();
+    }
+
+    /// defers the calling producer while the memory budget of this TT or of the world is exceeded, see
+    /// TTBase::set_max_pending_tasks
+    void throttle() { ttg::detail::throttle(this->memory_budget(), world.impl().budget()); }
+
+    using task_key_t = std::conditional_t<ttg::meta::is_void_v<keyT>, ttg::Void, keyT>;
+
+    /// @return true if a streaming input of @p task finalized by the runtime received values but was neither bounded
+    ///         nor finalized
+    bool awaits_finalization(const task_t *task) const {
+      for (std::size_t i = 0; i < numins; ++i)
+        if (auto_finalize_streams[i] && task->stream[i].goal == 0 && task->stream[i].size > 0) return true;
+      return false;
+    }
+
+    struct awaiting_keys_t {
+      ttT *op;
+      std::vector<task_key_t> keys;
+    };
+
+    static void awaiting_iter_cb(void *item, void *cb_data) {
+      task_t *task = (task_t *)item;
+      awaiting_keys_t *awaiting = (awaiting_keys_t *)cb_data;
+      if (!awaiting->op->awaits_finalization(task)) return;
+      if constexpr (!ttg::meta::is_void_v<keyT>) {
+        awaiting->keys.push_back(task->key);
+      } else {
+        awaiting->keys.push_back(ttg::Void{});
+      }
+    }
+
+    /// @return the keys of the pending tasks with streams awaiting finalization by the runtime; the taskpool must be
+    ///         quiescent
+    std::vector<task_key_t> keys_awaiting_finalization() {
+      awaiting_keys_t awaiting{this, {}};
+      parsec_hash_table_for_all(&tasks_table, awaiting_iter_cb, &awaiting);
+      if (dense_tasks) {
+        dense_tasks->for_each([&awaiting](std::size_t idx, task_t *task) { awaiting_iter_cb(task, &awaiting); });
+      }
+      return std::move(awaiting.keys);
+    }
+
+    /// finalizes streaming input @p i of the task with key @p key if the runtime finalizes it and it awaits it
+    template <std::size_t i>
+    void finalize_awaiting_stream(const task_key_t &key) {
+      if (!auto_finalize_streams[i]) return;
+      parsec_key_t hk = 0;
+      if constexpr (!ttg::meta::is_void_v<keyT>) hk = reinterpret_cast<parsec_key_t>(&key);
+      tasks_table_lock(hk);
+      task_t *task = tasks_table_nolock_find(hk);
+      const bool awaits = nullptr != task && task->stream[i].goal == 0 && task->stream[i].size > 0;
+      tasks_table_unlock(hk);
+      if (!awaits) return;
+      if constexpr (ttg::meta::is_void_v<keyT>) {
+        finalize_argstream<i>();
+      } else {
+        finalize_argstream<i>(key);
+      }
+    }
+
+    /// finalizes the streams awaiting finalization by the runtime, called by the world once it is quiescent
+    template <std::size_t... Is>
+    void finalize_awaiting_streams(std::index_sequence<Is...>) {
+      for (const auto &key : keys_awaiting_finalization()) (finalize_awaiting_stream<Is>(key), ...);
+    }
+
+    /// @return true if the values of streaming input @p i are reduced by an accumulator, see set_input_reduce_mode
+    template <std::size_t i>
+    bool reduces_without_lock() const {
+      if constexpr (ttg::meta::is_void_v<std::tuple_element_t<i, input_values_full_tuple_type>>) {
+        return false;  // control inputs are always reduced under the lock
+      } else {
+        return input_reduce_modes[i] != ttg::ReduceMode::Locked;
+      }
+    }
+
+    /// moves the value reduced by the accumulator of streaming input @p i into a data copy of @p task and destroys
+    /// the accumulator; the stream must be complete, with no reductions in flight
+    template <std::size_t i>
+    void take_reduced_value(task_t *task) {
+      auto &accumulator = std::get<i>(task->accumulators);
+      using valueT = std::decay_t<std::tuple_element_t<i, input_values_full_tuple_type>>;
+      if constexpr (!ttg::meta::is_void_v<valueT>) {
+        if (accumulator->has_value()) {
+          detail::ttg_data_copy_t *copy;
+          if constexpr (detail::is_inline_value_v<valueT>) {
+            copy = std::get<i>(task->inline_values).emplace(accumulator->take(std::get<i>(input_reducers)));
+          } else {
+            copy = detail::create_new_datacopy(accumulator->take(std::get<i>(input_reducers)));
+          }
+          this->counters().add(ttg::detail::tt_counter_slots::data_copies_created);
+          task->parsec_task.data[i].data_in = copy;
+        }
+      }
+      accumulator.reset();
+    }
+
+    /// completes streaming input @p i of @p task, to be called once the expected number of values was received
+    /// @return false if values of the input are still being reduced, in which case the last of these reductions
+    ///         completes the input (see set_arg_local_impl)
+    template <std::size_t i>
+    bool complete_stream(task_t *task) {
+      auto &accumulator = std::get<i>(task->accumulators);
+      if (!accumulator) return true;
+      if (!accumulator->complete()) return false;
+      take_reduced_value<i>(task);
+      return true;
+    }
+
+    /// reduces @p value received by streaming input @p i of @p task with its accumulator: the value is counted
+    /// under the lock of the task, which is released by the time the value is reduced
+    /// @return true if this thread completed the input, i.e. the task must be released
+    template <std::size_t i, typename Value>
+    bool reduce_without_lock(parsec_key_t hk, task_t *task, Value &&value) {
+      using valueT = std::decay_t<std::tuple_element_t<i, input_values_full_tuple_type>>;
+      if constexpr (!ttg::meta::is_void_v<valueT>) {
+        auto &accumulator = std::get<i>(task->accumulators);
+        tasks_table_lock(hk);
+        if (!accumulator) {
+          accumulator = std::make_unique<ttg::detail::stream_accumulator<valueT>>(input_reduce_modes[i]);
+        }
+        accumulator->begin();
+        task->stream[i].size++;
+        const bool stream_complete = (task->stream[i].size == task->stream[i].goal);
+        tasks_table_unlock(hk);
+
+        /* the task cannot be released before the accumulator reports the last reduction */
+        accumulator->reduce(std::forward<Value>(value), std::get<i>(input_reducers));
+        this->counters().add(ttg::detail::tt_counter_slots::reducer_calls);
+        bool last = accumulator->end();
+        if (stream_complete && accumulator->complete()) last = true;
+        if (last) take_reduced_value<i>(task);
+        return last;
+      } else {
+        abort();  // control inputs are always reduced under the lock
+      }
+    }
+
     // Used to set the i'th argument
     template <std::size_t i, typename Key, typename Value>
     void set_arg_local_impl(const Key &key, Value &&value, detail::ttg_data_copy_t *copy_in = nullptr,
@@ -1749,8 +2605,23 @@ namespace ttg_parsec {
       parsec_key_t hk = 0;
       if constexpr (!keyT_is_Void) {
         hk = reinterpret_cast<parsec_key_t>(&key);
-        assert(keymap(key) == world.rank());
+        assert(owner_of(key) == world.rank());
       }
+      this->counters().add(ttg::detail::tt_counter_slots::set_arg_local);
+
+      if constexpr (numins == 1 && !keyT_is_Void && !derived_has_cuda_op() &&
+                    !ttg::detail::derived_has_batch_op<derivedT>()) {
+        if (nullptr == copy_in && nullptr == task_ring && executes_fused(key)) {
+          execute_fused(key, std::forward<Value>(value));
+          return;
+        }
+      }
+
+      /* a task producing this input is deferred while the pending tasks exceed their budget */
+      if (nullptr != parsec_ttg_caller && !parsec_ttg_caller->dummy()) throttle();
+      ttg::detail::notify_task_observers(key, [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+        o.input_arrived(*this, k, i);
+      });
 
       task_t *task;
       auto &world_impl = world.impl();
@@ -1761,11 +2632,11 @@ namespace ttg_parsec {
       bool get_pull_data = false;
       /* If we have only one input and no reducer on that input we can skip the hash table */
       if (numins > 1 || reducer) {
-        parsec_hash_table_lock_bucket(&tasks_table, hk);
-        if (nullptr == (task = (task_t *)parsec_hash_table_nolock_find(&tasks_table, hk))) {
+        tasks_table_lock(hk);
+        if (nullptr == (task = tasks_table_nolock_find(hk))) {
           task = create_new_task(key);
-          world_impl.increment_created();
-          parsec_hash_table_nolock_insert(&tasks_table, &task->tt_ht_item);
+          count_new_task();
+          tasks_table_nolock_insert(task);
           get_pull_data = !is_lazy_pull();
           if( world_impl.dag_profiling() ) {
 #if defined(PARSEC_PROF_GRAPHER)
@@ -1775,13 +2646,13 @@ namespace ttg_parsec {
           }
         } else if (!reducer && numins == (task->in_data_count + 1)) {
           /* remove while we have the lock */
-          parsec_hash_table_nolock_remove(&tasks_table, hk);
+          tasks_table_nolock_remove(hk);
           remove_from_hash = false;
         }
-        parsec_hash_table_unlock_bucket(&tasks_table, hk);
+        tasks_table_unlock(hk);
       } else {
         task = create_new_task(key);
-        world_impl.increment_created();
+        count_new_task();
         remove_from_hash = false;
         if( world_impl.dag_profiling() ) {
 #if defined(PARSEC_PROF_GRAPHER)
@@ -1812,33 +2683,47 @@ namespace ttg_parsec {
 #endif
       }
 
-      if (reducer) {  // is this a streaming input? reduce the received value
+      const bool reduced_without_lock = reducer && reduces_without_lock<i>();
+      if (reduced_without_lock) {  // is this a streaming input reduced without locking?
+        /* the input is complete, and the task may be released, only after the last reduction;
+         * the task must not be touched otherwise, it may be released by another thread at any time */
+        release = reduce_without_lock<i>(hk, task, std::forward<Value>(value));
+      } else if (reducer) {  // is this a streaming input? reduce the received value
         // N.B. Right now reductions are done eagerly, without spawning tasks
         //      this means we must lock
-        parsec_hash_table_lock_bucket(&tasks_table, hk);
+        tasks_table_lock(hk);
 
         if constexpr (!ttg::meta::is_void_v<valueT>) {  // for data values
           // have a value already? if not, set, otherwise reduce
           detail::ttg_data_copy_t *copy = nullptr;
           if (nullptr == (copy = static_cast<detail::ttg_data_copy_t *>(task->parsec_task.data[i].data_in))) {
+            task->charge.add_bytes(ttg::footprint(value));
             using decay_valueT = std::decay_t<valueT>;
-            /* For now, we always create a copy because we cannot rely on the task_release
-             * mechanism (it would release the task, not the reduction value). */
-            copy = detail::create_new_datacopy(std::forward<Value>(value));
+            if constexpr (detail::is_inline_value_v<decay_valueT>) {
+              /* small values are reduced in the storage of the task */
+              copy = std::get<i>(task->inline_values).emplace(std::forward<Value>(value));
+            } else {
+              /* For now, we always create a copy because we cannot rely on the task_release
+               * mechanism (it would release the task, not the reduction value). */
+              copy = detail::create_new_datacopy(std::forward<Value>(value));
+            }
+            count_data_copy<Value>();
             task->parsec_task.data[i].data_in = copy;
           } else {
             reducer(*reinterpret_cast<std::decay_t<valueT> *>(copy->device_private), value);
+            this->counters().add(ttg::detail::tt_counter_slots::reducer_calls);
           }
         } else {
           reducer();  // even if this was a control input, must execute the reducer for possible side effects
+          this->counters().add(ttg::detail::tt_counter_slots::reducer_calls);
         }
         task->stream[i].size++;
         release = (task->stream[i].size == task->stream[i].goal);
         if (release) {
-          parsec_hash_table_nolock_remove(&tasks_table, hk);
+          tasks_table_nolock_remove(hk);
           remove_from_hash = false;
         }
-        parsec_hash_table_unlock_bucket(&tasks_table, hk);
+        tasks_table_unlock(hk);
       } else {
         /* whether the task needs to be deferred or not */
         if constexpr (!valueT_is_Void) {
@@ -1847,25 +2732,36 @@ namespace ttg_parsec {
             throw std::logic_error("bad set arg");
           }
 
-          detail::ttg_data_copy_t *copy = copy_in;
-          if (nullptr == copy_in && nullptr != parsec_ttg_caller) {
-            copy = detail::find_copy_in_task(parsec_ttg_caller, &value);
-          }
-
-          if (nullptr != copy) {
-            /* register_data_copy might provide us with a different copy if !input_is_const */
-            copy = detail::register_data_copy<valueT>(copy, task, input_is_const);
+          task->charge.add_bytes(ttg::footprint(value));
+          detail::ttg_data_copy_t *copy = nullptr;
+          if constexpr (detail::is_inline_value_v<valueT>) {
+            /* small values are copied into the task, regardless of where they came from */
+            copy = std::get<i>(task->inline_values).emplace(std::forward<Value>(value));
+            count_data_copy<Value>();
           } else {
-            copy = detail::create_new_datacopy(std::forward<Value>(value));
+            copy = copy_in;
+            if (nullptr == copy_in && nullptr != parsec_ttg_caller) {
+              copy = detail::find_copy_in_task(parsec_ttg_caller, &value);
+            }
+
+            if (nullptr != copy) {
+              /* register_data_copy might provide us with a different copy if !input_is_const */
+              auto *registered = detail::register_data_copy<valueT>(copy, task, input_is_const);
+              if (registered != copy) count_data_copy<const Value &>();
+              copy = registered;
+            } else {
+              copy = detail::create_new_datacopy(std::forward<Value>(value));
+              count_data_copy<Value>();
+            }
+            /* if we registered as a writer and were the first to register with this copy
+             * we need to defer the release of this task to give other tasks a chance to
+             * make a copy of the original data */
+            release = (copy->push_task != &task->parsec_task);
           }
-          /* if we registered as a writer and were the first to register with this copy
-           * we need to defer the release of this task to give other tasks a chance to
-           * make a copy of the original data */
-          release = (copy->push_task != &task->parsec_task);
           task->parsec_task.data[i].data_in = copy;
         }
       }
-      task->remove_from_hash = remove_from_hash;
+      if (!reduced_without_lock) task->remove_from_hash = remove_from_hash;
       if (release) {
         release_task(task, task_ring);
       }
@@ -1877,6 +2773,158 @@ namespace ttg_parsec {
       }
     }
 
+    /// counts a data copy created from a value of type @p Value, deep copied unless @p Value is a non-const rvalue
+    template <typename Value>
+    void count_data_copy() {
+      this->counters().add(ttg::detail::tt_counter_slots::data_copies_created);
+      if constexpr (!std::is_rvalue_reference_v<Value &&> || std::is_const_v<std::remove_reference_t<Value>>)
+        this->counters().add(ttg::detail::tt_counter_slots::data_copies_deep_copied);
+    }
+
+    /// @return true if a task of this TT that was just made ready can be executed on this thread,
+    ///         according to the execution policy (see TTBase::set_execution_policy)
+    bool can_execute_inline() const {
+      if constexpr (derived_has_cuda_op()) {
+        return false;  // device tasks may complete asynchronously
+      } else if constexpr (ttg::detail::derived_has_batch_op<derivedT>()) {
+        return false;  // ready tasks are executed in batches, see execute_batch
+      } else {
+        const auto &policy = this->get_execution_policy();
+        /* inline only from within a (non-dummy) task, the calling task counts towards the depth */
+        return policy && *policy == ttg::Execution::Inline && nullptr != parsec_ttg_caller &&
+               !parsec_ttg_caller->dummy() && detail::parsec_ttg_inline_depth() + 1 < this->get_max_inline_depth();
+      }
+    }
+
+    /// @return true if the task with key @p key, which is local, is executed by the task executing on this thread,
+    ///         see TTBase::set_fused
+    bool executes_fused(const keyT &key) const {
+      if (!this->is_fused() || std::get<0>(input_reducers) || num_pullins > 0) return false;
+      if (nullptr == parsec_ttg_caller || parsec_ttg_caller->dummy() ||
+          detail::parsec_ttg_inline_depth() + 1 >= this->get_max_inline_depth())
+        return false;
+      /* the type and the address of the key of the caller are stored in its locals, see parsec_ttg_task_t */
+      const auto caller_key_type = *reinterpret_cast<uintptr_t *>(&parsec_ttg_caller->parsec_task.locals[4]);
+      if (caller_key_type != reinterpret_cast<uintptr_t>(ttg::meta::type_id<keyT>())) return false;
+      const auto *caller_key = *reinterpret_cast<keyT **>(&parsec_ttg_caller->parsec_task.locals[2]);
+      return *caller_key == key;
+    }
+
+    /// executes the task with key @p key and input @p value immediately, without creating it, see TTBase::set_fused;
+    /// the task is part of the caller, which remains parsec_ttg_caller and owns the data copies it sends
+    template <typename Value>
+    void execute_fused(const keyT &key, Value &&value) {
+      if (tracing()) {
+        ttg::trace(world.rank(), ":", get_name(), " : ", key, ": executing fused task");
+      }
+      /* the fused task is not part of the batch of the caller, if any, see detail::batch_caller_scope */
+      auto parsec_ttg_batch_save = std::exchange(detail::parsec_ttg_batch, nullptr);
+      ++detail::parsec_ttg_inline_depth();
+      ttg::detail::notify_task_observers(key, [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+        o.task_started(*this, k);
+      });
+      if constexpr (!ttg::meta::is_empty_tuple_v<input_values_tuple_type>) {
+        using input_ref_type = std::tuple_element_t<0, input_refs_tuple_type>;
+        constexpr bool can_bind_value =
+            std::is_const_v<std::remove_reference_t<input_ref_type>> ||
+            (std::is_rvalue_reference_v<Value &&> && !std::is_const_v<std::remove_reference_t<Value>>);
+        if constexpr (can_bind_value) {
+          this->template op<ttg::ExecutionSpace::Host>(key, input_refs_tuple_type{value}, output_terminals);
+        } else {
+          std::decay_t<Value> copy(value);  // the task consumes its input
+          this->template op<ttg::ExecutionSpace::Host>(key, input_refs_tuple_type{copy}, output_terminals);
+        }
+      } else {
+        this->template op<ttg::ExecutionSpace::Host>(key, output_terminals);
+      }
+      ttg::detail::notify_task_observers(key, [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+        o.task_finished(*this, k);
+      });
+      --detail::parsec_ttg_inline_depth();
+      detail::parsec_ttg_batch = parsec_ttg_batch_save;
+      // counted as created, like its input is counted by set_arg_local
+      this->counters().add(ttg::detail::tt_counter_slots::tasks_created);
+      this->counters().add(ttg::detail::tt_counter_slots::tasks_executed);
+      this->counters().add(ttg::detail::tt_counter_slots::tasks_inlined);
+    }
+
+    /// executes a ready task immediately on this thread, bypassing the scheduler
+    void execute_inline(parsec_execution_stream_t *es, task_t *task) {
+      if (tracing()) {
+        if constexpr (!ttg::meta::is_void_v<keyT>) {
+          ttg::trace(world.rank(), ":", get_name(), " : ", task->key, ": executing task inline");
+        } else {
+          ttg::trace(world.rank(), ":", get_name(), ": executing task inline");
+        }
+      }
+      /* the inlined task becomes the caller while it executes, outside of the batch of the caller if any */
+      auto parsec_ttg_caller_save = parsec_ttg_caller;
+      auto parsec_ttg_batch_save = std::exchange(detail::parsec_ttg_batch, nullptr);
+      parsec_ttg_caller = nullptr;
+      ++detail::parsec_ttg_inline_depth();
+      __parsec_execute(es, &task->parsec_task);
+      /* releases the task's data copies and returns the task to its mempool */
+      __parsec_complete_execution(es, &task->parsec_task);
+      --detail::parsec_ttg_inline_depth();
+      parsec_ttg_caller = parsec_ttg_caller_save;
+      detail::parsec_ttg_batch = parsec_ttg_batch_save;
+      this->counters().add(ttg::detail::tt_counter_slots::tasks_inlined);  // executed by static_op
+    }
+
+    /// executes the batch of ready tasks led by @p leader with derivedT::op_batch; the leader is completed by PaRSEC
+    /// when the hook returns, the other tasks of the batch are completed here, as if they were executed inline
+    void execute_batch(task_t *leader) {
+      static_assert(!ttg::meta::is_void_v<keyT>, "TT: op_batch requires a non-void key type");
+      parsec_execution_stream_t *es = world.impl().execution_stream();
+      std::vector<task_t *> batch;
+      auto *next_leader = ready_batch.pop(batch, this->get_max_batch_size(), this->get_batch_linger());
+      assert(batch.front() == leader);
+      if (nullptr != next_leader) __parsec_schedule(es, &next_leader->parsec_task, 0);
+      if (tracing()) {
+        ttg::trace(world.rank(), ":", get_name(), " : executing a batch of ", batch.size(), " tasks");
+      }
+
+      std::vector<keyT> keys;
+      std::vector<detail::parsec_ttg_task_base_t *> callers;
+      keys.reserve(batch.size());
+      callers.reserve(batch.size());
+      for (auto *task : batch) {
+        keys.push_back(task->key);
+        callers.push_back(task);
+      }
+      const ttg::span<const keyT> keys_span(keys.data(), keys.size());
+      /* the values sent by op_batch are tracked by the task of the batch they belong to (see
+       * detail::batch_caller_scope), the leader tracks the others */
+      assert(parsec_ttg_caller == NULL);
+      parsec_ttg_caller = static_cast<detail::parsec_ttg_task_base_t *>(leader);
+      detail::parsec_ttg_batch = &callers;
+      for (auto &&key : keys)
+        ttg::detail::notify_task_observers(key, [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+          o.task_started(*this, k);
+        });
+      if constexpr (!ttg::meta::is_empty_tuple_v<input_values_tuple_type>) {
+        std::vector<input_refs_tuple_type> inputs;
+        inputs.reserve(batch.size());
+        for (auto *task : batch)
+          inputs.emplace_back(make_tuple_of_ref_from_array(task, std::make_index_sequence<numinvals>{}));
+        static_cast<derivedT *>(this)->op_batch(
+            keys_span, ttg::span<input_refs_tuple_type>(inputs.data(), inputs.size()), output_terminals);
+      } else {
+        static_cast<derivedT *>(this)->op_batch(keys_span, output_terminals);
+      }
+      // in the reverse order of the starts, so that the tasks of the batch nest on this thread
+      for (auto key = keys.rbegin(); key != keys.rend(); ++key)
+        ttg::detail::notify_task_observers(*key, [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+          o.task_finished(*this, k);
+        });
+      detail::parsec_ttg_batch = nullptr;
+      parsec_ttg_caller = NULL;
+      this->counters().add(ttg::detail::tt_counter_slots::tasks_executed, batch.size());
+
+      /* releases the data copies of the other tasks and returns them to their mempools */
+      for (std::size_t b = 1; b < batch.size(); ++b) __parsec_complete_execution(es, &batch[b]->parsec_task);
+    }
+
     void release_task(task_t *task,
                       parsec_task_t **task_ring = nullptr) {
       constexpr const bool keyT_is_Void = ttg::meta::is_void_v<keyT>;
@@ -1905,9 +2953,25 @@ namespace ttg_parsec {
             ttg::trace(world.rank(), ":", get_name(), ": submitting task for op ");
           }
         }
-        if (task->remove_from_hash) parsec_hash_table_remove(&tasks_table, hk);
+        if (task->remove_from_hash) tasks_table_remove(hk);
+        ttg::detail::notify_task_observers(task_key(task), [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+          o.task_ready(*this, k);
+        });
+        if (counts_tasks_when_ready()) {
+          /* the task was not counted when created, possibly in the taskpool of an earlier fence epoch */
+          task->parsec_task.taskpool = world_impl.taskpool();
+          world_impl.increment_created();
+        }
+        if constexpr (ttg::detail::derived_has_batch_op<derivedT>()) {
+          /* only the leader of the ready tasks is scheduled, it executes the other tasks of its batch */
+          if (!ready_batch.push(task)) return;
+        }
         if (nullptr == task_ring) {
-          __parsec_schedule(es, &task->parsec_task, 0);
+          if (can_execute_inline()) {
+            execute_inline(es, task);
+          } else {
+            __parsec_schedule(es, &task->parsec_task, 0);
+          }
         } else if (*task_ring == nullptr) {
           /* the first task is set directly */
           *task_ring = &task->parsec_task;
@@ -1951,6 +3015,7 @@ namespace ttg_parsec {
     // Used to set the i'th argument
     template <std::size_t i, typename Key, typename Value>
     void set_arg_impl(const Key &key, Value &&value) {
+      detail::batch_caller_scope caller_scope(&value);
       int owner;
 
 #if defined(PARSEC_PROF_TRACE) && defined(PARSEC_TTG_PROFILE_BACKEND)
@@ -1960,9 +3025,9 @@ namespace ttg_parsec {
 #endif
 
       if constexpr (!ttg::meta::is_void_v<Key>)
-        owner = keymap(key);
+        owner = owner_of(key);
       else
-        owner = keymap();
+        owner = owner_of();
       if (owner == world.rank()) {
         if constexpr (!ttg::meta::is_void_v<keyT>)
           set_arg_local<i, keyT, Value>(key, std::forward<Value>(value));
@@ -1978,12 +3043,29 @@ namespace ttg_parsec {
       // the target task is remote. Pack the information and send it to
       // the corresponding peer.
       // TODO do we need to copy value?
-      using msg_t = detail::msg_t;
       auto &world_impl = world.impl();
       uint64_t pos = 0;
-      std::unique_ptr<msg_t> msg = std::make_unique<msg_t>(get_instance_id(), world_impl.taskpool()->taskpool_id,
-                                                           msg_header_t::MSG_SET_ARG, i, 1);
+      std::size_t nbytes_rma = 0;  // bytes the owner gets by RMA, rather than in the message
       using decvalueT = std::decay_t<Value>;
+      /* size the message buffer: split-metadata values carry registration handles of unknown size */
+      std::size_t payload_size = 0;
+      std::shared_ptr<detail::rendezvous_image_t> image;  // set if the value is sent by the rendezvous protocol
+      if constexpr (!ttg::meta::is_void_v<Key>) payload_size += packed_size(key);
+      if constexpr (!ttg::meta::is_void_v<decvalueT>) {
+        if constexpr (!ttg::has_split_metadata<decvalueT>::value) {
+          const auto value_size = packed_size(value);
+          if constexpr (!ttg::meta::is_void_v<Key>) {
+            if (use_rendezvous<decvalueT>(value_size, payload_size)) image = make_rendezvous_image(value);
+            payload_size += sizeof(value_protocol) + (image ? rendezvous_packed_size(*image) : value_size);
+          } else {
+            payload_size += value_size;
+          }
+        } else {
+          payload_size = WorldImpl::PARSEC_TTG_MAX_AM_SIZE - sizeof(msg_header_t);
+        }
+      }
+      auto msg = detail::make_msg(payload_size, get_instance_id(), world_impl.taskpool()->taskpool_id,
+                                  msg_header_t::MSG_SET_ARG, i, 1);
       /* pack the key */
       msg->tt_id.num_keys = 0;
       if constexpr (!ttg::meta::is_void_v<Key>) {
@@ -1993,13 +3075,26 @@ namespace ttg_parsec {
 
       if constexpr (!ttg::meta::is_void_v<decvalueT>) {
         if constexpr (!ttg::has_split_metadata<decvalueT>::value) {
-          pos = pack(value, msg->bytes, pos);
+          if constexpr (!ttg::meta::is_void_v<Key>) {
+            const auto protocol = image ? value_protocol::rendezvous : value_protocol::eager;
+            std::memcpy(msg->bytes + pos, &protocol, sizeof(protocol));
+            pos += sizeof(protocol);
+            if (image) {
+              pos = pack_rendezvous(image, msg->bytes, pos);
+              nbytes_rma = image->size;
+            } else {
+              pos = pack(value, msg->bytes, pos);
+            }
+          } else {
+            pos = pack(value, msg->bytes, pos);
+          }
         } else {
           detail::ttg_data_copy_t *copy;
           copy = detail::find_copy_in_task(parsec_ttg_caller, &value);
           if (nullptr == copy) {
             // We need to create a copy for this data, as it does not exist yet.
             copy = detail::create_new_datacopy(std::forward<Value>(value));
+            count_data_copy<Value>();
           }
           copy = detail::register_data_copy<decvalueT>(copy, nullptr, true);
 
@@ -2032,19 +3127,14 @@ namespace ttg_parsec {
            * memory layout: [<lreg_size, lreg, release_cb_ptr>, ...]
            */
           for (auto &&iov : iovecs) {
-            parsec_ce_mem_reg_handle_t lreg;
-            size_t lreg_size;
-            /* TODO: only register once when we can broadcast the data! */
-            parsec_ce.mem_register(iov.data, PARSEC_MEM_TYPE_NONCONTIGUOUS, iov.num_bytes, parsec_datatype_int8_t,
-                                   iov.num_bytes, &lreg, &lreg_size);
-            auto lreg_ptr = std::shared_ptr<void>{lreg, [](void *ptr) {
-                                                    parsec_ce_mem_reg_handle_t memreg = (parsec_ce_mem_reg_handle_t)ptr;
-                                                    parsec_ce.mem_unregister(&memreg);
-                                                  }};
-            int32_t lreg_size_i = lreg_size;
+            nbytes_rma += iov.num_bytes;
+            /* the registration is cached, i.e. shared with other transfers of the same memory */
+            auto memreg = detail::mem_reg_cache::instance().acquire(iov.data, iov.num_bytes, copy);
+            int32_t lreg_size_i = memreg.first;
+            auto lreg_ptr = memreg.second;
             std::memcpy(msg->bytes + pos, &lreg_size_i, sizeof(lreg_size_i));
             pos += sizeof(lreg_size_i);
-            std::memcpy(msg->bytes + pos, lreg, lreg_size_i);
+            std::memcpy(msg->bytes + pos, lreg_ptr.get(), lreg_size_i);
             pos += lreg_size_i;
             /* TODO: can we avoid the extra indirection of going through std::function? */
             std::function<void(void)> *fn = new std::function<void(void)>([=]() mutable {
@@ -2063,8 +3153,14 @@ namespace ttg_parsec {
       tp->tdm.module->outgoing_message_start(tp, owner, NULL);
       tp->tdm.module->outgoing_message_pack(tp, owner, NULL, NULL, 0);
       // std::cout << "Sending AM with " << msg->op_id.num_keys << " keys " << std::endl;
+      const auto message = msg->tt_id.message_id = ttg::detail::next_message_id(world.rank());
       parsec_ce.send_am(&parsec_ce, world_impl.parsec_ttg_tag(), owner, static_cast<void *>(msg.get()),
                         sizeof(msg_header_t) + pos);
+      this->counters().add(ttg::detail::tt_counter_slots::set_arg_remote);
+      this->counters().add_bytes_sent(i, sizeof(msg_header_t) + pos + nbytes_rma);
+      ttg::detail::notify_task_observers(key, [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+        o.message_sent(*this, k, i, owner, sizeof(msg_header_t) + pos + nbytes_rma, message);
+      });
 #if defined(PARSEC_PROF_TRACE) && defined(PARSEC_TTG_PROFILE_BACKEND)
       if(world.impl().profiling()) {
         parsec_profiling_ts_trace(world.impl().parsec_ttg_profile_backend_set_arg_end, 0, 0, NULL);
@@ -2094,6 +3190,7 @@ namespace ttg_parsec {
 
     template <int i, typename Iterator, typename Value>
     void broadcast_arg_local(Iterator &&begin, Iterator &&end, const Value &value) {
+      detail::batch_caller_scope caller_scope(&value);
 #if defined(PARSEC_PROF_TRACE) && defined(PARSEC_TTG_PROFILE_BACKEND)
       if(world.impl().profiling()) {
         parsec_profiling_ts_trace(world.impl().parsec_ttg_profile_backend_bcast_arg_start, 0, 0, NULL);
@@ -2119,6 +3216,121 @@ namespace ttg_parsec {
 #endif
     }
 
+    /// Packs the broadcast destinations [@p begin, @p end)
+    /// memory layout: [num_ranks, <rank, num_keys, keys...>...]
+    template <typename Iterator>
+    uint64_t pack_bcast_dests(Iterator begin, Iterator end, unsigned char *bytes, uint64_t pos) {
+      int32_t num_ranks = std::distance(begin, end);
+      std::memcpy(bytes + pos, &num_ranks, sizeof(num_ranks));
+      pos += sizeof(num_ranks);
+      for (auto it = begin; it != end; ++it) {
+        int32_t rank = it->first;
+        std::memcpy(bytes + pos, &rank, sizeof(rank));
+        pos += sizeof(rank);
+        int32_t num_keys = it->second.size();
+        std::memcpy(bytes + pos, &num_keys, sizeof(num_keys));
+        pos += sizeof(num_keys);
+        for (auto &&key : it->second) {
+          pos = pack(key, bytes, pos);
+        }
+      }
+      return pos;
+    }
+
+    /// Unpacks the broadcast destinations packed by pack_bcast_dests()
+    template <typename Key>
+    uint64_t unpack_bcast_dests(bcast_dests_t<Key> &dests, unsigned char *bytes, uint64_t pos) {
+      int32_t num_ranks;
+      std::memcpy(&num_ranks, bytes + pos, sizeof(num_ranks));
+      pos += sizeof(num_ranks);
+      dests.resize(num_ranks);
+      for (auto &&dest : dests) {
+        int32_t rank;
+        std::memcpy(&rank, bytes + pos, sizeof(rank));
+        pos += sizeof(rank);
+        assert(rank < world.size());
+        int32_t num_keys;
+        std::memcpy(&num_keys, bytes + pos, sizeof(num_keys));
+        pos += sizeof(num_keys);
+        dest.first = rank;
+        dest.second.resize(num_keys);
+        for (auto &&key : dest.second) {
+          pos = unpack(key, bytes, pos);
+        }
+      }
+      return pos;
+    }
+
+    /// Sends @p value to argument @p i of the tasks owned by the ranks in @p dests.
+    /// If the broadcast tree degree k of input @p i is larger than 1, the destinations are split into at most k
+    /// contiguous slices: the value is sent to the first rank of each slice, together with the rest of the slice,
+    /// which that rank forwards the value to in the same way. Otherwise the value is sent to every rank directly.
+    template <std::size_t i, typename Key, typename Value>
+    void broadcast_tree_send(const bcast_dests_t<Key> &dests, const Value &value) {
+      const std::size_t num_dests = dests.size();
+      if (0 == num_dests) return;
+      const int degree = bcast_tree_degrees[i];
+      const std::size_t num_children = (degree > 1) ? std::min<std::size_t>(degree, num_dests) : num_dests;
+
+      /* the buffer is reused for all children, size it for the largest message, i.e. all keys + value */
+      std::size_t keys_size = sizeof(int32_t);
+      for (auto &&dest : dests) {
+        keys_size += sizeof(int32_t) + sizeof(int32_t);
+        for (auto &&key : dest.second) keys_size += packed_size(key);
+      }
+      const auto value_size = packed_size(value);
+      /* large values are serialized once and exposed to all children by the rendezvous protocol */
+      std::shared_ptr<detail::rendezvous_image_t> image;
+      if (use_rendezvous<std::decay_t<Value>>(value_size, keys_size)) image = make_rendezvous_image(value);
+      const std::size_t payload_size =
+          keys_size + sizeof(value_protocol) + (image ? rendezvous_packed_size(*image) : value_size);
+      auto &world_impl = world.impl();
+      auto msg = detail::make_msg(payload_size, get_instance_id(), world_impl.taskpool()->taskpool_id,
+                                  msg_header_t::MSG_SET_ARG, i);
+      parsec_taskpool_t *tp = world_impl.taskpool();
+
+      for (std::size_t c = 0; c < num_children; ++c) {
+        auto begin = dests.begin() + c * num_dests / num_children;
+        auto end = dests.begin() + (c + 1) * num_dests / num_children;
+        const int owner = begin->first;
+
+        /* pack the keys of the child */
+        uint64_t pos = 0;
+        for (auto &&key : begin->second) {
+          pos = pack(key, msg->bytes, pos);
+        }
+        msg->tt_id.num_keys = begin->second.size();
+
+        /* pack the protocol, followed by the subtree of the child if any */
+        const bool forward = std::next(begin) != end;
+        value_protocol protocol;
+        if (image)
+          protocol = forward ? value_protocol::rendezvous_forward : value_protocol::rendezvous;
+        else
+          protocol = forward ? value_protocol::eager_forward : value_protocol::eager;
+        std::memcpy(msg->bytes + pos, &protocol, sizeof(protocol));
+        pos += sizeof(protocol);
+        if (forward) pos = pack_bcast_dests(std::next(begin), end, msg->bytes, pos);
+
+        if (image)
+          pos = pack_rendezvous(image, msg->bytes, pos);
+        else
+          pos = pack(value, msg->bytes, pos);
+
+        /* Send the message */
+        tp->tdm.module->outgoing_message_start(tp, owner, NULL);
+        tp->tdm.module->outgoing_message_pack(tp, owner, NULL, NULL, 0);
+        const auto message = msg->tt_id.message_id = ttg::detail::next_message_id(world.rank());
+        parsec_ce.send_am(&parsec_ce, world_impl.parsec_ttg_tag(), owner, static_cast<void *>(msg.get()),
+                          sizeof(msg_header_t) + pos);
+        this->counters().add(ttg::detail::tt_counter_slots::set_arg_remote, begin->second.size());
+        this->counters().add_bytes_sent(i, sizeof(msg_header_t) + pos + (image ? image->size : 0));
+        ttg::detail::notify_task_observers(begin->second.front(), [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+          o.message_sent(*this, k, i, owner, sizeof(msg_header_t) + pos + (image ? image->size : 0), message);
+        });
+      }
+    }
+
     template <std::size_t i, typename Key, typename Value>
     std::enable_if_t<!ttg::meta::is_void_v<Key> && !std::is_void_v<std::decay_t<Value>> &&
                          !ttg::has_split_metadata<std::decay_t<Value>>::value,
@@ -2128,60 +3340,40 @@ namespace ttg_parsec {
       int rank = world.rank();
 
       bool have_remote = keylist.end() != std::find_if(keylist.begin(), keylist.end(),
-                                                       [&](const Key &key) { return keymap(key) != rank; });
+                                                       [&](const Key &key) { return owner_of(key) != rank; });
 
       if (have_remote) {
         std::vector<Key> keylist_sorted(keylist.begin(), keylist.end());
 
-        /* Assuming there are no local keys, will be updated while processing remote keys */
+        /* Assuming there are no local keys, will be updated while grouping the keys */
         auto local_begin = keylist_sorted.end();
         auto local_end = keylist_sorted.end();
 
-        /* sort the input key list by owner and check whether there are remote keys */
+        /* sort the input key list by owner */
         std::sort(keylist_sorted.begin(), keylist_sorted.end(), [&](const Key &a, const Key &b) mutable {
-          int rank_a = keymap(a);
-          int rank_b = keymap(b);
+          int rank_a = owner_of(a);
+          int rank_b = owner_of(b);
           return rank_a < rank_b;
         });
 
-        using msg_t = detail::msg_t;
-        local_begin = keylist_sorted.end();
-        auto &world_impl = world.impl();
-        std::unique_ptr<msg_t> msg = std::make_unique<msg_t>(get_instance_id(), world_impl.taskpool()->taskpool_id,
-                                                             msg_header_t::MSG_SET_ARG, i);
-
-        parsec_taskpool_t *tp = world_impl.taskpool();
-
-        for (auto it = keylist_sorted.begin(); it < keylist_sorted.end(); /* increment inline */) {
-          auto owner = keymap(*it);
+        /* group the keys by owner */
+        bcast_dests_t<Key> dests;
+        for (auto it = keylist_sorted.begin(); it != keylist_sorted.end(); /* increment inline */) {
+          auto owner = owner_of(*it);
+          auto owner_end = std::find_if_not(std::next(it), keylist_sorted.end(),
+                                            [&](const Key &key) { return owner_of(key) == owner; });
           if (owner == rank) {
             /* make sure we don't lose local keys */
             local_begin = it;
-            local_end =
-                std::find_if_not(++it, keylist_sorted.end(), [&](const Key &key) { return keymap(key) == rank; });
-            it = local_end;
-            continue;
+            local_end = owner_end;
+          } else {
+            dests.emplace_back(owner, std::vector<Key>(it, owner_end));
           }
+          it = owner_end;
+        }
 
-          /* pack all keys for this owner */
-          int num_keys = 0;
-          uint64_t pos = 0;
-          do {
-            ++num_keys;
-            pos = pack(*it, msg->bytes, pos);
-            ++it;
-          } while (it < keylist_sorted.end() && keymap(*it) == owner);
-          msg->tt_id.num_keys = num_keys;
-
-          /* TODO: use RMA to transfer the value */
-          pos = pack(value, msg->bytes, pos);
+        broadcast_tree_send<i>(dests, value);
 
-          /* Send the message */
-          tp->tdm.module->outgoing_message_start(tp, owner, NULL);
-          tp->tdm.module->outgoing_message_pack(tp, owner, NULL, NULL, 0);
-          parsec_ce.send_am(&parsec_ce, world_impl.parsec_ttg_tag(), owner, static_cast<void *>(msg.get()),
-                            sizeof(msg_header_t) + pos);
-        }
         /* handle local keys */
         broadcast_arg_local<i>(local_begin, local_end, value);
       } else {
@@ -2199,7 +3391,7 @@ namespace ttg_parsec {
       auto world = ttg_default_execution_context();
       int rank = world.rank();
       bool have_remote = keylist.end() != std::find_if(keylist.begin(), keylist.end(),
-                                                       [&](const Key &key) { return keymap(key) != rank; });
+                                                       [&](const Key &key) { return owner_of(key) != rank; });
 
       if (have_remote) {
         using decvalueT = std::decay_t<Value>;
@@ -2207,8 +3399,8 @@ namespace ttg_parsec {
         /* sort the input key list by owner and check whether there are remote keys */
         std::vector<Key> keylist_sorted(keylist.begin(), keylist.end());
         std::sort(keylist_sorted.begin(), keylist_sorted.end(), [&](const Key &a, const Key &b) mutable {
-          int rank_a = keymap(a);
-          int rank_b = keymap(b);
+          int rank_a = owner_of(a);
+          int rank_b = owner_of(b);
           return rank_a < rank_b;
         });
 
@@ -2222,54 +3414,46 @@ namespace ttg_parsec {
         std::vector<std::pair<int32_t, std::shared_ptr<void>>> memregs;
         memregs.reserve(num_iovs);
 
-        /* register all iovs so the registration can be reused */
+        detail::ttg_data_copy_t *copy;
+        copy = detail::find_copy_in_task(parsec_ttg_caller, &value);
+        assert(nullptr != copy);
+
+        /* register all iovs so the registration can be reused, across broadcasts too */
+        std::size_t nbytes_rma = 0;  // bytes each owner gets by RMA, rather than in the message
         for (auto &&iov : iovs) {
-          parsec_ce_mem_reg_handle_t lreg;
-          size_t lreg_size;
-          parsec_ce.mem_register(iov.data, PARSEC_MEM_TYPE_NONCONTIGUOUS, iov.num_bytes, parsec_datatype_int8_t,
-                                 iov.num_bytes, &lreg, &lreg_size);
-          /* TODO: use a static function for deregistration here? */
-          memregs.push_back(std::make_pair(static_cast<int32_t>(lreg_size),
-                                           /* TODO: this assumes that parsec_ce_mem_reg_handle_t is void* */
-                                           std::shared_ptr<void>{lreg, [](void *ptr) {
-                                                                   parsec_ce_mem_reg_handle_t memreg =
-                                                                       (parsec_ce_mem_reg_handle_t)ptr;
-                                                                   parsec_ce.mem_unregister(&memreg);
-                                                                 }}));
-        }
-
-        using msg_t = detail::msg_t;
+          memregs.push_back(detail::mem_reg_cache::instance().acquire(iov.data, iov.num_bytes, copy));
+          nbytes_rma += iov.num_bytes;
+        }
+
         auto &world_impl = world.impl();
-        std::unique_ptr<msg_t> msg = std::make_unique<msg_t>(get_instance_id(), world_impl.taskpool()->taskpool_id,
-                                                             msg_header_t::MSG_SET_ARG, i);
+        /* split-metadata messages carry registration handles of unknown size, use the largest buffer */
+        auto msg = detail::make_msg(WorldImpl::PARSEC_TTG_MAX_AM_SIZE - sizeof(msg_header_t), get_instance_id(),
+                                    world_impl.taskpool()->taskpool_id, msg_header_t::MSG_SET_ARG, i);
         auto metadata = descr.get_metadata(value);
         size_t metadata_size = sizeof(metadata);
 
-        detail::ttg_data_copy_t *copy;
-        copy = detail::find_copy_in_task(parsec_ttg_caller, &value);
-        assert(nullptr != copy);
-
         parsec_taskpool_t *tp = world_impl.taskpool();
         for (auto it = keylist_sorted.begin(); it < keylist_sorted.end(); /* increment done inline */) {
-          auto owner = keymap(*it);
+          auto owner = owner_of(*it);
           if (owner == rank) {
             local_begin = it;
             /* find first non-local key */
             local_end =
-                std::find_if_not(++it, keylist_sorted.end(), [&](const Key &key) { return keymap(key) == rank; });
+                std::find_if_not(++it, keylist_sorted.end(), [&](const Key &key) { return owner_of(key) == rank; });
             it = local_end;
             continue;
           }
 
           /* count keys and set it afterwards */
           uint64_t pos = 0;
+          const auto first_key = it;
           /* pack all keys for this owner */
           int num_keys = 0;
           do {
             ++num_keys;
             pos = pack(*it, msg->bytes, pos);
             ++it;
-          } while (it < keylist_sorted.end() && keymap(*it) == owner);
+          } while (it < keylist_sorted.end() && owner_of(*it) == owner);
           msg->tt_id.num_keys = num_keys;
 
           /* pack the metadata */
@@ -2321,8 +3505,14 @@ namespace ttg_parsec {
           }
           tp->tdm.module->outgoing_message_start(tp, owner, NULL);
           tp->tdm.module->outgoing_message_pack(tp, owner, NULL, NULL, 0);
+          const auto message = msg->tt_id.message_id = ttg::detail::next_message_id(world.rank());
           parsec_ce.send_am(&parsec_ce, world_impl.parsec_ttg_tag(), owner, static_cast<void *>(msg.get()),
                             sizeof(msg_header_t) + pos);
+          this->counters().add(ttg::detail::tt_counter_slots::set_arg_remote, num_keys);
+          this->counters().add_bytes_sent(i, sizeof(msg_header_t) + pos + nbytes_rma);
+          ttg::detail::notify_task_observers(*first_key, [&](ttg::TaskObserver &o, const ttg::TaskKey &k) {
+            o.message_sent(*this, k, i, owner, sizeof(msg_header_t) + pos + nbytes_rma, message);
+          });
         }
         /* handle local keys */
         broadcast_arg_local<i>(local_begin, local_end, value);
@@ -2402,14 +3592,13 @@ namespace ttg_parsec {
       assert(size > 0 && "TT::set_argstream_size(key,size) called with size=0");
 
       // body
-      const auto owner = keymap(key);
+      const auto owner = owner_of(key);
       if (owner != world.rank()) {
         ttg::trace(world.rank(), ":", get_name(), ":", key, " : forwarding stream size for terminal ", i);
-        using msg_t = detail::msg_t;
         auto &world_impl = world.impl();
         uint64_t pos = 0;
-        std::unique_ptr<msg_t> msg = std::make_unique<msg_t>(get_instance_id(), world_impl.taskpool()->taskpool_id,
-                                                             msg_header_t::MSG_SET_ARGSTREAM_SIZE, i, 1);
+        auto msg = detail::make_msg(packed_size(key) + packed_size(size), get_instance_id(),
+                                    world_impl.taskpool()->taskpool_id, msg_header_t::MSG_SET_ARGSTREAM_SIZE, i, 1);
         /* pack the key */
         pos = pack(key, msg->bytes, pos);
         msg->tt_id.num_keys = 1;
@@ -2424,11 +3613,11 @@ namespace ttg_parsec {
 
         auto hk = reinterpret_cast<parsec_key_t>(&key);
         task_t *task;
-        parsec_hash_table_lock_bucket(&tasks_table, hk);
-        if (nullptr == (task = (task_t *)parsec_hash_table_nolock_find(&tasks_table, hk))) {
+        tasks_table_lock(hk);
+        if (nullptr == (task = tasks_table_nolock_find(hk))) {
           task = create_new_task(key);
-          world.impl().increment_created();
-          parsec_hash_table_nolock_insert(&tasks_table, &task->tt_ht_item);
+          count_new_task();
+          tasks_table_nolock_insert(task);
           if( world.impl().dag_profiling() ) {
 #if defined(PARSEC_PROF_GRAPHER)
             parsec_prof_grapher_task(&task->parsec_task, world.impl().execution_stream()->th_id, 0, *(uintptr_t*)&(task->parsec_task.locals[0]));
@@ -2442,9 +3631,9 @@ namespace ttg_parsec {
         // commit changes
         task->stream[i].goal = size;
         bool release = (task->stream[i].size == task->stream[i].goal);
-        parsec_hash_table_unlock_bucket(&tasks_table, hk);
+        tasks_table_unlock(hk);
 
-        if (release) release_task(task);
+        if (release && complete_stream<i>(task)) release_task(task);
       }
     }
 
@@ -2457,14 +3646,13 @@ namespace ttg_parsec {
       assert(size > 0 && "TT::set_argstream_size(key,size) called with size=0");
 
       // body
-      const auto owner = keymap();
+      const auto owner = owner_of();
       if (owner != world.rank()) {
         ttg::trace(world.rank(), ":", get_name(), " : forwarding stream size for terminal ", i);
-        using msg_t = detail::msg_t;
         auto &world_impl = world.impl();
         uint64_t pos = 0;
-        std::unique_ptr<msg_t> msg = std::make_unique<msg_t>(get_instance_id(), world_impl.taskpool()->taskpool_id,
-                                                             msg_header_t::MSG_SET_ARGSTREAM_SIZE, i, 1);
+        auto msg = detail::make_msg(packed_size(size), get_instance_id(), world_impl.taskpool()->taskpool_id,
+                                    msg_header_t::MSG_SET_ARGSTREAM_SIZE, i, 1);
         /* pack the key */
         msg->tt_id.num_keys = 0;
         pos = pack(size, msg->bytes, pos);
@@ -2478,11 +3666,11 @@ namespace ttg_parsec {
 
         parsec_key_t hk = 0;
         task_t *task;
-        parsec_hash_table_lock_bucket(&tasks_table, hk);
-        if (nullptr == (task = (task_t *)parsec_hash_table_nolock_find(&tasks_table, hk))) {
+        tasks_table_lock(hk);
+        if (nullptr == (task = tasks_table_nolock_find(hk))) {
           task = create_new_task(ttg::Void{});
-          world.impl().increment_created();
-          parsec_hash_table_nolock_insert(&tasks_table, &task->tt_ht_item);
+          count_new_task();
+          tasks_table_nolock_insert(task);
           if( world.impl().dag_profiling() ) {
 #if defined(PARSEC_PROF_GRAPHER)
             parsec_prof_grapher_task(&task->parsec_task, world.impl().execution_stream()->th_id, 0, *(uintptr_t*)&(task->parsec_task.locals[0]));
@@ -2496,9 +3684,9 @@ namespace ttg_parsec {
         // commit changes
         task->stream[i].goal = size;
         bool release = (task->stream[i].size == task->stream[i].goal);
-        parsec_hash_table_unlock_bucket(&tasks_table, hk);
+        tasks_table_unlock(hk);
 
-        if (release) release_task(task);
+        if (release && complete_stream<i>(task)) release_task(task);
       }
     }
 
@@ -2509,14 +3697,13 @@ namespace ttg_parsec {
       assert(std::get<i>(input_reducers) && "TT::finalize_argstream called on nonstreaming input terminal");
 
       // body
-      const auto owner = keymap(key);
+      const auto owner = owner_of(key);
       if (owner != world.rank()) {
         ttg::trace(world.rank(), ":", get_name(), " : ", key, ": forwarding stream finalize for terminal ", i);
-        using msg_t = detail::msg_t;
         auto &world_impl = world.impl();
         uint64_t pos = 0;
-        std::unique_ptr<msg_t> msg = std::make_unique<msg_t>(get_instance_id(), world_impl.taskpool()->taskpool_id,
-                                                             msg_header_t::MSG_FINALIZE_ARGSTREAM_SIZE, i, 1);
+        auto msg = detail::make_msg(packed_size(key), get_instance_id(), world_impl.taskpool()->taskpool_id,
+                                    msg_header_t::MSG_FINALIZE_ARGSTREAM_SIZE, i, 1);
         /* pack the key */
         pos = pack(key, msg->bytes, pos);
         msg->tt_id.num_keys = 1;
@@ -2530,8 +3717,8 @@ namespace ttg_parsec {
 
         auto hk = reinterpret_cast<parsec_key_t>(&key);
         task_t *task = nullptr;
-        parsec_hash_table_lock_bucket(&tasks_table, hk);
-        if (nullptr == (task = (task_t *)parsec_hash_table_nolock_find(&tasks_table, hk))) {
+        tasks_table_lock(hk);
+        if (nullptr == (task = tasks_table_nolock_find(hk))) {
           ttg::print_error(world.rank(), ":", get_name(), ":", key,
                            " : error finalize called on stream that never received an input data: ", i);
           throw std::runtime_error("TT::finalize called on stream that never received an input data");
@@ -2541,10 +3728,10 @@ namespace ttg_parsec {
         // TODO: Unfriendly implementation, cannot check if stream has been finalized already
 
         // commit changes
-        task->stream[i].size = 1;
-        parsec_hash_table_unlock_bucket(&tasks_table, hk);
+        task->stream[i].goal = task->stream[i].size = 1;
+        tasks_table_unlock(hk);
 
-        release_task(task);
+        if (complete_stream<i>(task)) release_task(task);
       }
     }
 
@@ -2555,14 +3742,13 @@ namespace ttg_parsec {
       assert(std::get<i>(input_reducers) && "TT::finalize_argstream called on nonstreaming input terminal");
 
       // body
-      const auto owner = keymap();
+      const auto owner = owner_of();
       if (owner != world.rank()) {
         ttg::trace(world.rank(), ":", get_name(), ": forwarding stream finalize for terminal ", i);
-        using msg_t = detail::msg_t;
         auto &world_impl = world.impl();
         uint64_t pos = 0;
-        std::unique_ptr<msg_t> msg = std::make_unique<msg_t>(get_instance_id(), world_impl.taskpool()->taskpool_id,
-                                                             msg_header_t::MSG_FINALIZE_ARGSTREAM_SIZE, i, 1);
+        auto msg = detail::make_msg(0, get_instance_id(), world_impl.taskpool()->taskpool_id,
+                                    msg_header_t::MSG_FINALIZE_ARGSTREAM_SIZE, i, 1);
         msg->tt_id.num_keys = 0;
         parsec_taskpool_t *tp = world_impl.taskpool();
         tp->tdm.module->outgoing_message_start(tp, owner, NULL);
@@ -2574,8 +3760,8 @@ namespace ttg_parsec {
 
         auto hk = static_cast<parsec_key_t>(0);
         task_t *task = nullptr;
-        parsec_hash_table_lock_bucket(&tasks_table, hk);
-        if (nullptr == (task = (task_t *)parsec_hash_table_nolock_find(&tasks_table, hk))) {
+        tasks_table_lock(hk);
+        if (nullptr == (task = tasks_table_nolock_find(hk))) {
           ttg::print_error(world.rank(), ":", get_name(),
                            " : error finalize called on stream that never received an input data: ", i);
           throw std::runtime_error("TT::finalize called on stream that never received an input data");
@@ -2585,10 +3771,29 @@ namespace ttg_parsec {
         // TODO: Unfriendly implementation, cannot check if stream has been finalized already
 
         // commit changes
-        task->stream[i].size = 1;
-        parsec_hash_table_unlock_bucket(&tasks_table, hk);
+        task->stream[i].goal = task->stream[i].size = 1;
+        tasks_table_unlock(hk);
 
-        release_task(task);
+        if (complete_stream<i>(task)) release_task(task);
+      }
+    }
+
+    /// lets the runtime finalize unbounded stream \c i: a task whose stream received values without being bounded
+    /// or finalized is released once no more values can arrive for it, i.e. once the taskpool becomes quiescent
+    /// during a fence, after the tasks that can send values to this TT have completed. The tasks of this TT are then
+    /// counted in the taskpool once ready rather than once created.
+    /// Must be called on every process, for the TTs in the same order, before any value is sent to this TT.
+    /// \tparam <i>: index of the input terminal
+    template <std::size_t i>
+    void set_argstream_auto_finalize() {
+      assert(std::get<i>(input_reducers) && "TT::set_argstream_auto_finalize called on nonstreaming input terminal");
+      ttg::trace(world.rank(), ":", get_name(), " : finalizing stream of terminal ", i, " upon quiescence");
+      const bool registered = counts_tasks_when_ready();
+      auto_finalize_streams[i] = true;
+      if (!registered) {
+        world.impl().register_stream_finalizer(
+            this, [this]() { return !keys_awaiting_finalization().empty(); },
+            [this]() { finalize_awaiting_streams(std::make_index_sequence<numins>{}); });
       }
     }
 
@@ -2808,9 +4013,15 @@ namespace ttg_parsec {
       for (int i = 0; i < task->data_count; i++) {
         detail::ttg_data_copy_t *copy = static_cast<detail::ttg_data_copy_t *>(task->parsec_task.data[i].data_in);
         if (nullptr == copy) continue;
-        detail::release_data_copy(copy);
+        if (copy->is_inline) {
+          /* the copy lives in the storage of the task, see ttg_data_inline_storage_t */
+          copy->~ttg_data_copy_t();
+        } else {
+          detail::release_data_copy(copy);
+        }
         task->parsec_task.data[i].data_in = nullptr;
       }
+      task->charge.release();
       parsec_ttg_es = safe_es;
       return PARSEC_HOOK_RETURN_DONE;
     }
@@ -3004,6 +4215,9 @@ namespace ttg_parsec {
       alive = false;
       /* print all outstanding tasks */
       parsec_hash_table_for_all(&tasks_table, ht_iter_cb, this);
+      if (dense_tasks) {
+        dense_tasks->for_each([this](std::size_t idx, task_t *task) { ht_iter_cb(task, this); });
+      }
       parsec_hash_table_fini(&tasks_table);
       parsec_mempool_destruct(&mempools);
       // uintptr_t addr = (uintptr_t)self.incarnations;
@@ -3019,6 +4233,7 @@ namespace ttg_parsec {
           delete self.out[i];
         }
       }
+      if (counts_tasks_when_ready()) world.impl().deregister_stream_finalizer(this);
       world.impl().deregister_op(this);
     }
 
@@ -3048,6 +4263,57 @@ namespace ttg_parsec {
       set_static_argstream_size<i>(size);
     }
 
+    /// define the reducer function to be called when additional inputs are
+    /// received on a streaming terminal, and how it is invoked
+    ///   @tparam <i> the index of the input terminal that is used as a streaming terminal
+    ///   @param[in] reducer: a function of prototype (input_type<i> &a, const input_type<i> &b)
+    ///                       that function should aggregate b into a
+    ///   @param[in] mode: how the reducer is invoked, see set_input_reduce_mode
+    template <std::size_t i, typename Reducer>
+    void set_input_reducer(Reducer &&reducer, ttg::ReduceMode mode) {
+      set_input_reducer<i>(std::forward<Reducer>(reducer));
+      set_input_reduce_mode<i>(mode);
+    }
+
+    /// define the reducer function to be called when additional inputs are
+    /// received on a streaming terminal, and how it is invoked
+    ///   @tparam <i> the index of the input terminal that is used as a streaming terminal
+    ///   @param[in] reducer: a function of prototype (input_type<i> &a, const input_type<i> &b)
+    ///                       that function should aggregate b into a
+    ///   @param[in] size: the default number of inputs that are received in this streaming terminal,
+    ///                    for each task
+    ///   @param[in] mode: how the reducer is invoked, see set_input_reduce_mode
+    template <std::size_t i, typename Reducer>
+    void set_input_reducer(Reducer &&reducer, std::size_t size, ttg::ReduceMode mode) {
+      set_input_reducer<i>(std::forward<Reducer>(reducer), size);
+      set_input_reduce_mode<i>(mode);
+    }
+
+    /// selects how the values received by streaming terminal @p i are reduced. With ttg::ReduceMode::Locked (the
+    /// default) every value is reduced into the input of the task while holding the lock of the task, hence the
+    /// senders of the values serialize. ttg::ReduceMode::Atomic reduces values of arithmetic type with
+    /// compare-and-swap, ttg::ReduceMode::PerThread lets each thread reduce into its own partial result, the partial
+    /// results are combined when the stream is complete. The latter two modes require the reducer to be associative
+    /// and commutative and, since the reducer may be called concurrently, reentrant. Control inputs are always
+    /// reduced under the lock.
+    ///   @tparam <i> the index of the input terminal that is used as a streaming terminal
+    ///   @param[in] mode: the reduction mode; ttg::ReduceMode::Atomic is only valid for inputs of arithmetic type
+    template <std::size_t i>
+    void set_input_reduce_mode(ttg::ReduceMode mode) {
+      using valueT = std::decay_t<std::tuple_element_t<i, input_values_full_tuple_type>>;
+      if (mode == ttg::ReduceMode::Atomic && !ttg::detail::is_atomic_reducible_v<valueT>) {
+        ttg::print_error(world.rank(), ":", get_name(), " : error atomic reduction of a non-arithmetic input : ", i);
+        throw std::logic_error("TT::set_input_reduce_mode: ReduceMode::Atomic requires an input of arithmetic type");
+      }
+      input_reduce_modes[i] = mode;
+    }
+
+    /// @return how the values received by streaming terminal @p i are reduced, see set_input_reduce_mode
+    template <std::size_t i>
+    ttg::ReduceMode get_input_reduce_mode() const {
+      return input_reduce_modes[i];
+    }
+
     // Returns reference to input terminal i to facilitate connection --- terminal
     // cannot be copied, moved or assigned
     template <std::size_t i>
@@ -3067,6 +4333,7 @@ namespace ttg_parsec {
     std::enable_if_t<!ttg::meta::is_void_v<Key> && !ttg::meta::is_empty_tuple_v<input_values_tuple_type>, void> invoke(
         const Key &key, const input_values_tuple_type &args) {
       TTG_OP_ASSERT_EXECUTABLE();
+      throttle();
       /* trigger non-void inputs */
       set_args(ttg::meta::nonvoid_index_seq<actual_input_tuple_type>{}, key, args);
       /* trigger void inputs */
@@ -3079,6 +4346,7 @@ namespace ttg_parsec {
     std::enable_if_t<ttg::meta::is_void_v<Key> && !ttg::meta::is_empty_tuple_v<input_values_tuple_type>, void> invoke(
         const input_values_tuple_type &args) {
       TTG_OP_ASSERT_EXECUTABLE();
+      throttle();
       /* trigger non-void inputs */
       set_args(ttg::meta::nonvoid_index_seq<actual_input_tuple_type>{}, args);
       /* trigger void inputs */
@@ -3091,6 +4359,7 @@ namespace ttg_parsec {
     std::enable_if_t<!ttg::meta::is_void_v<Key> && ttg::meta::is_empty_tuple_v<input_values_tuple_type>, void> invoke(
         const Key &key) {
       TTG_OP_ASSERT_EXECUTABLE();
+      throttle();
       /* trigger void inputs */
       using void_index_seq = ttg::meta::void_index_seq<actual_input_tuple_type>;
       set_args(void_index_seq{}, key, ttg::detail::make_void_tuple<void_index_seq::size()>());
@@ -3100,6 +4369,7 @@ namespace ttg_parsec {
     template <typename Key = keyT>
     std::enable_if_t<ttg::meta::is_void_v<Key> && ttg::meta::is_empty_tuple_v<input_values_tuple_type>, void> invoke() {
       TTG_OP_ASSERT_EXECUTABLE();
+      throttle();
       /* trigger void inputs */
       using void_index_seq = ttg::meta::void_index_seq<actual_input_tuple_type>;
       set_args(void_index_seq{}, ttg::detail::make_void_tuple<void_index_seq::size()>());
@@ -3135,6 +4405,10 @@ namespace ttg_parsec {
     /// keymap setter
     template <typename Keymap>
     void set_keymap(Keymap &&km) {
+      if constexpr (ttg::detail::derived_has_bound_maps<derivedT>()) {
+        ttg::print_error(world.rank(), ":", get_name(), " : set_keymap called on a TT with bound maps");
+        throw std::logic_error("TT::set_keymap: the keymap is bound by its type, see ttg::bind_maps");
+      }
       keymap = km;
     }
 
@@ -3144,11 +4418,53 @@ namespace ttg_parsec {
 
     /// priomap setter
     /// @arg pm a function that maps a key to an integral priority value.
+    /// Higher values indicate higher priority, the default priority is 0. The value is passed unchanged
+    /// to the PaRSEC scheduler, i.e. among the ready tasks those with the highest priority are executed first;
+    /// tasks released together (e.g. by a broadcast) are submitted in order of decreasing priority.
     template <typename Priomap>
     void set_priomap(Priomap &&pm) {
+      if constexpr (ttg::detail::derived_has_bound_maps<derivedT>()) {
+        ttg::print_error(world.rank(), ":", get_name(), " : set_priomap called on a TT with bound maps");
+        throw std::logic_error("TT::set_priomap: the priomap is bound by its type, see ttg::bind_maps");
+      }
       priomap = std::forward<Priomap>(pm);
     }
 
+    /// Declares the domain of the keys of the tasks of this TT executed on this process: pending tasks are then kept
+    /// in a table indexed by the linearized key instead of a hash table. Must be called before make_executable().
+    /// @param extent the number of keys in the domain
+    /// @param linearize a function that maps a key to a unique index in [0, extent); only the keys of tasks
+    ///        mapped to this process by the keymap need be mapped, e.g. to a process-local index
+    template <typename Linearizer, typename Key = keyT>
+    std::enable_if_t<!ttg::meta::is_void_v<Key>> set_key_domain(std::size_t extent, Linearizer &&linearize) {
+      if (is_executable()) {
+        ttg::print_error(world.rank(), ":", get_name(), " : set_key_domain called after make_executable");
+        throw std::logic_error("TT::set_key_domain called after make_executable");
+      }
+      key_linearizer = std::forward<Linearizer>(linearize);
+      dense_tasks = std::make_unique<ttg::detail::dense_table<task_t>>(extent);
+    }
+
+    /// Sets the degree of the tree used to broadcast values to input terminal @p i and returns the previous setting.
+    /// With degree k > 1 the sender sends the value to at most k of the destination ranks, each of which forwards
+    /// it to its own subtree, so that a broadcast to P ranks takes O(log_k P) rather than O(P) steps on the sender.
+    /// The default, 0, sends from the sender directly to every destination rank. Must be set consistently on all
+    /// ranks. Values with split metadata (see ttg::SplitMetadataDescriptor) are always sent directly.
+    template <std::size_t i>
+    int set_broadcast_tree_degree(int degree) {
+      static_assert(i < numins, "set_broadcast_tree_degree: input terminal index out of range");
+      assert(degree >= 0);
+      std::swap(bcast_tree_degrees[i], degree);
+      return degree;
+    }
+
+    /// @return the degree of the tree used to broadcast values to input terminal @p i, 0 if values are sent directly
+    template <std::size_t i>
+    int get_broadcast_tree_degree() const {
+      static_assert(i < numins, "get_broadcast_tree_degree: input terminal index out of range");
+      return bcast_tree_degrees[i];
+    }
+
     // Register the static_op function to associate it to instance_id
     void register_static_op_function(void) {
       int rank;
@@ -3203,6 +4519,7 @@ template <>
 struct ttg::detail::value_copy_handler<ttg::Runtime::PaRSEC> {
  private:
   ttg_parsec::detail::ttg_data_copy_t *copy_to_remove = nullptr;
+  std::optional<ttg_parsec::detail::batch_caller_scope> caller_scope;  // restores the caller after the destructor
 
  public:
   ~value_copy_handler() {
@@ -3214,9 +4531,14 @@ struct ttg::detail::value_copy_handler<ttg::Runtime::PaRSEC> {
 
   template <typename Value>
   inline Value &&operator()(Value &&value) {
+    caller_scope.emplace(&value);
     if (nullptr == parsec_ttg_caller) {
       ttg::print("ERROR: ttg_send or ttg_broadcast called outside of a task!\n");
     }
+    if constexpr (ttg_parsec::detail::is_inline_value_v<std::decay_t<Value>>) {
+      /* small values are copied into the receiving tasks, no need to track them */
+      return std::forward<Value>(value);
+    }
     ttg_parsec::detail::ttg_data_copy_t *copy;
     copy = ttg_parsec::detail::find_copy_in_task(parsec_ttg_caller, &value);
     Value *value_ptr = &value;
@@ -3239,9 +4561,13 @@ struct ttg::detail::value_copy_handler<ttg::Runtime::PaRSEC> {
 
   template <typename Value>
   inline const Value &operator()(const Value &value) {
+    caller_scope.emplace(&value);
     if (nullptr == parsec_ttg_caller) {
       ttg::print("ERROR: ttg_send or ttg_broadcast called outside of a task!\n");
     }
+    if constexpr (ttg_parsec::detail::is_inline_value_v<std::decay_t<Value>>) {
+      return value;
+    }
     ttg_parsec::detail::ttg_data_copy_t *copy;
     copy = ttg_parsec::detail::find_copy_in_task(parsec_ttg_caller, &value);
     const Value *value_ptr = &value;
@@ -3266,6 +4592,9 @@ struct ttg::detail::value_copy_handler<ttg::Runtime::PaRSEC> {
     if (nullptr == parsec_ttg_caller) {
       ttg::print("ERROR: ttg_send or ttg_broadcast called outside of a task!\n");
     }
+    if constexpr (ttg_parsec::detail::is_inline_value_v<std::decay_t<Value>>) {
+      return value;
+    }
     /* the value is not known, create a copy that we can track */
     ttg_parsec::detail::ttg_data_copy_t *copy;
     copy = ttg_parsec::detail::create_new_datacopy(value);
@@ -1,11 +1,25 @@
 #ifndef TTG_DATA_COPY_H
 #define TTG_DATA_COPY_H
 
-#include <utility>
+#include <atomic>
+#include <cstddef>
 #include <limits>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
 #include <parsec.h>
 
+#include "ttg/util/slab_allocator.h"
+#include "ttg/util/void.h"
+
+/* Trivially copyable values up to this size (in bytes) are stored inline in the task
+ * instead of in a separately allocated, reference-counted data copy. */
+#ifndef TTG_PARSEC_INLINE_VALUE_MAX_SIZE
+#define TTG_PARSEC_INLINE_VALUE_MAX_SIZE 32
+#endif
+
 
 namespace ttg_parsec {
 
@@ -21,6 +35,14 @@ namespace ttg_parsec {
       int64_t uid;
 #endif
 
+      /* true if the registration cache holds registrations of memory of this copy,
+       * which must be invalidated before the copy is freed; set under the lock of the cache */
+      std::atomic<bool> has_cached_registrations = false;
+
+      /* true if the copy lives in the storage of a task (see ttg_data_inline_copy_t),
+       * it is neither reference-counted nor shared with other tasks */
+      bool is_inline = false;
+
       /* special value assigned to parsec_data_copy_t::readers to mark the copy as
       * mutable, i.e., a task will modify it */
       static constexpr int mutable_tag = std::numeric_limits<int>::min();
@@ -89,12 +111,17 @@ namespace ttg_parsec {
     * Extension of ttg_data_copy_t holding the actual value.
     * The virtual destructor will take care of destructing the value if
     * the destructor of ttg_data_copy_t base class is called.
+    * Copies are allocated from the per-thread slab pool of their size class.
     */
     template<typename ValueT>
-    struct ttg_data_value_copy_t final : public ttg_data_copy_t {
+    struct ttg_data_value_copy_t final : public ttg_data_copy_t,
+                                         public ttg::detail::slab_allocated<ttg_data_value_copy_t<ValueT>> {
       using value_type = std::decay_t<ValueT>;
       value_type m_value;
 
+      using ttg::detail::slab_allocated<ttg_data_value_copy_t<ValueT>>::operator new;
+      using ttg::detail::slab_allocated<ttg_data_value_copy_t<ValueT>>::operator delete;
+
       template<typename T>
       ttg_data_value_copy_t(T&& value)
       : ttg_data_copy_t(), m_value(std::forward<T>(value))
@@ -106,6 +133,67 @@ namespace ttg_parsec {
       virtual ~ttg_data_value_copy_t() = default;
     };
 
+    /**
+    * Whether values of type \c ValueT are stored inline in the tasks.
+    */
+    template<typename ValueT>
+    inline constexpr bool is_inline_value_v = !std::is_same_v<ValueT, ttg::Void> &&
+                                              std::is_trivially_copyable_v<ValueT> &&
+                                              sizeof(ValueT) <= TTG_PARSEC_INLINE_VALUE_MAX_SIZE &&
+                                              alignof(ValueT) <= alignof(std::max_align_t);
+
+    /**
+    * A copy of a small, trivially copyable value that lives in the storage of the
+    * task consuming it. It is never shared: a task sending the value to another task
+    * copies it, which is no more expensive than incrementing a reference counter.
+    */
+    template<typename ValueT>
+    struct ttg_data_inline_copy_t final : public ttg_data_copy_t {
+      using value_type = ValueT;
+      value_type m_value;
+
+      template<typename T>
+      ttg_data_inline_copy_t(T&& value)
+      : ttg_data_copy_t(), m_value(std::forward<T>(value))
+      {
+        this->is_inline = true;
+        this->device_private = &m_value;
+      }
+    };
+
+    /**
+    * Uninitialized storage for the inline copy of an input of type \c ValueT,
+    * empty if values of \c ValueT are not stored inline.
+    */
+    template<typename ValueT, bool Inline = is_inline_value_v<ValueT>>
+    struct ttg_data_inline_storage_t { };
+
+    template<typename ValueT>
+    struct ttg_data_inline_storage_t<ValueT, true> {
+      alignas(ttg_data_inline_copy_t<ValueT>) unsigned char bytes[sizeof(ttg_data_inline_copy_t<ValueT>)];
+
+      /* user-provided to leave the storage uninitialized, e.g., when value-initialized by std::tuple */
+      ttg_data_inline_storage_t() { }
+
+      /* constructs the copy of \c value in the storage, destroyed when the task completes */
+      template<typename T>
+      ttg_data_copy_t *emplace(T&& value) {
+        return ::new (static_cast<void*>(bytes)) ttg_data_inline_copy_t<ValueT>(std::forward<T>(value));
+      }
+    };
+
+    template<typename ValuesTuple>
+    struct ttg_data_inline_storage_tuple;
+
+    template<typename... ValueTs>
+    struct ttg_data_inline_storage_tuple<std::tuple<ValueTs...>> {
+      using type = std::tuple<ttg_data_inline_storage_t<ValueTs>...>;
+    };
+
+    /* the inline storage of a task for inputs of types \c ValuesTuple */
+    template<typename ValuesTuple>
+    using ttg_data_inline_storage_tuple_t = typename ttg_data_inline_storage_tuple<ValuesTuple>::type;
+
   } // namespace detail
 
 } // namespace ttg_parsec
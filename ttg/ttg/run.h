@@ -9,6 +9,13 @@
 
 #include "ttg/util/bug.h"
 #include "ttg/util/env.h"
+#include "ttg/util/flight_recorder.h"
+#include "ttg/util/slab_allocator.h"
+#include "ttg/util/timeline.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
 
 namespace ttg {
 
@@ -43,6 +50,23 @@ namespace ttg {
     // finish setting up the Debugger, if needed
     if (ttg::Debugger::default_debugger())
       ttg::Debugger::default_debugger()->set_prefix(ttg::default_execution_context().rank());
+
+    // if requested by user, record the timeline of the tasks, see ttg::Timeline
+    if (std::getenv("TTG_TIMELINE")) {
+      auto timeline =
+          std::make_shared<Timeline>(ttg::default_execution_context().rank(), 1024, detail::timeline_max_events());
+      detail::default_timeline() = timeline;
+      add_task_observer(timeline);
+    }
+
+    // if requested by user, keep the last events of each thread, see ttg::FlightRecorder
+    auto flight_recorder_cstr = std::getenv("TTG_FLIGHT_RECORDER");
+    if (flight_recorder_cstr && std::strcmp(flight_recorder_cstr, "0") != 0) {
+      detail::install_default_flight_recorder(
+          std::make_shared<FlightRecorder>(ttg::default_execution_context().rank(),
+                                           *flight_recorder_cstr ? flight_recorder_cstr : "ttg_flight",
+                                           detail::flight_recorder_events()));
+    }
   }
 
   /// Finalizes the TTG runtime
@@ -52,9 +76,31 @@ namespace ttg {
   /// @note Dispatches to the default backend's `ttg_finalize`.
   /// @note This is a collective operation with respect to the default execution context used by the matching
   /// `initialize` call
+  /// @note If the environment variable `TTG_SLAB_STATS` is set the statistics of the slab pools used for
+  /// backend objects (see ttg::detail::slab_pool) are printed to `std::cerr`
+  /// @note If the environment variable `TTG_TIMELINE` is set the timeline of the tasks recorded since `initialize`
+  /// is written to the file it names (see ttg::Timeline::write), with the rank inserted before the extension if
+  /// there are several processes; the timeline is in the Perfetto format if the extension is `.pftrace`, and in
+  /// the Chrome JSON format otherwise; each thread records up to `TTG_TIMELINE_MAX_EVENTS` events (see
+  /// ttg::detail::timeline_max_events), and the number of events dropped beyond is reported
+  /// @note If the environment variable `TTG_FLIGHT_RECORDER` is set, and not `0`, the flight recorder installed by
+  /// `initialize` (see ttg::FlightRecorder) is removed; its dumps are named after the value of the variable, or
+  /// `ttg_flight`
   /// @internal ENABLE_WHEN_TTG_CAN_MULTIBACKEND To finalize the TTG runtime with multiple backends must call the
   /// corresponding `ttg_finalize` functions explicitly.
-  inline void finalize() { TTG_IMPL_NS::ttg_finalize(); }
+  inline void finalize() {
+    if (std::getenv("TTG_SLAB_STATS")) detail::print_slab_pools_stats(std::cerr);
+    detail::uninstall_default_flight_recorder();
+    if (auto timeline_cstr = std::getenv("TTG_TIMELINE"); timeline_cstr && detail::default_timeline()) {
+      auto world = ttg::default_execution_context();
+      remove_task_observer(detail::default_timeline());
+      if (const auto dropped = detail::default_timeline()->dropped())
+        ttg::print_error("ttg::finalize: the timeline dropped ", dropped, " events, see TTG_TIMELINE_MAX_EVENTS");
+      detail::default_timeline()->write(detail::timeline_file_name(timeline_cstr, world.rank(), world.size()));
+      detail::default_timeline().reset();
+    }
+    TTG_IMPL_NS::ttg_finalize();
+  }
 
   /// Aborts the TTG program using the default backend's `ttg_abort` method
   inline void abort() { TTG_IMPL_NS::ttg_abort(); }
@@ -78,6 +124,38 @@ namespace ttg {
   /// @note This is a collective operation with respect to @p world
   inline void fence(World world = default_execution_context()) { TTG_IMPL_NS::ttg_fence(world); }
 
+  /// Starts a split-phase fence: returns immediately, while the tasks associated with the given execution context
+  /// finish on all ranks; the fence is completed by fence_test() or fence_wait().
+
+  /// @param world  an execution context associated with the default backend
+  /// @note This is a collective operation with respect to @p world
+  /// @note Until the fence completes no task may be injected into @p world and no TT may be created in it; the
+  ///       creation of a TT throws std::logic_error
+  inline void fence_begin(World world = default_execution_context()) { world.fence_begin(); }
+
+  /// @param world  an execution context associated with the default backend
+  /// @return true, and completes the fence, if the split-phase fence started by fence_begin() on @p world is
+  ///         complete or if none was started; does not block
+  inline bool fence_test(World world = default_execution_context()) { return world.fence_test(); }
+
+  /// Returns when the split-phase fence started by fence_begin() on the given execution context, if any, is complete.
+
+  /// @param world  an execution context associated with the default backend
+  inline void fence_wait(World world = default_execution_context()) { world.fence_wait(); }
+
+  /// Returns a handle on the termination of a TT or a TTG, which can be tested or waited for without a fence.
+
+  /// @param tt a TT or a TTG of @p world
+  /// @param world  an execution context associated with the default backend
+  /// @return a handle that becomes ready once the tasks of @p tt and of the TTs upstream of it terminated, if @p world
+  ///         has a single process, or once @p world became quiescent, e.g. in a fence started by fence_begin(); see
+  ///         ttg::Completion
+  /// @note Must be called after the TTs upstream of @p tt are connected to it, and before the fence that the handle
+  ///       is to observe; not a collective
+  inline Completion completion(const TTBase& tt, World world = default_execution_context()) {
+    return world.completion(tt);
+  }
+
   /// @param world an execution context to query the process rank from
   /// @note Calls \c rank() on \c world
   inline int rank(World world = default_execution_context()) { return world.rank(); }
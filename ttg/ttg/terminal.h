@@ -206,7 +206,7 @@ namespace ttg {
     std::enable_if_t<meta::is_none_void_v<Key, Value> && std::is_same_v<Value, std::remove_reference_t<Value>>, void>
     send(const Key &key, Value &&value) {
       if (!move_callback) throw std::runtime_error("move callback not initialized");
-      move_callback(key, std::forward<valueT>(value));
+      move_callback(key, std::forward<Value>(value));
     }
 
     template <typename Key = keyT>
@@ -487,11 +487,24 @@ namespace ttg {
     send(const Key &key, Value &&value) {
       const std::size_t N = this->nsuccessors();
       TerminalBase *move_successor = nullptr;
+      // if no successor consumes the value the last reader gets it, e.g. to keep it instead of copying it
+      TerminalBase *last_reader = nullptr;
+      for (std::size_t i = N; i != 0; --i) {
+        TerminalBase *successor = this->successors().at(i - 1);
+        if (successor->get_type() == TerminalBase::Type::Consume) {
+          last_reader = nullptr;
+          break;
+        } else if (successor->get_type() == TerminalBase::Type::Read && nullptr == last_reader) {
+          last_reader = successor;
+        }
+      }
       // send copies to every terminal except the one we will move the results to
       for (std::size_t i = 0; i != N; ++i) {
         TerminalBase *successor = this->successors().at(i);
         if (successor->get_type() == TerminalBase::Type::Read) {
-          static_cast<In<keyT, std::add_const_t<valueT>> *>(successor)->send(key, value);
+          if (successor != last_reader) {
+            static_cast<In<keyT, std::add_const_t<valueT>> *>(successor)->send(key, value);
+          }
         } else if (successor->get_type() == TerminalBase::Type::Consume) {
           if (nullptr == move_successor) {
             move_successor = successor;
@@ -502,6 +515,8 @@ namespace ttg {
       }
       if (nullptr != move_successor) {
         static_cast<In<keyT, valueT> *>(move_successor)->send(key, std::forward<Value>(value));
+      } else if (nullptr != last_reader) {
+        static_cast<In<keyT, std::add_const_t<valueT>> *>(last_reader)->send(key, std::forward<Value>(value));
       }
     }
 
@@ -83,6 +83,10 @@ namespace ttg {
 
     void fence() { tts[0]->fence(); }
 
+    void get_counter_slots(std::vector<const detail::tt_counter_slots *> &counters) const override {
+      for (auto &tt : tts) tt->get_counter_slots(counters);
+    }
+
     void make_executable() {
       for (auto &op : tts) op->make_executable();
     }
@@ -35,6 +35,7 @@
 #include <iostream>
 #include <iterator>
 #include <sstream>
+#include <stdexcept>
 
 #include "backtrace.h"
 
@@ -51,6 +52,9 @@ using namespace ttg;
 
 static Debugger *signals[NSIG];
 
+static constexpr int max_debugger_hooks = 8;
+static detail::debugger_hook debugger_hooks[max_debugger_hooks];
+
 //////////////////////////////////////////////////////////////////////
 // Debugger class definition
 
@@ -282,6 +286,8 @@ void Debugger::got_signal(int sig) {
 
   if (traceback_) {
     traceback(signame);
+  } else {
+    detail::call_debugger_hooks(signame);
   }
   if (debug_) {
     debug(signame);
@@ -311,7 +317,10 @@ std::shared_ptr<Debugger> Debugger::default_debugger() { return default_debugger
 
 #define SIMPLE_STACK (defined(linux) && defined(i386)) || (defined(__OSF1__) && defined(i860))
 
-void Debugger::traceback(const char *reason) { Debugger::__traceback(prefix_, reason); }
+void Debugger::traceback(const char *reason) {
+  detail::call_debugger_hooks(reason);
+  Debugger::__traceback(prefix_, reason);
+}
 
 void Debugger::__traceback(const std::string &prefix, const char *reason) {
   detail::Backtrace result(prefix);
@@ -344,6 +353,33 @@ void Debugger::__traceback(const std::string &prefix, const char *reason) {
 /////////////////////////////////////////////////////////////////////////////
 
 namespace ttg {
+  namespace detail {
+    void add_debugger_hook(debugger_hook hook) {
+      for (auto &h : debugger_hooks) {
+        if (h == hook) return;
+      }
+      for (auto &h : debugger_hooks) {
+        if (h == nullptr) {
+          h = hook;
+          return;
+        }
+      }
+      throw std::runtime_error("ttg::detail::add_debugger_hook: too many hooks");
+    }
+
+    void remove_debugger_hook(debugger_hook hook) {
+      for (auto &h : debugger_hooks) {
+        if (h == hook) h = nullptr;
+      }
+    }
+
+    void call_debugger_hooks(const char *reason) {
+      for (auto h : debugger_hooks) {
+        if (h) h(reason);
+      }
+    }
+  }  // namespace detail
+
   void launch_debugger(int rank, const char *exec_name, const char *cmd) {
     using ttg::Debugger;
     auto debugger = std::make_shared<Debugger>();
@@ -355,6 +355,24 @@ namespace ttg {
 }  // namespace ttg
 
 namespace ttg {
+  namespace detail {
+
+    /// a function called with the reason by Debugger::traceback(), and by Debugger::got_signal() if the traceback is
+    /// off, before anything is printed; e.g. to dump diagnostics. Called in signal handlers, hence must be
+    /// async-signal-safe.
+    using debugger_hook = void (*)(const char *reason);
+
+    /// Adds @p hook to the hooks of the debuggers; at most 8 hooks can be added. Not thread safe.
+    void add_debugger_hook(debugger_hook hook);
+
+    /// Removes @p hook from the hooks of the debuggers. Not thread safe.
+    void remove_debugger_hook(debugger_hook hook);
+
+    /// Calls the hooks of the debuggers with @p reason
+    void call_debugger_hooks(const char *reason);
+
+  }  // namespace detail
+
   void launch_debugger(int rank, const char *exec_name, const char *cmd);
 
   void launch_lldb(int rank = 0, const char *exec_name = "");
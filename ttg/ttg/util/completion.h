@@ -0,0 +1,109 @@
+#ifndef TTG_UTIL_COMPLETION_H
+#define TTG_UTIL_COMPLETION_H
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ttg/util/counters.h"
+
+namespace ttg {
+
+  /// A handle on the termination of a TT or of a TTG, obtained with ttg::completion(). Unlike a fence it is neither
+  /// collective nor a barrier: the calling thread can test it, or wait for it, while the tasks of other TTs keep
+  /// running. The handle observes the TTs and all the TTs upstream of them, i.e. the TTs that send them inputs,
+  /// directly or transitively. It is ready once
+  ///  - these TTs terminated on this process: every task created so far has completed, including none. This
+  ///    requires that the injection of the inputs from outside the TTs, e.g. by TT::invoke(), is over when the handle
+  ///    is tested; it is only considered if the world has a single process, since inputs can arrive from other
+  ///    processes at any time;
+  ///  - or the world became quiescent since the creation of the handle, e.g. in a fence started by ttg::fence_begin().
+  ///
+  /// The handle must not outlive the TTs and their world.
+  class Completion {
+   public:
+    /// an invalid handle
+    Completion() = default;
+
+    /// @param counters the counters of the TTs and of the TTs upstream of them, whose counts of created and executed
+    ///        tasks are observed; must not be reset while the handle is used
+    /// @param quiescences the number of times the world became quiescent, see ttg::base::WorldImplBase::quiescences
+    /// @param local_termination if true the handle becomes ready once the TTs terminated on this process
+    Completion(std::vector<const detail::tt_counter_slots *> counters, const std::atomic<std::uint64_t> *quiescences,
+               bool local_termination)
+        : counters(std::move(counters)), quiescences(quiescences), local_termination(local_termination) {
+      start = count_completed();
+      start_quiescences = quiescences->load(std::memory_order_acquire);
+    }
+
+    /// @return true if this handle refers to TTs
+    bool valid() const { return nullptr != quiescences; }
+
+    /// @return the number of tasks of the TTs completed on this process since the creation of this handle
+    std::uint64_t completed() const { return count_completed() - start; }
+
+    /// @return true if the TTs terminated; does not block
+    bool ready() const {
+      assert(valid());
+      if (quiescences->load(std::memory_order_acquire) != start_quiescences) return true;
+      if (!local_termination) return false;
+      // a task is created by the task that sends it its first input, which is upstream of it and completes later:
+      // the completions counted by the first read imply the creations they caused, so the counts are equal only if
+      // every task counted by the second read has completed
+      const auto ncompleted = count_completed();
+      std::uint64_t ncreated = 0;
+      for (auto c : counters) ncreated += c->get(detail::tt_counter_slots::tasks_created);
+      return ncreated == ncompleted;
+    }
+
+    /// blocks until the TTs terminated
+    void wait() const {
+      assert(valid());
+      auto backoff = std::chrono::microseconds(1);
+      while (!ready()) {
+        std::this_thread::sleep_for(backoff);
+        backoff = std::min(backoff * 2, max_backoff);
+      }
+    }
+
+    /// blocks until the TTs terminated or @p timeout has elapsed
+    /// @return std::future_status::ready if the TTs terminated, std::future_status::timeout otherwise
+    template <typename Rep, typename Period>
+    std::future_status wait_for(const std::chrono::duration<Rep, Period> &timeout) const {
+      assert(valid());
+      const auto deadline = std::chrono::steady_clock::now() + timeout;
+      auto backoff = std::chrono::microseconds(1);
+      while (!ready()) {
+        if (std::chrono::steady_clock::now() >= deadline) return std::future_status::timeout;
+        std::this_thread::sleep_for(backoff);
+        backoff = std::min(backoff * 2, max_backoff);
+      }
+      return std::future_status::ready;
+    }
+
+   private:
+    static constexpr std::chrono::microseconds max_backoff{1000};
+
+    std::uint64_t count_completed() const {
+      std::uint64_t result = 0;
+      for (auto c : counters) result += c->get(detail::tt_counter_slots::tasks_executed);
+      return result;
+    }
+
+    std::vector<const detail::tt_counter_slots *> counters;
+    const std::atomic<std::uint64_t> *quiescences = nullptr;
+    bool local_termination = false;
+    std::uint64_t start = 0;
+    std::uint64_t start_quiescences = 0;
+  };
+
+}  // namespace ttg
+
+#endif  // TTG_UTIL_COMPLETION_H
@@ -0,0 +1,232 @@
+#ifndef TTG_UTIL_COUNTERS_H
+#define TTG_UTIL_COUNTERS_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ttg/util/thread_index.h"
+
+namespace ttg {
+
+  /// The runtime counters of a TT, see TTBase::get_counters() and ttg::World::counters()
+  struct TTCounters {
+    std::string name;                           //!< the name of the TT
+    std::uint64_t tasks_created = 0;            //!< tasks created, i.e. that received their first input, or fused
+    std::uint64_t tasks_executed = 0;           //!< tasks executed, including the inlined tasks
+    std::uint64_t tasks_inlined = 0;            //!< tasks executed by the thread that made them ready, or fused
+    std::uint64_t set_arg_local = 0;            //!< inputs set on tasks owned by this process
+    std::uint64_t set_arg_remote = 0;           //!< inputs forwarded to the process owning the task
+    std::uint64_t reducer_calls = 0;            //!< invocations of the reducers of the streaming inputs
+    std::uint64_t data_copies_created = 0;      //!< input values stored by the tasks
+    std::uint64_t data_copies_deep_copied = 0;  //!< input values stored by copying, rather than moving, the sent value
+    std::uint64_t peak_pending_tasks = 0;       //!< the largest number of tasks created but not completed, only
+                                                //!< tracked while the TT has a limit (see TTBase::set_max_pending_tasks)
+    std::vector<std::uint64_t> bytes_sent;      //!< per input terminal, bytes sent to the processes owning the tasks
+    std::vector<std::uint64_t> bytes_received;  //!< per input terminal, bytes received from other processes
+
+    /// adds the counters of @p other, i.e. of the same TT on another process; keeps the largest peak
+    TTCounters &operator+=(const TTCounters &other) {
+      tasks_created += other.tasks_created;
+      tasks_executed += other.tasks_executed;
+      tasks_inlined += other.tasks_inlined;
+      set_arg_local += other.set_arg_local;
+      set_arg_remote += other.set_arg_remote;
+      reducer_calls += other.reducer_calls;
+      data_copies_created += other.data_copies_created;
+      data_copies_deep_copied += other.data_copies_deep_copied;
+      peak_pending_tasks = std::max(peak_pending_tasks, other.peak_pending_tasks);
+      bytes_sent.resize(std::max(bytes_sent.size(), other.bytes_sent.size()));
+      for (std::size_t t = 0; t < other.bytes_sent.size(); ++t) bytes_sent[t] += other.bytes_sent[t];
+      bytes_received.resize(std::max(bytes_received.size(), other.bytes_received.size()));
+      for (std::size_t t = 0; t < other.bytes_received.size(); ++t) bytes_received[t] += other.bytes_received[t];
+      return *this;
+    }
+  };
+
+  /// The formats of ttg::write_counters()
+  enum class CountersFormat { JSON, CSV };
+
+  namespace detail {
+
+    /// the counters of a TT on this process, updated by the backends; the counters, including the bytes counted per
+    /// input terminal, are kept in per-thread slots (see this_thread_index()) to avoid contention and summed by
+    /// snapshot()
+    class tt_counter_slots {
+     public:
+      /// the hot counters, see TTCounters
+      enum counter : std::size_t {
+        tasks_created,
+        tasks_executed,
+        tasks_inlined,
+        set_arg_local,
+        set_arg_remote,
+        reducer_calls,
+        data_copies_created,
+        data_copies_deep_copied,
+        num_counters
+      };
+
+      /// @param num_inputs the number of input terminals of the TT
+      explicit tt_counter_slots(std::size_t num_inputs)
+          : num_slots(default_num_slots())
+          , slots(new slot[num_slots])
+          , num_inputs(num_inputs)
+          , byte_lines_per_slot((2 * num_inputs + line::size - 1) / line::size)
+          , bytes(new line[num_slots * byte_lines_per_slot]) {
+        reset();
+      }
+
+      /// adds @p n to counter @p c; a release, e.g. a task created by a task is counted before the latter is counted
+      /// as executed (see ttg::Completion)
+      void add(counter c, std::uint64_t n = 1) {
+        slots[this_thread_index() % num_slots].values[c].fetch_add(n, std::memory_order_release);
+      }
+
+      /// @return the current value of counter @p c
+      std::uint64_t get(counter c) const {
+        std::uint64_t result = 0;
+        for (std::size_t s = 0; s < num_slots; ++s) result += slots[s].values[c].load(std::memory_order_acquire);
+        return result;
+      }
+
+      void add_bytes_sent(std::size_t input, std::uint64_t n) {
+        if (input < num_inputs)
+          byte_count(this_thread_index() % num_slots, input).fetch_add(n, std::memory_order_relaxed);
+      }
+
+      void add_bytes_received(std::size_t input, std::uint64_t n) {
+        if (input < num_inputs)
+          byte_count(this_thread_index() % num_slots, num_inputs + input).fetch_add(n, std::memory_order_relaxed);
+      }
+
+      /// @return the current counters; TTCounters::name and TTCounters::peak_pending_tasks are not set
+      TTCounters snapshot() const {
+        std::uint64_t values[num_counters] = {};
+        for (std::size_t s = 0; s < num_slots; ++s)
+          for (std::size_t c = 0; c < num_counters; ++c) values[c] += slots[s].values[c].load(std::memory_order_relaxed);
+        TTCounters result;
+        result.tasks_created = values[tasks_created];
+        result.tasks_executed = values[tasks_executed];
+        result.tasks_inlined = values[tasks_inlined];
+        result.set_arg_local = values[set_arg_local];
+        result.set_arg_remote = values[set_arg_remote];
+        result.reducer_calls = values[reducer_calls];
+        result.data_copies_created = values[data_copies_created];
+        result.data_copies_deep_copied = values[data_copies_deep_copied];
+        result.bytes_sent.resize(num_inputs);
+        result.bytes_received.resize(num_inputs);
+        for (std::size_t s = 0; s < num_slots; ++s) {
+          for (std::size_t t = 0; t < num_inputs; ++t) {
+            result.bytes_sent[t] += byte_count(s, t).load(std::memory_order_relaxed);
+            result.bytes_received[t] += byte_count(s, num_inputs + t).load(std::memory_order_relaxed);
+          }
+        }
+        return result;
+      }
+
+      /// zeroes the counters
+      void reset() {
+        for (std::size_t s = 0; s < num_slots; ++s)
+          for (auto &value : slots[s].values) value.store(0, std::memory_order_relaxed);
+        for (std::size_t l = 0; l < num_slots * byte_lines_per_slot; ++l)
+          for (auto &value : bytes[l].values) value.store(0, std::memory_order_relaxed);
+      }
+
+     private:
+      static std::size_t default_num_slots() {
+        static const std::size_t n = std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, 64);
+        return n;
+      }
+
+      struct alignas(64) slot {
+        std::atomic<std::uint64_t> values[num_counters];
+      };
+
+      /// a cache line of byte counts
+      struct alignas(64) line {
+        static constexpr std::size_t size = 8;
+        std::atomic<std::uint64_t> values[size];
+      };
+
+      /// @return byte count @p k of slot @p s: the bytes sent to each input, then the bytes received by each input
+      std::atomic<std::uint64_t> &byte_count(std::size_t s, std::size_t k) const {
+        return bytes[s * byte_lines_per_slot + k / line::size].values[k % line::size];
+      }
+
+      std::size_t num_slots;
+      std::unique_ptr<slot[]> slots;
+      std::size_t num_inputs;
+      std::size_t byte_lines_per_slot;  //!< the cache lines of byte counts of each slot, which do not share lines
+      std::unique_ptr<line[]> bytes;
+    };
+
+    /// writes @p str as a JSON string
+    inline void write_json_string(std::ostream &os, const std::string &str) {
+      os << '"';
+      for (char c : str) {
+        if (c == '"' || c == '\\')
+          os << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20)
+          os << ' ';
+        else
+          os << c;
+      }
+      os << '"';
+    }
+
+    /// writes @p values separated by @p sep
+    inline void write_list(std::ostream &os, const std::vector<std::uint64_t> &values, const char *sep) {
+      for (std::size_t t = 0; t < values.size(); ++t) os << (t ? sep : "") << values[t];
+    }
+
+  }  // namespace detail
+
+  /// Writes @p counters to @p os, as a JSON array of objects or as CSV with a header line; in CSV the bytes sent and
+  /// received per input terminal are lists separated by semicolons
+  inline void write_counters(std::ostream &os, const std::vector<TTCounters> &counters,
+                             CountersFormat format = CountersFormat::JSON) {
+    if (format == CountersFormat::JSON) {
+      os << "[";
+      for (std::size_t k = 0; k < counters.size(); ++k) {
+        const auto &c = counters[k];
+        os << (k ? ",\n " : "\n ") << "{\"name\": ";
+        detail::write_json_string(os, c.name);
+        os << ", \"tasks_created\": " << c.tasks_created << ", \"tasks_executed\": " << c.tasks_executed
+           << ", \"tasks_inlined\": " << c.tasks_inlined << ", \"set_arg_local\": " << c.set_arg_local
+           << ", \"set_arg_remote\": " << c.set_arg_remote << ", \"reducer_calls\": " << c.reducer_calls
+           << ", \"data_copies_created\": " << c.data_copies_created
+           << ", \"data_copies_deep_copied\": " << c.data_copies_deep_copied
+           << ", \"peak_pending_tasks\": " << c.peak_pending_tasks << ", \"bytes_sent\": [";
+        detail::write_list(os, c.bytes_sent, ", ");
+        os << "], \"bytes_received\": [";
+        detail::write_list(os, c.bytes_received, ", ");
+        os << "]}";
+      }
+      os << "\n]\n";
+    } else {
+      os << "name,tasks_created,tasks_executed,tasks_inlined,set_arg_local,set_arg_remote,reducer_calls,"
+            "data_copies_created,data_copies_deep_copied,peak_pending_tasks,bytes_sent,bytes_received\n";
+      for (const auto &c : counters) {
+        os << '"';
+        for (char ch : c.name) os << (ch == '"' ? "\"\"" : std::string(1, ch));
+        os << "\"," << c.tasks_created << ',' << c.tasks_executed << ',' << c.tasks_inlined << ',' << c.set_arg_local
+           << ',' << c.set_arg_remote << ',' << c.reducer_calls << ',' << c.data_copies_created << ','
+           << c.data_copies_deep_copied << ',' << c.peak_pending_tasks << ',';
+        detail::write_list(os, c.bytes_sent, ";");
+        os << ',';
+        detail::write_list(os, c.bytes_received, ";");
+        os << '\n';
+      }
+    }
+  }
+
+}  // namespace ttg
+
+#endif  // TTG_UTIL_COUNTERS_H
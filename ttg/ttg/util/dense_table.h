@@ -0,0 +1,106 @@
+#ifndef TTG_UTIL_DENSE_TABLE_H
+#define TTG_UTIL_DENSE_TABLE_H
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <thread>
+
+namespace ttg {
+  namespace detail {
+
+    /// A table of pointers indexed by a dense integer index, e.g. a linearized task key, used by the backends to
+    /// store pending tasks when the key domain is known (see TT::set_key_domain). Accesses to an entry are
+    /// synchronized by one of a fixed number of spinlocks, selected by the index (lock striping), so
+    /// unlike in a hash table no hashing, bucket traversal or bucket allocation is needed. The nonempty entries are
+    /// counted per lock, so that no cache line is shared by all the updates.
+    /// @tparam T the pointee type; entries are nullptr when empty
+    template <typename T>
+    class dense_table {
+     public:
+      static constexpr std::size_t default_num_locks = 1024;
+
+      /// @param extent the number of entries, i.e. indices are in [0, extent)
+      /// @param num_locks the number of locks striped over the entries, rounded up to a power of 2
+      explicit dense_table(std::size_t extent, std::size_t num_locks = default_num_locks)
+          : m_extent(extent), m_entries(new std::atomic<T *>[extent]) {
+        std::size_t n = 1;
+        while (n < num_locks) n <<= 1;
+        m_lock_mask = n - 1;
+        m_locks.reset(new lock_t[n]);
+        for (std::size_t idx = 0; idx < extent; ++idx) m_entries[idx].store(nullptr, std::memory_order_relaxed);
+      }
+
+      dense_table(const dense_table &) = delete;
+      dense_table &operator=(const dense_table &) = delete;
+
+      /// @return the number of entries
+      std::size_t extent() const { return m_extent; }
+
+      /// acquires the lock protecting entry @p idx
+      void lock(std::size_t idx) {
+        assert(idx < m_extent);
+        auto &flag = m_locks[idx & m_lock_mask].flag;
+        while (flag.test_and_set(std::memory_order_acquire)) {
+          std::this_thread::yield();
+        }
+      }
+
+      /// releases the lock protecting entry @p idx
+      void unlock(std::size_t idx) { m_locks[idx & m_lock_mask].flag.clear(std::memory_order_release); }
+
+      /// @return entry @p idx, nullptr if empty; the lock of the entry should be held
+      T *get(std::size_t idx) const {
+        assert(idx < m_extent);
+        return m_entries[idx].load(std::memory_order_relaxed);
+      }
+
+      /// sets entry @p idx to @p ptr, nullptr to clear it; the lock of the entry should be held
+      void set(std::size_t idx, T *ptr) {
+        assert(idx < m_extent);
+        auto prev = m_entries[idx].exchange(ptr, std::memory_order_relaxed);
+        // only the holder of the lock updates its count, no read-modify-write is needed
+        auto &count = m_locks[idx & m_lock_mask].count;
+        if (nullptr == prev && nullptr != ptr)
+          count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        else if (nullptr != prev && nullptr == ptr)
+          count.store(count.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+      }
+
+      /// @return the number of nonempty entries; not synchronized with concurrent updates
+      std::size_t size() const {
+        std::size_t result = 0;
+        for (std::size_t l = 0; l <= m_lock_mask; ++l) result += m_locks[l].count.load(std::memory_order_relaxed);
+        return result;
+      }
+
+      /// calls @p f(idx, ptr) for every nonempty entry; not synchronized with concurrent updates
+      template <typename F>
+      void for_each(F &&f) const {
+        auto remaining = size();
+        for (std::size_t idx = 0; idx < m_extent && remaining > 0; ++idx) {
+          auto ptr = m_entries[idx].load(std::memory_order_relaxed);
+          if (nullptr != ptr) {
+            --remaining;
+            f(idx, ptr);
+          }
+        }
+      }
+
+     private:
+      struct alignas(64) lock_t {
+        std::atomic_flag flag = ATOMIC_FLAG_INIT;
+        std::atomic<std::size_t> count = 0;  //!< the nonempty entries protected by this lock
+      };
+
+      std::size_t m_extent;
+      std::unique_ptr<std::atomic<T *>[]> m_entries;
+      std::unique_ptr<lock_t[]> m_locks;
+      std::size_t m_lock_mask;
+    };
+
+  }  // namespace detail
+}  // namespace ttg
+
+#endif  // TTG_UTIL_DENSE_TABLE_H
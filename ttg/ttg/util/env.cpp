@@ -5,6 +5,7 @@
 #include "ttg/util/env.h"
 
 #include <thread>
+#include <limits>
 #include <stdexcept>
 
 #include <cstdlib>
@@ -30,5 +31,89 @@ namespace ttg {
       return static_cast<int>(result);
     }
 
+    int max_inline_depth() {
+      static const int result = []() {
+        const char* ttg_max_inline_depth_cstr = std::getenv("TTG_MAX_INLINE_DEPTH");
+        if (ttg_max_inline_depth_cstr) {
+          const auto result_long = std::atol(ttg_max_inline_depth_cstr);
+          if (result_long < 0 || result_long > std::numeric_limits<int>::max())
+            throw std::runtime_error("ttg: invalid value of environment variable TTG_MAX_INLINE_DEPTH");
+          return static_cast<int>(result_long);
+        }
+        return 6;
+      }();
+      return result;
+    }
+
+    bool auto_fuse() {
+      static const bool result = []() {
+        const char* ttg_auto_fuse_cstr = std::getenv("TTG_AUTO_FUSE");
+        if (ttg_auto_fuse_cstr) {
+          const auto result_long = std::atol(ttg_auto_fuse_cstr);
+          if (result_long != 0 && result_long != 1)
+            throw std::runtime_error("ttg: invalid value of environment variable TTG_AUTO_FUSE");
+          return result_long == 1;
+        }
+        return false;
+      }();
+      return result;
+    }
+
+    long budget_stall_timeout() {
+      static const long result = []() {
+        const char* ttg_budget_stall_timeout_cstr = std::getenv("TTG_BUDGET_STALL_TIMEOUT");
+        if (ttg_budget_stall_timeout_cstr) {
+          const auto result_long = std::atol(ttg_budget_stall_timeout_cstr);
+          if (result_long < 0)
+            throw std::runtime_error("ttg: invalid value of environment variable TTG_BUDGET_STALL_TIMEOUT");
+          return result_long;
+        }
+        return 10000L;
+      }();
+      return result;
+    }
+
+    long flight_recorder_events() {
+      static const long result = []() {
+        const char* ttg_flight_recorder_events_cstr = std::getenv("TTG_FLIGHT_RECORDER_EVENTS");
+        if (ttg_flight_recorder_events_cstr) {
+          const auto result_long = std::atol(ttg_flight_recorder_events_cstr);
+          if (result_long < 1)
+            throw std::runtime_error("ttg: invalid value of environment variable TTG_FLIGHT_RECORDER_EVENTS");
+          return result_long;
+        }
+        return 4096L;
+      }();
+      return result;
+    }
+
+    long flight_recorder_stall_timeout() {
+      static const long result = []() {
+        const char* ttg_flight_recorder_stall_timeout_cstr = std::getenv("TTG_FLIGHT_RECORDER_STALL_TIMEOUT");
+        if (ttg_flight_recorder_stall_timeout_cstr) {
+          const auto result_long = std::atol(ttg_flight_recorder_stall_timeout_cstr);
+          if (result_long < 0)
+            throw std::runtime_error("ttg: invalid value of environment variable TTG_FLIGHT_RECORDER_STALL_TIMEOUT");
+          return result_long;
+        }
+        return 60L;
+      }();
+      return result;
+    }
+
+    long timeline_max_events() {
+      static const long result = []() {
+        const char* ttg_timeline_max_events_cstr = std::getenv("TTG_TIMELINE_MAX_EVENTS");
+        if (ttg_timeline_max_events_cstr) {
+          const auto result_long = std::atol(ttg_timeline_max_events_cstr);
+          if (result_long < 1)
+            throw std::runtime_error("ttg: invalid value of environment variable TTG_TIMELINE_MAX_EVENTS");
+          return result_long;
+        }
+        return 1L << 20;
+      }();
+      return result;
+    }
+
   }  // namespace detail
 }  // namespace ttg
@@ -16,6 +16,48 @@ namespace ttg {
     /// @post `num_threads()>0`
     int num_threads();
 
+    /// Determine the default maximum depth of inline (work-first) task execution
+
+    /// The depth is queried from the environment variable `TTG_MAX_INLINE_DEPTH`; if not given, 6 is used.
+    /// @return the default maximum number of tasks that can be nested on a thread by inline execution
+    /// @post `max_inline_depth()>=0`
+    int max_inline_depth();
+
+    /// Determine whether ttg::make_graph_executable fuses the linear chains of TTs
+
+    /// Queried from the environment variable `TTG_AUTO_FUSE`; if not given, the chains are not fused.
+    /// @return true if ttg::make_graph_executable fuses the linear chains of TTs (see TTBase::set_fused)
+    bool auto_fuse();
+
+    /// Determine how long producers deferred by an exceeded memory budget wait for a task to complete
+
+    /// Queried from the environment variable `TTG_BUDGET_STALL_TIMEOUT` (in microseconds); if not given, 10000 is used.
+    /// @return the time, in microseconds, after which a deferred producer proceeds if no task completes
+    /// @post `budget_stall_timeout()>=0`
+    long budget_stall_timeout();
+
+    /// Determine the number of events kept per thread by the flight recorder
+
+    /// Queried from the environment variable `TTG_FLIGHT_RECORDER_EVENTS`; if not given, 4096 is used.
+    /// @return the capacity of the per-thread event rings of ttg::FlightRecorder
+    /// @post `flight_recorder_events()>0`
+    long flight_recorder_events();
+
+    /// Determine how long a fence may wait without any task event before the flight recorder is dumped
+
+    /// Queried from the environment variable `TTG_FLIGHT_RECORDER_STALL_TIMEOUT` (in seconds); if not given, 60 is
+    /// used. 0 disables the detection of stalled fences.
+    /// @return the time, in seconds, after which a fence without progress dumps ttg::FlightRecorder
+    /// @post `flight_recorder_stall_timeout()>=0`
+    long flight_recorder_stall_timeout();
+
+    /// Determine the number of events recorded per thread by the timeline of `TTG_TIMELINE`
+
+    /// Queried from the environment variable `TTG_TIMELINE_MAX_EVENTS`; if not given, 1048576 is used.
+    /// @return the number of events each thread can record in ttg::Timeline before its events are dropped
+    /// @post `timeline_max_events()>0`
+    long timeline_max_events();
+
   }  // namespace detail
 }  // namespace ttg
 
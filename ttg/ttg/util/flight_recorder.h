@@ -0,0 +1,544 @@
+#ifndef TTG_UTIL_FLIGHT_RECORDER_H
+#define TTG_UTIL_FLIGHT_RECORDER_H
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <istream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "ttg/base/observer.h"
+#include "ttg/base/tt.h"
+#include "ttg/util/bug.h"
+#include "ttg/util/env.h"
+#include "ttg/util/print.h"
+#include "ttg/util/thread_index.h"
+
+namespace ttg {
+
+  /// An event recorded by the flight recorder, see FlightRecorder
+  struct FlightEvent {
+    /// the events, see TaskObserver
+    enum Kind : std::uint16_t {
+      task_created,
+      input_arrived,
+      task_ready,
+      task_started,
+      task_finished,
+      message_sent,
+      message_received,
+      fence_started,
+      fence_finished
+    };
+
+    std::uint64_t time;      //!< in ns since the start of the recorder
+    std::uint64_t key_hash;  //!< the hash of the key of the task, see TaskKey::hash
+    std::uint32_t tt;        //!< the instance id of the TT (see TTBase::get_instance_id), none for the fence events
+    std::int32_t peer;       //!< the destination of a message_sent, -1 otherwise
+    std::uint16_t kind;      //!< the Kind
+    std::uint16_t input;     //!< the input terminal of an input_arrived, message_sent or message_received
+    std::uint32_t bytes;     //!< the size of a message_sent or message_received, saturated
+
+    static constexpr std::uint32_t none = std::numeric_limits<std::uint32_t>::max();
+
+    /// @return the name of @p kind
+    static const char *name(std::uint16_t kind) {
+      static const char *names[] = {"created", "input", "ready", "started", "finished", "sent", "received",
+                                    "fence_started", "fence_finished"};
+      return kind < sizeof(names) / sizeof(names[0]) ? names[kind] : "unknown";
+    }
+  };
+  static_assert(sizeof(FlightEvent) == 32, "FlightEvent is dumped as is");
+
+  namespace detail {
+
+    /// a buffered writer to a file descriptor that is async-signal-safe, i.e. only uses ::write
+    struct fd_writer {
+      int fd;
+      bool ok = true;
+      std::size_t size = 0;
+      char buffer[4096];
+
+      void put(const void *data, std::size_t n) {
+        if (size + n > sizeof(buffer)) flush();
+        if (n > sizeof(buffer)) {
+          write_all(static_cast<const char *>(data), n);
+          return;
+        }
+        std::memcpy(buffer + size, data, n);
+        size += n;
+      }
+      template <typename T>
+      void put(const T &value) {
+        put(&value, sizeof(T));
+      }
+      void put_string(const char *str, std::size_t n) {
+        put(static_cast<std::uint32_t>(n));
+        put(str, n);
+      }
+      void flush() {
+        write_all(buffer, size);
+        size = 0;
+      }
+      void write_all(const char *data, std::size_t n) {
+        while (ok && n > 0) {
+          const auto w = ::write(fd, data, n);
+          if (w < 0 && errno == EINTR) continue;
+          if (w <= 0) {
+            ok = false;
+            break;
+          }
+          data += w;
+          n -= static_cast<std::size_t>(w);
+        }
+      }
+    };
+
+    /// appends the decimal digits of @p value to @p str of capacity @p cap, holding @p len characters;
+    /// async-signal-safe
+    inline void append_decimal(char *str, std::size_t cap, std::size_t &len, std::uint64_t value) {
+      char digits[20];
+      int n = 0;
+      do {
+        digits[n++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+      } while (value > 0);
+      while (n > 0 && len + 1 < cap) str[len++] = digits[--n];
+      str[len] = '\0';
+    }
+
+  }  // namespace detail
+
+  /// A task observer (see ttg::add_task_observer) that keeps the last events of each thread in a fixed-size ring of
+  /// compact binary events (see FlightEvent), at the cost of a clock read and a few stores per event, and dumps them
+  /// to a file on demand, e.g. on a signal, in a debugger hook (see ttg::Debugger) or when a fence makes no progress
+  /// (see watch_fences()). Setting the environment variable `TTG_FLIGHT_RECORDER` to the prefix of the dumps (or to
+  /// an empty value, for `ttg_flight`) installs one on each process between ttg::initialize and ttg::finalize, see
+  /// ttg::detail::install_default_flight_recorder(); it is not installed by default, nor if the variable is `0`.
+  /// The dumps are read by FlightRecord.
+  class FlightRecorder : public TaskObserver {
+   public:
+    /// @param rank the rank of this process
+    /// @param prefix the prefix of the files written by dump(const char*)
+    /// @param events_per_thread the number of events kept per thread, rounded up to a power of 2
+    /// @param max_threads the number of threads that can record events, the events of other threads are dropped
+    explicit FlightRecorder(int rank = 0, std::string prefix = "ttg_flight", std::size_t events_per_thread = 4096,
+                            std::size_t max_threads = 1024)
+        : rank(rank)
+        , prefix(std::move(prefix))
+        , capacity(round_up_to_power_of_2(events_per_thread))
+        , max_threads(max_threads)
+        , rings(new std::atomic<ring *>[max_threads])
+        , steady_epoch(std::chrono::steady_clock::now())
+        , system_epoch(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::system_clock::now().time_since_epoch())
+                           .count()) {
+      for (std::size_t t = 0; t < max_threads; ++t) rings[t].store(nullptr, std::memory_order_relaxed);
+    }
+
+    FlightRecorder(const FlightRecorder &) = delete;
+    FlightRecorder &operator=(const FlightRecorder &) = delete;
+
+    ~FlightRecorder() {
+      stop_watching_fences();
+      for (std::size_t t = 0; t < max_threads; ++t) delete rings[t].load(std::memory_order_acquire);
+      auto *node = names.load(std::memory_order_acquire);
+      while (node) delete std::exchange(node, node->next);
+    }
+
+    void task_created(const TTBase &tt, const TaskKey &key) override { record(FlightEvent::task_created, &tt, key); }
+    void input_arrived(const TTBase &tt, const TaskKey &key, std::size_t input) override {
+      record(FlightEvent::input_arrived, &tt, key, input);
+    }
+    void task_ready(const TTBase &tt, const TaskKey &key) override { record(FlightEvent::task_ready, &tt, key); }
+    void task_started(const TTBase &tt, const TaskKey &key) override { record(FlightEvent::task_started, &tt, key); }
+    void task_finished(const TTBase &tt, const TaskKey &key) override {
+      record(FlightEvent::task_finished, &tt, key);
+    }
+    void message_sent(const TTBase &tt, const TaskKey &key, std::size_t input, int rank, std::size_t bytes,
+                      std::uint64_t message) override {
+      record(FlightEvent::message_sent, &tt, key, input, rank, bytes);
+    }
+    void message_received(const TTBase &tt, const TaskKey &key, std::size_t input, std::size_t bytes,
+                          std::uint64_t message) override {
+      record(FlightEvent::message_received, &tt, key, input, -1, bytes);
+    }
+    void fence_started() override {
+      active_fences.fetch_add(1, std::memory_order_relaxed);
+      record(FlightEvent::fence_started, nullptr, TaskKey());
+    }
+    void fence_finished() override {
+      record(FlightEvent::fence_finished, nullptr, TaskKey());
+      active_fences.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /// @return the number of events recorded so far, including those overwritten
+    std::uint64_t num_events() const {
+      std::uint64_t result = 0;
+      for (std::size_t t = 0; t < max_threads; ++t) {
+        const auto *r = rings[t].load(std::memory_order_acquire);
+        if (r) result += r->head.load(std::memory_order_acquire);
+      }
+      return result;
+    }
+
+    /// Writes the events kept by the threads to the file @p path, with @p reason; async-signal-safe. The events
+    /// recorded while dumping may be torn or left out.
+    /// @return false if the file could not be written or if another dump is in progress
+    bool dump(const char *path, const char *reason) const noexcept {
+      if (dumping.test_and_set(std::memory_order_acquire)) return false;
+      const int fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+      bool ok = fd >= 0;
+      if (ok) {
+        detail::fd_writer w{fd};
+        write_dump(w, reason);
+        w.flush();
+        ok = w.ok;
+        ::close(fd);
+      }
+      dumping.clear(std::memory_order_release);
+      return ok;
+    }
+
+    /// Writes the events kept by the threads, with @p reason, to the next file `<prefix>.<rank>.<n>.ttgfr`, with
+    /// n=0,1,...; async-signal-safe
+    /// @return false if the file could not be written or if another dump is in progress
+    bool dump(const char *reason) const noexcept {
+      char path[4096];
+      std::size_t len = std::min(prefix.size(), sizeof(path) - 64);
+      std::memcpy(path, prefix.data(), len);
+      path[len++] = '.';
+      detail::append_decimal(path, sizeof(path), len, rank);
+      path[len++] = '.';
+      detail::append_decimal(path, sizeof(path), len, ndumps.fetch_add(1, std::memory_order_relaxed));
+      std::memcpy(path + len, ".ttgfr", 7);
+      return dump(path, reason);
+    }
+
+    /// Starts a thread that dumps the events (see dump(const char*)) when no event is recorded for @p timeout while
+    /// a fence is in progress, i.e. when a fence is stalled; once per stall
+    void watch_fences(std::chrono::milliseconds timeout) {
+      stop_watching_fences();
+      watchdog_stop = false;
+      watchdog = std::thread([this, timeout]() {
+        const auto period = std::clamp(timeout / 4, std::chrono::milliseconds(1), std::chrono::milliseconds(1000));
+        auto last_count = num_events();
+        auto last_progress = std::chrono::steady_clock::now();
+        bool dumped = false;
+        std::unique_lock<std::mutex> lock(watchdog_mtx);
+        while (!watchdog_cv.wait_for(lock, period, [this]() { return watchdog_stop; })) {
+          const auto count = num_events();
+          const auto now = std::chrono::steady_clock::now();
+          if (count != last_count || active_fences.load(std::memory_order_relaxed) == 0) {
+            last_count = count;
+            last_progress = now;
+            dumped = false;
+          } else if (!dumped && now - last_progress >= timeout) {
+            dumped = true;
+            ttg::print_error("ttg: no task progressed during a fence for", timeout.count(),
+                             "ms, dumping the flight recorder to", prefix + "." + std::to_string(rank) + ".*.ttgfr");
+            dump("stalled fence");
+          }
+        }
+      });
+    }
+
+    /// stops the thread started by watch_fences(), if any
+    void stop_watching_fences() {
+      {
+        std::lock_guard<std::mutex> lock(watchdog_mtx);
+        watchdog_stop = true;
+      }
+      watchdog_cv.notify_all();
+      if (watchdog.joinable()) watchdog.join();
+    }
+
+    static constexpr char magic[8] = {'T', 'T', 'G', 'F', 'L', 'T', 'R', '1'};
+
+   private:
+    /// the events of a thread, written by that thread only
+    struct ring {
+      std::atomic<std::uint64_t> head = 0;  //!< the number of events recorded so far
+      std::unique_ptr<FlightEvent[]> events;
+      std::vector<bool> named_tts;  //!< the TTs whose names were registered by this thread
+
+      explicit ring(std::size_t capacity) : events(new FlightEvent[capacity]) {}
+    };
+
+    /// the name of a TT, in a list only prepended to so that dump() can read it in a signal handler
+    struct name_node {
+      std::uint32_t tt;
+      std::string name;
+      name_node *next;
+    };
+
+    static std::size_t round_up_to_power_of_2(std::size_t n) {
+      std::size_t result = 1;
+      while (result < n) result <<= 1;
+      return result;
+    }
+
+    ring *this_thread_ring() {
+      const auto t = detail::this_thread_index();
+      if (t >= max_threads) return nullptr;
+      auto *r = rings[t].load(std::memory_order_relaxed);
+      if (nullptr == r) {  // only this thread installs its ring
+        r = new ring(capacity);
+        rings[t].store(r, std::memory_order_release);
+      }
+      return r;
+    }
+
+    void register_name(std::uint32_t tt, const std::string &name) {
+      std::lock_guard<std::mutex> lock(names_mtx);
+      for (auto *node = names.load(std::memory_order_relaxed); node; node = node->next)
+        if (node->tt == tt) return;
+      names.store(new name_node{tt, name, names.load(std::memory_order_relaxed)}, std::memory_order_release);
+    }
+
+    void record(FlightEvent::Kind kind, const TTBase *tt, const TaskKey &key, std::size_t input = 0, int peer = -1,
+                std::size_t bytes = 0) {
+      auto *r = this_thread_ring();
+      if (nullptr == r) return;
+      std::uint32_t id = FlightEvent::none;
+      if (tt) {
+        id = static_cast<std::uint32_t>(tt->get_instance_id());
+        if (id >= r->named_tts.size()) r->named_tts.resize(id + 1);
+        if (!r->named_tts[id]) {
+          register_name(id, tt->get_name());
+          r->named_tts[id] = true;
+        }
+      }
+      const auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                                             steady_epoch)
+                            .count();
+      const auto n = r->head.load(std::memory_order_relaxed);
+      auto &e = r->events[n & (capacity - 1)];
+      e.time = time;
+      e.key_hash = key.hash();
+      e.tt = id;
+      e.peer = peer;
+      e.kind = kind;
+      e.input = static_cast<std::uint16_t>(input);
+      e.bytes = static_cast<std::uint32_t>(std::min<std::size_t>(bytes, std::numeric_limits<std::uint32_t>::max()));
+      r->head.store(n + 1, std::memory_order_release);
+    }
+
+    /// the format of the dumps, in the byte order of this machine, see FlightRecord::read
+    void write_dump(detail::fd_writer &w, const char *reason) const {
+      w.put(magic, sizeof(magic));
+      w.put(static_cast<std::int32_t>(rank));
+      w.put(system_epoch);
+      w.put(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                            std::chrono::steady_clock::now() - steady_epoch)
+                                            .count()));
+      w.put_string(reason ? reason : "", reason ? std::strlen(reason) : 0);
+      std::uint32_t nnames = 0;
+      const auto *first_name = names.load(std::memory_order_acquire);
+      for (auto *node = first_name; node; node = node->next) ++nnames;
+      w.put(nnames);
+      for (auto *node = first_name; node; node = node->next) {
+        w.put(node->tt);
+        w.put_string(node->name.data(), node->name.size());
+      }
+      std::uint32_t nthreads = 0;
+      for (std::size_t t = 0; t < max_threads; ++t)
+        if (rings[t].load(std::memory_order_acquire)) ++nthreads;
+      w.put(nthreads);
+      for (std::size_t t = 0; t < max_threads && nthreads > 0; ++t) {
+        const auto *r = rings[t].load(std::memory_order_acquire);
+        if (nullptr == r) continue;
+        --nthreads;
+        const auto head = r->head.load(std::memory_order_acquire);
+        const auto n = std::min<std::uint64_t>(head, capacity);
+        w.put(static_cast<std::uint32_t>(t));
+        w.put(n);
+        for (auto k = head - n; k != head; ++k) w.put(r->events[k & (capacity - 1)]);
+      }
+    }
+
+    int rank;
+    std::string prefix;
+    std::size_t capacity;  //!< of the rings, a power of 2
+    std::size_t max_threads;
+    std::unique_ptr<std::atomic<ring *>[]> rings;  //!< by thread index, see detail::this_thread_index
+    std::chrono::steady_clock::time_point steady_epoch;
+    std::uint64_t system_epoch;  //!< the time of steady_epoch, in ns since the epoch of the system clock
+    std::mutex names_mtx;
+    std::atomic<name_node *> names = nullptr;
+    std::atomic<int> active_fences = 0;
+    mutable std::atomic_flag dumping = ATOMIC_FLAG_INIT;
+    mutable std::atomic<std::uint64_t> ndumps = 0;
+    std::thread watchdog;
+    std::mutex watchdog_mtx;
+    std::condition_variable watchdog_cv;
+    bool watchdog_stop = false;
+  };
+
+  /// The events of a dump of a FlightRecorder
+  struct FlightRecord {
+    int rank = 0;
+    std::string reason;
+    std::uint64_t origin = 0;  //!< the start of the recorder, in ns since the epoch of the system clock
+    std::uint64_t time = 0;    //!< the time of the dump, in ns since the start of the recorder
+    std::map<std::uint32_t, std::string> names;  //!< the names of the TTs by instance id
+    /// the thread indices and the events they kept, oldest first
+    std::vector<std::pair<std::uint32_t, std::vector<FlightEvent>>> threads;
+
+    /// reads a dump written by FlightRecorder::dump on a machine with the same byte order
+    /// @throw std::runtime_error if @p is does not hold a dump
+    static FlightRecord read(std::istream &is) {
+      const auto get = [&is](auto &value) {
+        if (!is.read(reinterpret_cast<char *>(&value), sizeof(value)))
+          throw std::runtime_error("ttg::FlightRecord::read: truncated dump");
+      };
+      const auto get_string = [&](std::string &str) {
+        std::uint32_t n;
+        get(n);
+        str.resize(n);
+        if (n > 0 && !is.read(&str[0], n)) throw std::runtime_error("ttg::FlightRecord::read: truncated dump");
+      };
+      char magic[sizeof(FlightRecorder::magic)];
+      get(magic);
+      if (!std::equal(std::begin(magic), std::end(magic), std::begin(FlightRecorder::magic)))
+        throw std::runtime_error("ttg::FlightRecord::read: not a flight recorder dump");
+      FlightRecord result;
+      std::int32_t rank;
+      get(rank);
+      result.rank = rank;
+      get(result.origin);
+      get(result.time);
+      get_string(result.reason);
+      std::uint32_t nnames;
+      get(nnames);
+      for (std::uint32_t k = 0; k < nnames; ++k) {
+        std::uint32_t tt;
+        get(tt);
+        get_string(result.names[tt]);
+      }
+      std::uint32_t nthreads;
+      get(nthreads);
+      for (std::uint32_t k = 0; k < nthreads; ++k) {
+        std::uint32_t thread;
+        std::uint64_t nevents;
+        get(thread);
+        get(nevents);
+        std::vector<FlightEvent> events(nevents);
+        if (nevents > 0 && !is.read(reinterpret_cast<char *>(events.data()), nevents * sizeof(FlightEvent)))
+          throw std::runtime_error("ttg::FlightRecord::read: truncated dump");
+        result.threads.emplace_back(thread, std::move(events));
+      }
+      return result;
+    }
+
+    /// prints the last event of each thread, then the events of all threads by time
+    void print(std::ostream &os) const {
+      const auto describe = [this, &os](std::uint32_t thread, const FlightEvent &e) {
+        os << "+" << std::fixed << std::setprecision(3) << (e.time / 1e3) << " us thread " << thread << " "
+           << FlightEvent::name(e.kind);
+        if (e.tt != FlightEvent::none) {
+          const auto it = names.find(e.tt);
+          os << " " << (it != names.end() ? it->second : "TT") << " #" << std::hex << e.key_hash << std::dec;
+        }
+        if (e.kind == FlightEvent::input_arrived || e.kind == FlightEvent::message_sent ||
+            e.kind == FlightEvent::message_received)
+          os << " input " << e.input;
+        if (e.kind == FlightEvent::message_sent) os << " to " << e.peer;
+        if (e.kind == FlightEvent::message_sent || e.kind == FlightEvent::message_received)
+          os << " bytes " << e.bytes;
+        os << "\n";
+      };
+      os << "# rank " << rank << ", dumped at +" << std::fixed << std::setprecision(3) << (time / 1e3)
+         << " us because of: " << reason << "\n# last events\n";
+      std::vector<std::tuple<std::uint64_t, std::uint32_t, const FlightEvent *>> events;
+      for (const auto &[thread, thread_events] : threads) {
+        if (!thread_events.empty()) describe(thread, thread_events.back());
+        for (const auto &e : thread_events) events.emplace_back(e.time, thread, &e);
+      }
+      std::stable_sort(events.begin(), events.end(),
+                       [](const auto &a, const auto &b) { return std::get<0>(a) < std::get<0>(b); });
+      os << "# events\n";
+      for (const auto &[time, thread, e] : events) describe(thread, *e);
+    }
+  };
+
+  namespace detail {
+
+    /// the flight recorder installed by install_default_flight_recorder(), read by the signal handler
+    inline std::atomic<FlightRecorder *> default_flight_recorder_ptr = nullptr;
+
+    inline std::shared_ptr<FlightRecorder> &default_flight_recorder() {
+      static std::shared_ptr<FlightRecorder> recorder;
+      return recorder;
+    }
+
+    /// dumps the default flight recorder, if any; async-signal-safe
+    inline void dump_default_flight_recorder(const char *reason) {
+      if (auto *recorder = default_flight_recorder_ptr.load(std::memory_order_acquire)) recorder->dump(reason);
+    }
+
+    inline void flight_recorder_signal_handler(int) { dump_default_flight_recorder("SIGUSR1"); }
+
+    /// Makes @p recorder the default flight recorder, which observes the tasks, is dumped by the debugger hooks (see
+    /// ttg::Debugger), by SIGUSR1 if its handler is the default one, and when a fence stalls for
+    /// ttg::detail::flight_recorder_stall_timeout() seconds, unless 0
+    inline void install_default_flight_recorder(std::shared_ptr<FlightRecorder> recorder) {
+      default_flight_recorder() = recorder;
+      default_flight_recorder_ptr.store(recorder.get(), std::memory_order_release);
+      add_task_observer(recorder);
+      add_debugger_hook(&dump_default_flight_recorder);
+#ifdef SIGUSR1
+      struct sigaction action;
+      if (sigaction(SIGUSR1, nullptr, &action) == 0 && action.sa_handler == SIG_DFL) {
+        std::memset(&action, 0, sizeof(action));
+        action.sa_handler = &flight_recorder_signal_handler;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_RESTART;
+        sigaction(SIGUSR1, &action, nullptr);
+      }
+#endif
+      if (flight_recorder_stall_timeout() > 0)
+        recorder->watch_fences(std::chrono::seconds(flight_recorder_stall_timeout()));
+    }
+
+    /// undoes install_default_flight_recorder()
+    inline void uninstall_default_flight_recorder() {
+      auto &recorder = default_flight_recorder();
+      if (!recorder) return;
+#ifdef SIGUSR1
+      struct sigaction action;
+      if (sigaction(SIGUSR1, nullptr, &action) == 0 && action.sa_handler == &flight_recorder_signal_handler)
+        signal(SIGUSR1, SIG_DFL);
+#endif
+      remove_debugger_hook(&dump_default_flight_recorder);
+      default_flight_recorder_ptr.store(nullptr, std::memory_order_release);
+      recorder->stop_watching_fences();
+      remove_task_observer(recorder);
+      recorder.reset();
+    }
+
+  }  // namespace detail
+
+}  // namespace ttg
+
+#endif  // TTG_UTIL_FLIGHT_RECORDER_H
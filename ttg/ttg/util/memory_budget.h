@@ -0,0 +1,191 @@
+#ifndef TTG_UTIL_MEMORY_BUDGET_H
+#define TTG_UTIL_MEMORY_BUDGET_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "ttg/util/env.h"
+#include "ttg/util/meta.h"
+
+namespace ttg {
+
+  /// Estimates the number of bytes held by the values of type @p T stored as task inputs, for the memory budgets
+  /// (see TTBase::set_max_data_bytes). The default is @c sizeof(T), plus @c size()*sizeof(value_type) for the
+  /// contiguous containers, i.e. the types with @c data(), @c size() and @c value_type; specialize for other types
+  /// that own memory.
+  template <typename T, typename Enabler = void>
+  struct footprint_traits {
+    static std::size_t bytes(const T &) { return sizeof(T); }
+  };
+
+  template <typename T>
+  struct footprint_traits<T, meta::void_t<typename T::value_type, decltype(std::declval<const T &>().data()),
+                                          decltype(std::declval<const T &>().size())>> {
+    static std::size_t bytes(const T &value) {
+      return sizeof(T) + static_cast<std::size_t>(value.size()) * sizeof(typename T::value_type);
+    }
+  };
+
+  /// @return the estimated number of bytes held by @p value, see footprint_traits
+  template <typename T>
+  std::size_t footprint(const T &value) {
+    return footprint_traits<std::decay_t<T>>::bytes(value);
+  }
+
+  namespace detail {
+
+    /// Soft limits on the number of pending tasks (created and not yet completed) and on the number of bytes of
+    /// their inputs (see ttg::footprint), and the current usage; a limit of 0 means unlimited. Producers are deferred
+    /// by throttle() while a budget is exceeded. The usage is only charged while a limit is set, see budget_charge.
+    /// Thread safe.
+    class memory_budget {
+     public:
+      memory_budget() = default;
+      memory_budget(const memory_budget &) = delete;
+      memory_budget &operator=(const memory_budget &) = delete;
+
+      void set_max_pending_tasks(std::size_t n) { max_tasks.store(n, std::memory_order_relaxed); }
+      std::size_t get_max_pending_tasks() const { return max_tasks.load(std::memory_order_relaxed); }
+      void set_max_data_bytes(std::size_t n) { max_bytes.store(n, std::memory_order_relaxed); }
+      std::size_t get_max_data_bytes() const { return max_bytes.load(std::memory_order_relaxed); }
+
+      /// @return the number of pending tasks
+      std::size_t pending_tasks() const { return tasks.load(std::memory_order_relaxed); }
+      /// @return the number of bytes of the inputs of the pending tasks
+      std::size_t data_bytes() const { return bytes.load(std::memory_order_relaxed); }
+      /// @return the largest number of pending tasks so far
+      std::size_t peak_pending_tasks() const { return peak_tasks.load(std::memory_order_relaxed); }
+      /// @return the number of tasks completed so far
+      std::uint64_t completed_tasks() const { return completed.load(std::memory_order_acquire); }
+
+      /// @return true if a limit is set
+      bool limited() const { return get_max_pending_tasks() > 0 || get_max_data_bytes() > 0; }
+
+      /// @return true if a limit is set and exceeded
+      bool exceeded() const {
+        const auto mt = get_max_pending_tasks();
+        const auto mb = get_max_data_bytes();
+        return (mt > 0 && pending_tasks() >= mt) || (mb > 0 && data_bytes() >= mb);
+      }
+
+      /// @return true if exceeded() and enforced, i.e. the throttled producers did not stall since the last completion
+      bool blocks() const { return exceeded() && stall_mark.load(std::memory_order_relaxed) != completed_tasks() + 1; }
+
+      /// stops enforcing the limits until the next completion, called when the throttled producers stall
+      void mark_stalled() { stall_mark.store(completed_tasks() + 1, std::memory_order_relaxed); }
+
+      void add_task() {
+        const auto n = tasks.fetch_add(1, std::memory_order_relaxed) + 1;
+        auto peak = peak_tasks.load(std::memory_order_relaxed);
+        while (n > peak && !peak_tasks.compare_exchange_weak(peak, n, std::memory_order_relaxed)) {
+        }
+      }
+      void add_bytes(std::size_t n) { bytes.fetch_add(n, std::memory_order_relaxed); }
+
+      /// releases a completed task holding @p nbytes bytes of inputs
+      void release_task(std::size_t nbytes) {
+        bytes.fetch_sub(nbytes, std::memory_order_relaxed);
+        tasks.fetch_sub(1, std::memory_order_relaxed);
+        completed.fetch_add(1, std::memory_order_release);
+      }
+
+     private:
+      std::atomic<std::size_t> max_tasks = 0;
+      std::atomic<std::size_t> max_bytes = 0;
+      std::atomic<std::size_t> tasks = 0;
+      std::atomic<std::size_t> peak_tasks = 0;
+      std::atomic<std::size_t> bytes = 0;
+      std::atomic<std::uint64_t> completed = 0;
+      std::atomic<std::uint64_t> stall_mark = 0;  //!< completed_tasks()+1 when the producers stalled, 0 if never
+    };
+
+    /// The usage of a pending task charged to the budgets of its TT and of its world; released explicitly by
+    /// release(), when the task completes, or by the destructor. Each budget is only charged if it has a limit when
+    /// the task is created, so that the tasks of the TTs without limits do not update shared atomics; their counts
+    /// are kept by ttg::detail::tt_counter_slots. The inputs of a task may be charged concurrently by several
+    /// threads. Move only.
+    class budget_charge {
+     public:
+      budget_charge() = default;
+      budget_charge(memory_budget *tt_budget, memory_budget *world_budget)
+          : tt(tt_budget->limited() ? tt_budget : nullptr), world(world_budget->limited() ? world_budget : nullptr) {
+        if (tt) tt->add_task();
+        if (world) world->add_task();
+      }
+      budget_charge(budget_charge &&other)
+          : tt(std::exchange(other.tt, nullptr))
+          , world(std::exchange(other.world, nullptr))
+          , nbytes(other.nbytes.exchange(0, std::memory_order_relaxed)) {}
+      budget_charge &operator=(budget_charge &&other) {
+        if (this != &other) {
+          release();
+          tt = std::exchange(other.tt, nullptr);
+          world = std::exchange(other.world, nullptr);
+          nbytes.store(other.nbytes.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        return *this;
+      }
+      ~budget_charge() { release(); }
+
+      /// charges @p n more bytes of inputs
+      void add_bytes(std::size_t n) {
+        if (nullptr == tt && nullptr == world) return;
+        nbytes.fetch_add(n, std::memory_order_relaxed);
+        if (tt) tt->add_bytes(n);
+        if (world) world->add_bytes(n);
+      }
+
+      /// releases the charge, if any
+      void release() {
+        if (nullptr == tt && nullptr == world) return;
+        const auto n = nbytes.exchange(0, std::memory_order_relaxed);
+        if (tt) tt->release_task(n);
+        if (world) world->release_task(n);
+        tt = world = nullptr;
+      }
+
+     private:
+      memory_budget *tt = nullptr;
+      memory_budget *world = nullptr;
+      std::atomic<std::size_t> nbytes = 0;
+    };
+
+    /// Defers the calling producer, by putting its thread to sleep with an exponential backoff, while @p tt_budget or
+    /// @p world_budget blocks. The budgets are soft: if no task completes for ttg::detail::budget_stall_timeout()
+    /// (e.g. because the pending tasks await the inputs of the producer, or the runtime does not execute tasks yet)
+    /// the blocking budgets are marked as stalled and the producer proceeds.
+    inline void throttle(memory_budget &tt_budget, memory_budget &world_budget) {
+      if (!tt_budget.blocks() && !world_budget.blocks()) return;
+      constexpr std::chrono::microseconds max_backoff{1000};
+      const auto timeout = std::chrono::microseconds(budget_stall_timeout());
+      auto last_completed = tt_budget.completed_tasks() + world_budget.completed_tasks();
+      auto last_progress = std::chrono::steady_clock::now();
+      auto backoff = std::chrono::microseconds(1);
+      while (tt_budget.blocks() || world_budget.blocks()) {
+        std::this_thread::sleep_for(backoff);
+        const auto completed = tt_budget.completed_tasks() + world_budget.completed_tasks();
+        const auto now = std::chrono::steady_clock::now();
+        if (completed != last_completed) {
+          last_completed = completed;
+          last_progress = now;
+          backoff = std::chrono::microseconds(1);
+        } else if (now - last_progress >= timeout) {
+          if (tt_budget.blocks()) tt_budget.mark_stalled();
+          if (world_budget.blocks()) world_budget.mark_stalled();
+          return;
+        } else {
+          backoff = std::min(backoff * 2, max_backoff);
+        }
+      }
+    }
+
+  }  // namespace detail
+}  // namespace ttg
+
+#endif  // TTG_UTIL_MEMORY_BUDGET_H
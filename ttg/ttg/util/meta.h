@@ -23,6 +23,13 @@ namespace ttg {
     template <typename T>
     using remove_cvr_t = std::remove_cv_t<std::remove_reference_t<T>>;
 
+    /// @return an address that identifies type @c T, e.g. to check the type of a type-erased pointer
+    template <typename T>
+    const void *type_id() {
+      static const char id = 0;
+      return &id;
+    }
+
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     // (meta)tuple/typelist/typepack manipulations
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
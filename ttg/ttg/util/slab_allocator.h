@@ -0,0 +1,296 @@
+#ifndef TTG_UTIL_SLAB_ALLOCATOR_H
+#define TTG_UTIL_SLAB_ALLOCATOR_H
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <vector>
+
+namespace ttg {
+  namespace detail {
+
+    /// Statistics of a slab pool, see slab_pool::stats()
+    struct slab_stats {
+      std::size_t size_class = 0;    //!< the size of the blocks served by the pool, in bytes
+      std::size_t allocs = 0;        //!< the number of allocated blocks
+      std::size_t frees = 0;         //!< the number of blocks freed by the thread that allocated them
+      std::size_t remote_frees = 0;  //!< the number of blocks freed by another thread
+      std::size_t slabs = 0;         //!< the number of slabs obtained from the system allocator
+      std::size_t reserved = 0;      //!< the number of bytes obtained from the system allocator
+      std::size_t threads = 0;       //!< the number of thread caches
+
+      /// @return the number of blocks currently in use
+      std::size_t in_use() const { return allocs - frees - remote_frees; }
+    };
+
+    /// Base of all slab pools, allows to enumerate the pools to collect their statistics
+    class slab_pool_base {
+     public:
+      virtual ~slab_pool_base() = default;
+      virtual slab_stats stats() const = 0;
+    };
+
+    /// The registry of all slab pools instantiated by the program
+    class slab_registry {
+     public:
+      static slab_registry &instance() {
+        static slab_registry *registry = new slab_registry;  // intentionally leaked, pools outlive static objects
+        return *registry;
+      }
+
+      void add(const slab_pool_base *pool) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pools.push_back(pool);
+      }
+
+      /// @return the statistics of all pools, ordered by the time of their creation
+      std::vector<slab_stats> stats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<slab_stats> result;
+        result.reserve(m_pools.size());
+        for (auto pool : m_pools) result.push_back(pool->stats());
+        return result;
+      }
+
+     private:
+      mutable std::mutex m_mutex;
+      std::vector<const slab_pool_base *> m_pools;
+    };
+
+    /// @return the size class serving objects of @p size bytes: multiples of 16 up to 256 bytes, multiples of 64
+    ///         up to 1024 bytes, powers of 2 beyond
+    constexpr std::size_t slab_size_class(std::size_t size) {
+      if (size <= 256) return (size + 15) & ~std::size_t(15);
+      if (size <= 1024) return (size + 63) & ~std::size_t(63);
+      std::size_t result = 2048;
+      while (result < size) result <<= 1;
+      return result;
+    }
+
+    /// A pool of fixed-size blocks with per-thread caches, used for objects that are created and destroyed at high
+    /// rate by the backends (data copies, task argument holders). Each thread allocates from its own free list,
+    /// refilled from slabs of blocks obtained from the system allocator, without synchronization. A block freed by
+    /// a thread other than the one that allocated it is pushed onto a lock-free stack of the owning cache, which
+    /// the owner takes over in bulk once its own free list is exhausted. The cache of an exiting thread is handed
+    /// to the next thread that uses the pool. Slabs are retained for the lifetime of the program.
+    /// @tparam Size the size of the blocks, see slab_size_class()
+    template <std::size_t Size>
+    class slab_pool : public slab_pool_base {
+      static_assert(Size > 0 && Size % alignof(std::max_align_t) == 0,
+                    "slab_pool: Size must be a multiple of alignof(std::max_align_t)");
+
+     public:
+      static constexpr std::size_t alignment = alignof(std::max_align_t);
+      static constexpr std::size_t slab_bytes = 64 * 1024;
+
+      static slab_pool &instance() {
+        static slab_pool *pool = [] {
+          auto p = new slab_pool;  // intentionally leaked, blocks may be freed during static destruction
+          slab_registry::instance().add(p);
+          return p;
+        }();
+        return *pool;
+      }
+
+      /// @return a block of @c Size bytes aligned to @c alignment
+      void *allocate() {
+        cache *c = local_cache();
+        node *n = c->local;
+        if (nullptr == n) {
+          n = c->remote.exchange(nullptr, std::memory_order_acquire);
+          if (nullptr == n) n = grow(c);
+        }
+        c->local = n->next;
+        bump(c->allocs);
+        return n;
+      }
+
+      /// returns block @p ptr, obtained from allocate() by any thread, to the pool
+      void deallocate(void *ptr) {
+        node *n = static_cast<node *>(ptr);
+        cache *owner = header_of(n)->owner;
+        if (owner == tls_cache()) {
+          n->next = owner->local;
+          owner->local = n;
+          bump(owner->frees);
+        } else {
+          node *head = owner->remote.load(std::memory_order_relaxed);
+          do {
+            n->next = head;
+          } while (!owner->remote.compare_exchange_weak(head, n, std::memory_order_release, std::memory_order_relaxed));
+          owner->remote_frees.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+
+      slab_stats stats() const override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        slab_stats result;
+        result.size_class = Size;
+        result.threads = m_caches.size();
+        for (auto c : m_caches) {
+          result.allocs += c->allocs.load(std::memory_order_relaxed);
+          result.frees += c->frees.load(std::memory_order_relaxed);
+          result.remote_frees += c->remote_frees.load(std::memory_order_relaxed);
+          result.slabs += c->slabs.load(std::memory_order_relaxed);
+        }
+        result.reserved = result.slabs * blocks_per_slab * stride;
+        return result;
+      }
+
+     private:
+      struct node {
+        node *next;
+      };
+      struct cache;
+      /// precedes every block, identifies the cache the block belongs to
+      struct alignas(alignment) header {
+        cache *owner;
+      };
+      struct alignas(64) cache {
+        node *local = nullptr;                // accessed by the owning thread only
+        std::atomic<node *> remote = nullptr;  // blocks freed by other threads
+        std::atomic<std::size_t> allocs = 0;
+        std::atomic<std::size_t> frees = 0;
+        std::atomic<std::size_t> remote_frees = 0;
+        std::atomic<std::size_t> slabs = 0;
+      };
+
+      static constexpr std::size_t stride = sizeof(header) + Size;
+      static constexpr std::size_t blocks_per_slab = stride < slab_bytes ? slab_bytes / stride : 1;
+
+      /// the thread-local handle of a cache, returns the cache to the pool when the thread exits
+      struct cache_handle {
+        cache *c = nullptr;
+        ~cache_handle() {
+          if (nullptr != c) {
+            tls_cache() = nullptr;
+            instance().abandon(c);
+          }
+        }
+      };
+
+      slab_pool() = default;
+
+      static header *header_of(node *n) { return reinterpret_cast<header *>(reinterpret_cast<char *>(n) - sizeof(header)); }
+
+      /// counters are only modified by the owning thread, no read-modify-write needed
+      static void bump(std::atomic<std::size_t> &counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      }
+
+      static cache *&tls_cache() {
+        static thread_local cache *c = nullptr;
+        return c;
+      }
+
+      cache *local_cache() {
+        cache *&c = tls_cache();
+        if (nullptr == c) {
+          static thread_local cache_handle handle;
+          c = adopt();
+          handle.c = c;
+        }
+        return c;
+      }
+
+      cache *adopt() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_abandoned.empty()) {
+          cache *c = m_abandoned.back();
+          m_abandoned.pop_back();
+          return c;
+        }
+        cache *c = new cache;
+        m_caches.push_back(c);
+        return c;
+      }
+
+      void abandon(cache *c) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_abandoned.push_back(c);
+      }
+
+      /// carves a new slab into blocks owned by @p c
+      /// @return the head of the list of new blocks
+      node *grow(cache *c) {
+        char *slab = static_cast<char *>(::operator new(blocks_per_slab * stride));
+        node *head = nullptr;
+        for (std::size_t b = blocks_per_slab; b > 0; --b) {
+          char *block = slab + (b - 1) * stride;
+          reinterpret_cast<header *>(block)->owner = c;
+          node *n = reinterpret_cast<node *>(block + sizeof(header));
+          n->next = head;
+          head = n;
+        }
+        bump(c->slabs);
+        return head;
+      }
+
+      mutable std::mutex m_mutex;
+      std::vector<cache *> m_caches;     // all caches ever created
+      std::vector<cache *> m_abandoned;  // caches of exited threads
+    };
+
+    /// Mixin providing class-specific operator new/delete backed by the slab_pool of the matching size class.
+    /// Allocations of a different size, e.g. by a derived class, of objects exceeding 16 kB or of over-aligned objects
+    /// (which the pools do not support) fall back to the global operators, aligned as required. Define @c TTG_DISABLE_SLAB_ALLOCATOR to always use the global operators, e.g. to debug
+    /// memory errors with external tools.
+    /// @tparam Derived the class that inherits from this mixin
+    template <typename Derived>
+    struct slab_allocated {
+      static void *operator new(std::size_t size) {
+#if !defined(TTG_DISABLE_SLAB_ALLOCATOR)
+        if constexpr (use_pool()) {
+          if (size == sizeof(Derived)) return slab_pool<slab_size_class(sizeof(Derived))>::instance().allocate();
+        }
+#endif
+        return ::operator new(size);
+      }
+
+      static void operator delete(void *ptr, std::size_t size) {
+        if (nullptr == ptr) return;
+#if !defined(TTG_DISABLE_SLAB_ALLOCATOR)
+        if constexpr (use_pool()) {
+          if (size == sizeof(Derived)) {
+            slab_pool<slab_size_class(sizeof(Derived))>::instance().deallocate(ptr);
+            return;
+          }
+        }
+#endif
+        ::operator delete(ptr);
+      }
+
+      /// the overloads selected by new-expressions for over-aligned types, which the class-specific operators above
+      /// would otherwise hide from the aligned global operators
+      static void *operator new(std::size_t size, std::align_val_t align) { return ::operator new(size, align); }
+
+      static void operator delete(void *ptr, std::size_t size, std::align_val_t align) {
+        ::operator delete(ptr, size, align);
+      }
+
+     private:
+      /// evaluated lazily, Derived is incomplete when this mixin is instantiated
+      static constexpr bool use_pool() {
+        return alignof(Derived) <= alignof(std::max_align_t) && slab_size_class(sizeof(Derived)) <= 16 * 1024;
+      }
+    };
+
+    /// @return the statistics of all slab pools used by the program
+    inline std::vector<slab_stats> slab_pools_stats() { return slab_registry::instance().stats(); }
+
+    /// prints the statistics of all slab pools used by the program to @p os
+    inline void print_slab_pools_stats(std::ostream &os) {
+      for (const auto &s : slab_pools_stats()) {
+        os << "slab pool " << s.size_class << "B: allocs=" << s.allocs << " frees=" << s.frees
+           << " remote_frees=" << s.remote_frees << " in_use=" << s.in_use() << " slabs=" << s.slabs
+           << " reserved=" << s.reserved << "B threads=" << s.threads << std::endl;
+      }
+    }
+
+  }  // namespace detail
+}  // namespace ttg
+
+#endif  // TTG_UTIL_SLAB_ALLOCATOR_H
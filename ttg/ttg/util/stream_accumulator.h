@@ -0,0 +1,188 @@
+#ifndef TTG_UTIL_STREAM_ACCUMULATOR_H
+#define TTG_UTIL_STREAM_ACCUMULATOR_H
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "ttg/execution.h"
+#include "ttg/util/thread_index.h"
+
+namespace ttg {
+  namespace detail {
+
+    /// @return true if the values of type @p T can be reduced in ttg::ReduceMode::Atomic
+    template <typename T>
+    constexpr bool is_atomic_reducible_v = std::is_arithmetic_v<T>;
+
+    /// Accumulates the values received by a streaming input terminal of one task without serializing the
+    /// contributors on the lock of the task (see ttg::ReduceMode::Atomic and ttg::ReduceMode::PerThread).
+    /// The backend registers each contribution with begin() while holding the lock of the task, then reduces the
+    /// value with reduce() and calls end() after releasing it. The stream is marked complete, once, with complete().
+    /// Exactly one of the calls to end() and complete() returns true, once all contributions have been reduced and the
+    /// stream is complete; its caller obtains the reduced value with take() and makes the input available to the task.
+    /// In ttg::ReduceMode::PerThread the accumulator holds a pointer per slot and allocates the (cache-line-aligned)
+    /// partial result of a slot on the first contribution reduced into it, i.e. a key reduced by a single thread
+    /// costs one pointer per slot plus one slot.
+    /// @tparam T the (decayed) type of the values
+    template <typename T>
+    class stream_accumulator {
+     public:
+      /// the number of partial results of ttg::ReduceMode::PerThread
+      static std::size_t default_num_slots() {
+        static const std::size_t n = std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, 64);
+        return n;
+      }
+
+      /// @param mode ttg::ReduceMode::Atomic (only if @c is_atomic_reducible_v<T>) or ttg::ReduceMode::PerThread
+      /// @param num_slots the number of partial results of ttg::ReduceMode::PerThread
+      explicit stream_accumulator(ReduceMode mode, std::size_t num_slots = default_num_slots()) : m_mode(mode) {
+        assert(mode != ReduceMode::Locked);
+        assert(mode != ReduceMode::Atomic || is_atomic_reducible_v<T>);
+        if (mode == ReduceMode::PerThread) {
+          m_num_slots = std::max<std::size_t>(num_slots, 1);
+          m_slots.reset(new std::atomic<slot *>[m_num_slots]);
+          for (std::size_t idx = 0; idx < m_num_slots; ++idx) m_slots[idx].store(nullptr, std::memory_order_relaxed);
+        }
+      }
+
+      ~stream_accumulator() {
+        for (std::size_t idx = 0; idx < m_num_slots; ++idx) delete m_slots[idx].load(std::memory_order_relaxed);
+      }
+
+      stream_accumulator(const stream_accumulator &) = delete;
+      stream_accumulator &operator=(const stream_accumulator &) = delete;
+
+      /// registers a contribution, must be called before the stream is complete
+      void begin() { m_holds.fetch_add(1, std::memory_order_relaxed); }
+
+      /// reduces @p value into the partial result of the calling thread, or into the atomic result; the first value
+      /// of each partial result is moved into it
+      /// @param reducer callable as @c reducer(T&,const T&), aggregates its second argument into the first
+      template <typename Value, typename Reducer>
+      void reduce(Value &&value, const Reducer &reducer) {
+        if constexpr (is_atomic_reducible_v<T>) {
+          if (m_mode == ReduceMode::Atomic) {
+            reduce_atomic(static_cast<T>(value), reducer);
+            return;
+          }
+        }
+        slot &s = get_slot(this_thread_index() % m_num_slots);
+        while (s.lock.test_and_set(std::memory_order_acquire)) std::this_thread::yield();
+        if (s.value)
+          reducer(*s.value, value);
+        else
+          s.value.emplace(std::forward<Value>(value));
+        s.lock.clear(std::memory_order_release);
+      }
+
+      /// completes a contribution registered with begin()
+      /// @return true if the stream is complete and this was the last contribution in flight
+      bool end() { return m_holds.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+
+      /// marks the stream complete
+      /// @return true if no contributions are in flight
+      bool complete() { return m_holds.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+
+      /// @return true if any value was received
+      bool has_value() const {
+        if constexpr (is_atomic_reducible_v<T>) {
+          if (m_mode == ReduceMode::Atomic) return m_state.load(std::memory_order_relaxed) == ready;
+        }
+        for (std::size_t idx = 0; idx < m_num_slots; ++idx) {
+          const slot *s = m_slots[idx].load(std::memory_order_acquire);
+          if (s && s->value) return true;
+        }
+        return false;
+      }
+
+      /// combines the partial results, to be called once the stream is complete and has_value() is true
+      /// @return the reduced value
+      template <typename Reducer>
+      T take(const Reducer &reducer) {
+        assert(has_value());
+        if constexpr (is_atomic_reducible_v<T>) {
+          if (m_mode == ReduceMode::Atomic) return m_value.load(std::memory_order_relaxed);
+        }
+        std::optional<T> result;
+        for (std::size_t idx = 0; idx < m_num_slots; ++idx) {
+          slot *s = m_slots[idx].load(std::memory_order_acquire);
+          if (!s || !s->value) continue;
+          auto &partial = s->value;
+          if (result)
+            reducer(*result, *partial);
+          else
+            result.emplace(std::move(*partial));
+          partial.reset();
+        }
+        return std::move(*result);
+      }
+
+     private:
+      struct alignas(64) slot {
+        std::atomic_flag lock = ATOMIC_FLAG_INIT;
+        std::optional<T> value;
+      };
+
+      /// @return the slot @p idx, allocated by the first thread to use it
+      slot &get_slot(std::size_t idx) {
+        slot *s = m_slots[idx].load(std::memory_order_acquire);
+        if (s) return *s;
+        std::unique_ptr<slot> fresh(new slot);
+        if (m_slots[idx].compare_exchange_strong(s, fresh.get(), std::memory_order_acq_rel)) return *fresh.release();
+        return *s;
+      }
+
+      /// states of the atomic result
+      static constexpr int empty = 0;
+      static constexpr int initializing = 1;
+      static constexpr int ready = 2;
+
+      template <typename Reducer>
+      void reduce_atomic(T value, const Reducer &reducer) {
+        int state = m_state.load(std::memory_order_acquire);
+        if (state == empty && m_state.compare_exchange_strong(state, initializing, std::memory_order_acquire)) {
+          m_value.store(value, std::memory_order_relaxed);
+          m_state.store(ready, std::memory_order_release);
+          return;
+        }
+        while (m_state.load(std::memory_order_acquire) != ready) std::this_thread::yield();
+        T expected = m_value.load(std::memory_order_relaxed);
+        T desired;
+        do {
+          desired = expected;
+          reducer(desired, value);
+        } while (!m_value.compare_exchange_weak(expected, desired, std::memory_order_relaxed));
+      }
+
+      ReduceMode m_mode;
+      std::atomic<std::int64_t> m_holds = 1;  // contributions in flight + 1 until the stream is complete
+      std::atomic<int> m_state = empty;
+      std::atomic<std::conditional_t<is_atomic_reducible_v<T>, T, int>> m_value{};
+      std::unique_ptr<std::atomic<slot *>[]> m_slots;  // allocated lazily, see get_slot()
+      std::size_t m_num_slots = 0;
+    };
+
+    /// maps a tuple of input value types to a tuple of owning pointers to their stream_accumulator objects,
+    /// null unless the input is being reduced by an accumulator
+    template <typename Tuple>
+    struct stream_accumulators;
+    template <typename... Ts>
+    struct stream_accumulators<std::tuple<Ts...>> {
+      using type = std::tuple<std::unique_ptr<stream_accumulator<std::decay_t<Ts>>>...>;
+    };
+    template <typename Tuple>
+    using stream_accumulators_t = typename stream_accumulators<Tuple>::type;
+
+  }  // namespace detail
+}  // namespace ttg
+
+#endif  // TTG_UTIL_STREAM_ACCUMULATOR_H
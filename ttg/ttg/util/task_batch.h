@@ -0,0 +1,88 @@
+#ifndef TTG_UTIL_TASK_BATCH_H
+#define TTG_UTIL_TASK_BATCH_H
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ttg/util/meta.h"
+
+namespace ttg {
+  namespace detail {
+
+    template <typename T>
+    using have_batch_op_non_type_t = decltype(T::have_batch_op);
+
+    /// @return true if @p derivedT::have_batch_op exists and is defined to true, i.e. the ready tasks of the TT are
+    ///         executed in batches by @c derivedT::op_batch instead of one by one by @c derivedT::op
+    template <typename derivedT>
+    constexpr bool derived_has_batch_op() {
+      if constexpr (meta::is_detected_v<have_batch_op_non_type_t, derivedT>) {
+        return derivedT::have_batch_op;
+      } else {
+        return false;
+      }
+    }
+
+    /// The ready tasks of a TT executed in batches (see derived_has_batch_op). Only one task of the queue, its leader,
+    /// is handed to the scheduler at any time: the leader is the task at the front of the queue, and when it is
+    /// executed it takes a batch of tasks, including itself, off the front of the queue and appoints the next leader.
+    /// @tparam TaskT the type of the tasks of the backend
+    template <typename TaskT>
+    class ready_batch_queue {
+     public:
+      ready_batch_queue() = default;
+      ready_batch_queue(const ready_batch_queue &) = delete;
+      ready_batch_queue &operator=(const ready_batch_queue &) = delete;
+
+      /// enqueues a ready task
+      /// @return true if @p task is the new leader, to be handed to the scheduler by the caller
+      bool push(TaskT *task) {
+        std::lock_guard<std::mutex> lock(mtx);
+        tasks.push_back(task);
+        if (have_leader) return false;
+        have_leader = true;
+        return true;
+      }
+
+      /// called by the leader when it is executed, moves the tasks of its batch to @p batch, the leader first
+      /// @param max_size the maximum number of tasks in the batch
+      /// @param linger how long the leader waits for the batch to fill before taking the tasks that are ready
+      /// @return the next leader, to be handed to the scheduler by the caller, or null if the queue is empty
+      TaskT *pop(std::vector<TaskT *> &batch, std::size_t max_size, std::chrono::microseconds linger) {
+        assert(max_size > 0);
+        std::unique_lock<std::mutex> lock(mtx);
+        assert(have_leader && !tasks.empty());
+        if (linger.count() > 0 && tasks.size() < max_size) {
+          const auto deadline = std::chrono::steady_clock::now() + linger;
+          do {
+            lock.unlock();
+            std::this_thread::yield();
+            lock.lock();
+          } while (tasks.size() < max_size && std::chrono::steady_clock::now() < deadline);
+        }
+        const auto size = std::min(max_size, tasks.size());
+        batch.insert(batch.end(), tasks.begin(), tasks.begin() + size);
+        tasks.erase(tasks.begin(), tasks.begin() + size);
+        if (tasks.empty()) {
+          have_leader = false;
+          return nullptr;
+        }
+        return tasks.front();
+      }
+
+     private:
+      std::mutex mtx;
+      std::deque<TaskT *> tasks;
+      bool have_leader = false;  //!< true if the front of tasks is scheduled
+    };
+
+  }  // namespace detail
+}  // namespace ttg
+
+#endif  // TTG_UTIL_TASK_BATCH_H
@@ -0,0 +1,20 @@
+#ifndef TTG_UTIL_THREAD_INDEX_H
+#define TTG_UTIL_THREAD_INDEX_H
+
+#include <atomic>
+#include <cstddef>
+
+namespace ttg {
+  namespace detail {
+
+    /// @return a small integer identifying the calling thread, threads are numbered in the order of their first call
+    inline std::size_t this_thread_index() {
+      static std::atomic<std::size_t> next_index = 0;
+      static thread_local const std::size_t index = next_index.fetch_add(1, std::memory_order_relaxed);
+      return index;
+    }
+
+  }  // namespace detail
+}  // namespace ttg
+
+#endif  // TTG_UTIL_THREAD_INDEX_H
@@ -0,0 +1,489 @@
+#ifndef TTG_UTIL_TIMELINE_H
+#define TTG_UTIL_TIMELINE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ttg/base/observer.h"
+#include "ttg/base/tt.h"
+#include "ttg/util/counters.h"
+#include "ttg/util/print.h"
+#include "ttg/util/thread_index.h"
+
+namespace ttg {
+
+  /// The formats of Timeline::write()
+  enum class TimelineFormat {
+    Chrome,   // the JSON trace event format of chrome://tracing, also read by https://ui.perfetto.dev
+    Perfetto  // the protobuf trace format of Perfetto
+  };
+
+  namespace detail {
+
+    /// appends to @p out the fields of a protobuf message, see https://protobuf.dev/programming-guides/encoding
+    struct protobuf_writer {
+      std::string &out;
+
+      void varint(std::uint64_t value) {
+        while (value >= 0x80) {
+          out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+          value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+      }
+      void tag(int field, int wire_type) { varint((static_cast<std::uint64_t>(field) << 3) | wire_type); }
+      void uint(int field, std::uint64_t value) {
+        tag(field, 0);
+        varint(value);
+      }
+      void fixed64(int field, std::uint64_t value) {
+        tag(field, 1);
+        for (int b = 0; b < 8; ++b) out.push_back(static_cast<char>((value >> (8 * b)) & 0xff));
+      }
+      void bytes(int field, const std::string &value) {
+        tag(field, 2);
+        varint(value.size());
+        out.append(value);
+      }
+    };
+
+  }  // namespace detail
+
+  /// A task observer (see ttg::add_task_observer) that records, on this process, the execution of every task (its TT,
+  /// printed key and worker thread), the arrival of its inputs and the messages that carry them, and writes them as a
+  /// timeline viewable with chrome://tracing or https://ui.perfetto.dev. Each thread records its events in its own
+  /// buffer, without locking, up to a maximum number of events (about 100 bytes each) after which the events are
+  /// dropped and counted, see dropped(); the keys are printed when the timeline is written, unless they cannot be
+  /// copied (see ttg::TaskKey::copy). The messages are linked to their receiving end by flow events, identified by
+  /// the id of the message (see ttg::TaskObserver::message_sent). Setting the environment variable `TTG_TIMELINE` to
+  /// a file name records the timeline of the default world from ttg::initialize to ttg::finalize, see
+  /// ttg::detail::timeline_file_name() and ttg::detail::timeline_max_events(). The critical path and the parallelism
+  /// of the recorded execution are reported by bin/ttg_critical_path.py from the timelines in the Chrome format.
+  class Timeline : public TaskObserver {
+   public:
+    /// @param rank the rank of this process, the process of the events
+    /// @param max_threads the number of threads that can record events, the events of other threads are dropped
+    /// @param max_events the number of events each thread can record, its later events are dropped except the ends
+    ///        of its recorded tasks
+    explicit Timeline(int rank = 0, std::size_t max_threads = 1024, std::size_t max_events = 1 << 20)
+        : rank(rank)
+        , max_threads(max_threads)
+        , max_events(max_events)
+        , buffers(new std::atomic<thread_buffer *>[max_threads])
+        , steady_epoch(std::chrono::steady_clock::now())
+        , system_epoch(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::system_clock::now().time_since_epoch())
+                           .count()) {
+      for (std::size_t t = 0; t < max_threads; ++t) buffers[t].store(nullptr, std::memory_order_relaxed);
+    }
+
+    Timeline(const Timeline &) = delete;
+    Timeline &operator=(const Timeline &) = delete;
+
+    ~Timeline() {
+      for (std::size_t t = 0; t < max_threads; ++t) delete buffers[t].load(std::memory_order_acquire);
+    }
+
+    void task_started(const TTBase &tt, const TaskKey &key) override { record(event_kind::begin, tt, key, 0, -1, 0); }
+    void task_finished(const TTBase &tt, const TaskKey &key) override { record(event_kind::end, tt, key, 0, -1, 0); }
+    void input_arrived(const TTBase &tt, const TaskKey &key, std::size_t input) override {
+      record(event_kind::input, tt, key, input, -1, 0);
+    }
+    void message_sent(const TTBase &tt, const TaskKey &key, std::size_t input, int rank, std::size_t bytes,
+                      std::uint64_t message) override {
+      record(event_kind::send, tt, key, input, rank, bytes, message);
+    }
+    void message_received(const TTBase &tt, const TaskKey &key, std::size_t input, std::size_t bytes,
+                          std::uint64_t message) override {
+      record(event_kind::receive, tt, key, input, -1, bytes, message);
+    }
+
+    /// @return the number of recorded events
+    std::size_t size() const {
+      std::size_t result = 0;
+      for_each_event([&result](std::size_t, const event &) { ++result; });
+      return result;
+    }
+
+    /// @return the number of events dropped because they were recorded by more than max_threads threads, or by a
+    ///         thread that recorded max_events events; reported in the written timeline
+    std::size_t dropped() const { return ndropped.load(std::memory_order_relaxed); }
+
+    /// writes the recorded events to @p os in @p format; the events recorded concurrently may be left out
+    void write(std::ostream &os, TimelineFormat format = TimelineFormat::Chrome) const {
+      if (format == TimelineFormat::Chrome)
+        write_chrome(os);
+      else
+        write_perfetto(os);
+    }
+
+    /// writes the recorded events to the file @p path, in the Perfetto format if its extension is .pftrace and in
+    /// the Chrome format otherwise
+    void write(const std::string &path) const {
+      const std::string perfetto_ext = ".pftrace";
+      const bool perfetto = path.size() >= perfetto_ext.size() &&
+                            path.compare(path.size() - perfetto_ext.size(), perfetto_ext.size(), perfetto_ext) == 0;
+      std::ofstream file(path, std::ios::binary);
+      if (!file) {
+        ttg::print_error("ttg::Timeline::write: cannot open ", path);
+        throw std::runtime_error("ttg::Timeline::write: cannot open " + path);
+      }
+      write(file, perfetto ? TimelineFormat::Perfetto : TimelineFormat::Chrome);
+    }
+
+   private:
+    enum class event_kind : std::uint8_t { begin, end, input, send, receive };
+
+    struct event {
+      event_kind kind;
+      std::uint32_t input;
+      std::int32_t peer;   //!< the destination of a send
+      std::uint64_t time;  //!< in ns since the epoch of the system clock
+      std::uint64_t tt;    //!< the instance id of the TT
+      std::uint64_t key_hash;
+      std::uint64_t bytes;
+      std::uint64_t message;   //!< the id of the message of a send or receive
+      TaskKey::Copy key;       //!< the key of a begin event, printed by write() ...
+      std::string key_string;  //!< ... or, if it cannot be copied, printed when recorded
+    };
+
+    static constexpr std::size_t chunk_size = 1024;
+
+    struct chunk {
+      event events[chunk_size];
+      std::atomic<std::size_t> size = 0;
+      std::atomic<chunk *> next = nullptr;
+    };
+
+    /// the events recorded by one thread, appended by that thread only and readable concurrently
+    struct thread_buffer {
+      chunk head;
+      chunk *tail = &head;
+      std::size_t size = 0;         //!< the number of recorded events
+      std::vector<bool> open;       //!< for each task started but not finished, true if its begin was recorded
+      std::vector<bool> named_tts;  //!< the TTs whose names were registered by this thread
+
+      thread_buffer() = default;
+      thread_buffer(const thread_buffer &) = delete;
+      thread_buffer &operator=(const thread_buffer &) = delete;
+      ~thread_buffer() {
+        auto *c = head.next.load(std::memory_order_relaxed);
+        while (c) delete std::exchange(c, c->next.load(std::memory_order_relaxed));
+      }
+
+      template <typename Fill>
+      void append(Fill &&fill) {
+        auto n = tail->size.load(std::memory_order_relaxed);
+        if (n == chunk_size) {
+          auto *c = new chunk;
+          tail->next.store(c, std::memory_order_release);
+          tail = c;
+          n = 0;
+        }
+        fill(tail->events[n]);
+        tail->size.store(n + 1, std::memory_order_release);
+      }
+    };
+
+    /// @return the buffer of the calling thread, nullptr if it has none and max_threads threads have buffers
+    thread_buffer *this_thread_buffer() {
+      const auto t = detail::this_thread_index();
+      if (t >= max_threads) return nullptr;
+      auto *buffer = buffers[t].load(std::memory_order_relaxed);
+      if (nullptr == buffer) {  // only this thread installs its buffer
+        buffer = new thread_buffer;
+        buffers[t].store(buffer, std::memory_order_release);
+      }
+      return buffer;
+    }
+
+    std::uint64_t now() const {
+      return system_epoch + std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                                                                                 steady_epoch)
+                                .count();
+    }
+
+    void record(event_kind kind, const TTBase &tt, const TaskKey &key, std::size_t input, int peer,
+                std::size_t bytes, std::uint64_t message = 0) {
+      auto *buffer = this_thread_buffer();
+      bool keep = nullptr != buffer;
+      if (keep) {
+        // the end of a task is kept if its begin was, so that the tasks of the timeline are complete
+        keep = buffer->size < max_events;
+        if (kind == event_kind::begin) {
+          buffer->open.push_back(keep);
+        } else if (kind == event_kind::end && !buffer->open.empty()) {
+          keep = buffer->open.back();
+          buffer->open.pop_back();
+        }
+      }
+      if (!keep) {
+        ndropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      ++buffer->size;
+      const std::uint64_t id = tt.get_instance_id();
+      if (id >= buffer->named_tts.size()) buffer->named_tts.resize(id + 1);
+      if (!buffer->named_tts[id]) {
+        buffer->named_tts[id] = true;
+        std::lock_guard<std::mutex> lock(names_mtx);
+        names.emplace(id, tt.get_name());
+      }
+      const auto time = now();
+      buffer->append([&](event &e) {
+        e.kind = kind;
+        e.input = static_cast<std::uint32_t>(input);
+        e.peer = peer;
+        e.time = time;
+        e.tt = id;
+        e.key_hash = key.hash();
+        e.bytes = bytes;
+        e.message = message;
+        if (kind == event_kind::begin) {
+          e.key = key.copy();
+          if (!e.key.valid()) e.key_string = key.str();
+        }
+      });
+    }
+
+    /// invokes @p f with the thread and each recorded event, in the order of the threads and of the events
+    template <typename F>
+    void for_each_event(F &&f) const {
+      for (std::size_t t = 0; t < max_threads; ++t) {
+        const auto *buffer = buffers[t].load(std::memory_order_acquire);
+        if (nullptr == buffer) continue;
+        for (const chunk *c = &buffer->head; c != nullptr; c = c->next.load(std::memory_order_acquire)) {
+          const auto n = c->size.load(std::memory_order_acquire);
+          for (std::size_t k = 0; k < n; ++k) f(t, c->events[k]);
+        }
+      }
+    }
+
+
+    /// @return the printed key of begin event @p e
+    static std::string key_of(const event &e) {
+      if (!e.key.valid()) return e.key_string;
+      std::ostringstream oss;
+      e.key.print(oss);
+      return oss.str();
+    }
+
+    std::string name_of(std::uint64_t tt) const {
+      auto it = names.find(tt);
+      return it != names.end() ? it->second : std::string("TT");
+    }
+
+    void write_chrome(std::ostream &os) const {
+      std::lock_guard<std::mutex> lock(names_mtx);
+      const auto ts = [](std::uint64_t time) {  // in microseconds, as required by the format
+        std::string result = std::to_string(time / 1000) + ".000";
+        const auto ns = std::to_string(time % 1000);
+        result.replace(result.size() - ns.size(), ns.size(), ns);
+        return result;
+      };
+      os << "{\"displayTimeUnit\": \"ns\", \"otherData\": {\"dropped_events\": " << dropped()
+         << "}, \"traceEvents\": [\n";
+      os << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << rank << ", \"args\": {\"name\": \"rank "
+         << rank << "\"}}";
+      std::size_t last_thread = max_threads;
+      for_each_event([&](std::size_t t, const event &e) {
+        const auto where = ", \"pid\": " + std::to_string(rank) + ", \"tid\": " + std::to_string(t);
+        if (t != last_thread) {
+          os << ",\n{\"name\": \"thread_name\", \"ph\": \"M\"" << where << ", \"args\": {\"name\": \"thread " << t
+             << "\"}}";
+          last_thread = t;
+        }
+        // identifies the task, e.g. for bin/ttg_critical_path.py
+        const auto task = [&os, &e]() {
+          os << "\"tt\": " << e.tt << ", \"hash\": \"0x" << std::hex << e.key_hash << std::dec << "\"";
+        };
+        os << ",\n{\"ts\": " << ts(e.time) << where;
+        switch (e.kind) {
+          case event_kind::begin:
+            os << ", \"ph\": \"B\", \"cat\": \"task\", \"name\": ";
+            detail::write_json_string(os, name_of(e.tt));
+            os << ", \"args\": {\"key\": ";
+            detail::write_json_string(os, key_of(e));
+            os << ", ";
+            task();
+            os << "}}";
+            break;
+          case event_kind::end:
+            os << ", \"ph\": \"E\"}";
+            break;
+          case event_kind::input:
+            os << ", \"ph\": \"i\", \"s\": \"t\", \"cat\": \"input\", \"name\": ";
+            detail::write_json_string(os, "input " + name_of(e.tt) + "[" + std::to_string(e.input) + "]");
+            os << ", \"args\": {";
+            task();
+            os << ", \"input\": " << e.input << "}}";
+            break;
+          case event_kind::send:
+          case event_kind::receive: {
+            const bool send = e.kind == event_kind::send;
+            os << ", \"ph\": \"i\", \"s\": \"t\", \"cat\": \"message\", \"name\": ";
+            detail::write_json_string(os, (send ? "send " : "receive ") + name_of(e.tt) + "[" +
+                                              std::to_string(e.input) + "]");
+            os << ", \"args\": {";
+            task();
+            os << ", \"input\": " << e.input << ", ";
+            if (send) os << "\"to\": " << e.peer << ", ";
+            os << "\"bytes\": " << e.bytes << "}}";
+            // the flow starts in the sending task, and ends in the task executing after the receipt
+            os << ",\n{\"ts\": " << ts(e.time) << where << ", \"ph\": \"" << (send ? "s" : "f")
+               << "\", \"cat\": \"message\", \"name\": \"message\", \"id\": \"0x" << std::hex << e.message << std::dec
+               << "\"" << (send ? "" : ", \"bp\": \"e\"") << "}";
+            break;
+          }
+        }
+      });
+      os << "\n]}\n";
+    }
+
+    void write_perfetto(std::ostream &os) const {
+      std::lock_guard<std::mutex> lock(names_mtx);
+      // field numbers of perfetto/protos/perfetto/trace: Trace.packet = 1; TracePacket.timestamp = 8,
+      // .trusted_packet_sequence_id = 10, .track_event = 11, .track_descriptor = 60; TrackDescriptor.uuid = 1,
+      // .name = 2, .process = 3, .thread = 4; ProcessDescriptor.pid = 1, .process_name = 6; ThreadDescriptor.pid = 1,
+      // .tid = 2, .thread_name = 5; TrackEvent.debug_annotations = 4, .type = 9, .track_uuid = 11, .name = 23,
+      // .flow_ids = 47, .terminating_flow_ids = 48; DebugAnnotation.uint_value = 3, .string_value = 6, .name = 10
+      const std::uint64_t process_uuid = (static_cast<std::uint64_t>(rank) + 1) << 32;
+      const int pid = rank + 1;  // pid 0 is reserved
+      std::string packet, message, submessage;
+      const auto write_packet = [&os, &packet]() {
+        std::string header;
+        detail::protobuf_writer w{header};
+        w.tag(1, 2);
+        w.varint(packet.size());
+        os.write(header.data(), header.size());
+        os.write(packet.data(), packet.size());
+        packet.clear();
+      };
+      const auto annotation = [&submessage](detail::protobuf_writer &w, const std::string &name, auto value) {
+        submessage.clear();
+        detail::protobuf_writer a{submessage};
+        a.bytes(10, name);
+        if constexpr (std::is_same_v<decltype(value), std::string>)
+          a.bytes(6, value);
+        else
+          a.uint(3, value);
+        w.bytes(4, submessage);
+      };
+
+      {  // the process track
+        detail::protobuf_writer p{packet};
+        message.clear();
+        detail::protobuf_writer d{message};
+        d.uint(1, process_uuid);
+        submessage.clear();
+        detail::protobuf_writer pd{submessage};
+        pd.uint(1, pid);
+        const auto dropped_events = dropped();
+        pd.bytes(6, "rank " + std::to_string(rank) +
+                        (dropped_events ? " (" + std::to_string(dropped_events) + " events dropped)" : std::string()));
+        d.bytes(3, submessage);
+        p.bytes(60, message);
+        write_packet();
+      }
+      std::size_t last_thread = max_threads;
+      for_each_event([&](std::size_t t, const event &e) {
+        const std::uint64_t track_uuid = process_uuid + t + 1;
+        detail::protobuf_writer p{packet};
+        if (t != last_thread) {  // the thread track
+          message.clear();
+          detail::protobuf_writer d{message};
+          d.uint(1, track_uuid);
+          submessage.clear();
+          detail::protobuf_writer td{submessage};
+          td.uint(1, pid);
+          td.uint(2, t + 1);
+          td.bytes(5, "thread " + std::to_string(t));
+          d.bytes(4, submessage);
+          p.bytes(60, message);
+          write_packet();
+          last_thread = t;
+        }
+        p.uint(8, e.time);
+        p.uint(10, t + 1);  // a sequence per thread, with increasing timestamps
+        message.clear();
+        detail::protobuf_writer te{message};
+        te.uint(11, track_uuid);
+        switch (e.kind) {
+          case event_kind::begin:
+            te.uint(9, 1);  // TYPE_SLICE_BEGIN
+            te.bytes(23, name_of(e.tt));
+            annotation(te, "key", key_of(e));
+            annotation(te, "tt", e.tt);
+            annotation(te, "hash", e.key_hash);
+            break;
+          case event_kind::end:
+            te.uint(9, 2);  // TYPE_SLICE_END
+            break;
+          case event_kind::input:
+            te.uint(9, 3);  // TYPE_INSTANT
+            te.bytes(23, "input " + name_of(e.tt) + "[" + std::to_string(e.input) + "]");
+            annotation(te, "tt", e.tt);
+            annotation(te, "hash", e.key_hash);
+            break;
+          case event_kind::send:
+          case event_kind::receive: {
+            const bool send = e.kind == event_kind::send;
+            te.uint(9, 3);  // TYPE_INSTANT
+            te.bytes(23, (send ? "send " : "receive ") + name_of(e.tt) + "[" + std::to_string(e.input) + "]");
+            if (send) annotation(te, "to", static_cast<std::uint64_t>(e.peer));
+            annotation(te, "bytes", e.bytes);
+            te.fixed64(send ? 47 : 48, e.message);
+            break;
+          }
+        }
+        p.bytes(11, message);
+        write_packet();
+      });
+    }
+
+    int rank;
+    std::size_t max_threads;
+    std::size_t max_events;  //!< per thread
+    std::unique_ptr<std::atomic<thread_buffer *>[]> buffers;  //!< by thread index, see detail::this_thread_index
+    std::chrono::steady_clock::time_point steady_epoch;
+    std::uint64_t system_epoch;  //!< the time of steady_epoch, in ns since the epoch of the system clock
+    std::atomic<std::size_t> ndropped = 0;
+    mutable std::mutex names_mtx;
+    std::unordered_map<std::uint64_t, std::string> names;  //!< the names of the TTs by instance id
+  };
+
+  namespace detail {
+
+    /// @return the timeline recorded if the environment variable `TTG_TIMELINE` is set, see ttg::initialize
+    inline std::shared_ptr<Timeline> &default_timeline() {
+      static std::shared_ptr<Timeline> timeline;
+      return timeline;
+    }
+
+    /// @return the file the timeline of process @p rank is written to: @p path if there is a single process,
+    ///         otherwise @p path with the rank inserted before its extension, e.g. trace.1.json
+    inline std::string timeline_file_name(const std::string &path, int rank, int size) {
+      if (size == 1) return path;
+      const auto slash = path.find_last_of('/');
+      const auto dot = path.find_last_of('.');
+      const bool has_ext = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+      return has_ext ? path.substr(0, dot) + "." + std::to_string(rank) + path.substr(dot)
+                     : path + "." + std::to_string(rank);
+    }
+
+  }  // namespace detail
+
+}  // namespace ttg
+
+#endif  // TTG_UTIL_TIMELINE_H
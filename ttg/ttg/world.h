@@ -5,6 +5,9 @@
 
 #include <stdexcept>
 #include <algorithm>
+#include <functional>
+#include <future>
+#include <vector>
 
 #include "ttg/base/world.h"
 #include "ttg/base/keymap.h"
@@ -16,6 +19,53 @@ namespace ttg {
   /* Slim wrapper to allow for forward declaration */
   class World : public ttg::base::World<TTG_IMPL_NS::WorldImpl> {
     using ttg::base::World<TTG_IMPL_NS::WorldImpl>::World;
+
+   public:
+    /// @name Collective operations
+    /// Typed collectives over all processes of this World, defined in ttg/collectives.h.
+    /// Each must be called by all processes of this World, in the same order, outside of tasks.
+    /// Objects of trivially-copyable types and the payload of types with split metadata
+    /// (see ttg::SplitMetadataDescriptor) are communicated without intermediate copies, other types are serialized.
+    /// @{
+
+    /// @return the reduction of the @p value of every process with @p op, applied in order of increasing rank;
+    ///         for arithmetic types and the std::plus, std::multiplies and bitwise functors the MPI reduction is used
+    template <typename T, typename Op = std::plus<>>
+    T allreduce(const T &value, Op op = {}) const;
+
+    /// @return on process @p root the reduction of the @p value of every process with @p op, applied in order of
+    ///         increasing rank; on the other processes a copy of @p value
+    template <typename T, typename Op = std::plus<>>
+    T reduce(const T &value, int root, Op op = {}) const;
+
+    /// sets @p value on every process to the @p value of process @p root
+    template <typename T>
+    void broadcast(T &value, int root) const;
+
+    /// @return the @p value of every process, in order of increasing rank
+    template <typename T>
+    std::vector<T> allgather(const T &value) const;
+
+    /// @return the concatenation of the @p values of every process, in order of increasing rank
+    template <typename T>
+    std::vector<T> allgatherv(const std::vector<T> &values) const;
+
+    /// non-blocking allreduce(); the operation is completed by the get() of the returned future, which must be
+    /// called by every process
+    template <typename T, typename Op = std::plus<>>
+    std::future<T> iallreduce(const T &value, Op op = {}) const;
+
+    /// non-blocking allgather(); the operation is completed by the get() of the returned future, which must be
+    /// called by every process
+    template <typename T>
+    std::future<std::vector<T>> iallgather(const T &value) const;
+
+    /// @return the runtime counters of the TTs of this World (see TTBase::get_counters), on this process or, if
+    ///         @p all_processes, summed over all processes; the latter is a collective, and requires that every
+    ///         process created the same TTs in the same order
+    std::vector<TTCounters> counters(bool all_processes = false) const;
+
+    /// @}
   };
 
   namespace detail {